@@ -4,7 +4,10 @@ export LC_ALL=C
 export TZ=UTC
 
 IsBuildDebug=1
+IsPhysicsFixedPoint=0
+IsProfilerEnabled=
 IsBuildEnabled=1
+IsHeadlessEnabled=1
 IsTestsEnabled=1
 
 PROJECT_NAME=game
@@ -25,6 +28,15 @@ usage() {
     -r, --release
       Build with optimizations turned on.
 
+    --fixed-point
+      Build physics with Q16.16 fixed point numbers instead of floats.
+      Simulation is bit exact across machines and build types.
+
+    --enable-profiler
+      Record timed blocks in release builds too. Debug builds always record
+      them. Game writes them to profile.json with F9, headless with
+      --profile=path.
+
     --build-directory=path
       Build executables in this folder. If directory not exists, one will be
       created.
@@ -32,6 +44,10 @@ usage() {
     --disable-$PROJECT_NAME
       Do not build $PROJECT_NAME binary.
 
+    --disable-headless
+      Do not build ${PROJECT_NAME}_headless binary, which runs simulation
+      without window for benchmarks.
+
     test
       Run tests.
 
@@ -55,12 +71,21 @@ for i in "$@"; do
     -r|--release)
       IsBuildDebug=0
       ;;
+    --fixed-point)
+      IsPhysicsFixedPoint=1
+      ;;
+    --enable-profiler)
+      IsProfilerEnabled=1
+      ;;
     --build-directory=*)
       OutputDir="${i#*=}"
       ;;
     --disable-$PROJECT_NAME)
       IsBuildEnabled=0
       ;;
+    --disable-headless)
+      IsHeadlessEnabled=0
+      ;;
     test|tests)
       IsBuildEnabled=0
       IsTestsEnabled=1
@@ -315,6 +340,11 @@ cflags="$cflags -DCOMPILER_CLANG=$IsCompilerClang"
 cflags="$cflags -DIS_PLATFORM_LINUX=$IsOSLinux"
 
 cflags="$cflags -DIS_BUILD_DEBUG=$IsBuildDebug"
+cflags="$cflags -DIS_PHYSICS_FIXED_POINT=$IsPhysicsFixedPoint"
+if [ -z "$IsProfilerEnabled" ]; then
+  IsProfilerEnabled=$IsBuildDebug
+fi
+cflags="$cflags -DIS_PROFILER_ENABLED=$IsProfilerEnabled"
 if [ $IsBuildDebug -eq 1 ]; then
   cflags="$cflags -g -O0"
   cflags="$cflags -Wno-unused-but-set-variable"
@@ -394,6 +424,16 @@ if [ $IsBuildEnabled -eq 1 ]; then
     StartTimer
     "$cc" $cflags $ldflags $inc -o "$output" $src $lib
     [ $? -eq 0 ] && echo "$OUTPUT_NAME compiled in $(StopTimer) seconds."
+
+    if [ $IsHeadlessEnabled -eq 1 ]; then
+      src="$ProjectRoot/src/headless.c"
+      output="$OutputDir/${OUTPUT_NAME}_headless"
+      inc="-I$ProjectRoot/include $INC_LIBSDL"
+      lib="$LIB_LIBSDL $LIB_M"
+      StartTimer
+      "$cc" $cflags $ldflags $inc -o "$output" $src $lib
+      [ $? -eq 0 ] && echo "${OUTPUT_NAME}_headless compiled in $(StopTimer) seconds."
+    fi
   fi
 fi
 
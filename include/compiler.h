@@ -2,3 +2,10 @@
 
 #define likely(x) __builtin_expect(!!(x), 1)
 #define unlikely(x) __builtin_expect(!!(x), 0)
+
+// function may read past end of object, e.g. aligned vector loads that stay in page
+#if __has_attribute(no_sanitize_address)
+#define __no_sanitize_address__ __attribute__((no_sanitize_address))
+#else
+#define __no_sanitize_address__
+#endif
@@ -0,0 +1,230 @@
+#pragma once
+
+#include "assert.h"
+#include "math.h"
+#include "type.h"
+
+/*
+ * Q16.16 fixed point number.
+ *   16 bits integer part (sign included), 16 bits fraction part.
+ *   range:      [-32768, 32767.99998]
+ *   resolution: 1/65536 ≈ 0.0000153
+ *
+ * Every operation is done with integers, so same inputs give same outputs on
+ * every compiler, optimization level and instruction set.
+ *
+ * Rounding:
+ *   - multiply rounds toward negative infinity
+ *   - divide truncates toward zero
+ *   - square root rounds down
+ */
+typedef s32 q16;
+
+#define Q16_FRACTION_BITS 16
+#define Q16_ONE (1 << Q16_FRACTION_BITS)
+#define Q16_HALF (1 << (Q16_FRACTION_BITS - 1))
+#define Q16_MIN S32_MIN
+#define Q16_MAX S32_MAX
+
+/* Only use with constants, conversion is done at compile time. Rounds to nearest. */
+#define Q16(value) ((q16)((value) * (f64)Q16_ONE + ((value) >= 0 ? 0.5 : -0.5)))
+
+/*
+ * Converts f32 into q16, truncates toward zero.
+ * Multiply by power of 2 is exact in IEEE 754, so this conversion does not
+ * depend on rounding mode or optimization level.
+ */
+static inline q16
+q16_from_f32(f32 value)
+{
+  debug_assert(value >= -32768.0f && value < 32768.0f);
+  return (q16)(value * (f32)Q16_ONE);
+}
+
+static inline f32
+q16_to_f32(q16 value)
+{
+  return (f32)value * (1.0f / (f32)Q16_ONE);
+}
+
+static inline q16
+q16_from_s32(s32 value)
+{
+  debug_assert(value >= -32768 && value <= 32767);
+  return value * Q16_ONE;
+}
+
+static inline q16
+q16_mul(q16 a, q16 b)
+{
+  s64 product = (s64)a * (s64)b;
+  return (q16)(product >> Q16_FRACTION_BITS);
+}
+
+static inline q16
+q16_div(q16 a, q16 b)
+{
+  debug_assert(b != 0 && "division by zero");
+  s64 dividend = (s64)a * Q16_ONE;
+  return (q16)(dividend / b);
+}
+
+static inline q16
+q16_abs(q16 value)
+{
+  return value < 0 ? -value : value;
+}
+
+/*
+ * Integer square root, rounds down.
+ *   ⌊√value⌋
+ * Starts from hardware estimate, then corrects it with integer math. Square root
+ * is correctly rounded in IEEE 754, and the correction makes the result exact,
+ * so result is same on every machine.
+ */
+static inline u32
+SquareRootU64(u64 value)
+{
+  u64 result = (u64)__builtin_sqrt((f64)value);
+  if (result > U32_MAX)
+    result = U32_MAX;
+
+  while (result * result > value)
+    result--;
+  while (result < U32_MAX && (result + 1) * (result + 1) <= value)
+    result++;
+
+  return (u32)result;
+}
+
+static inline q16
+q16_sqrt(q16 value)
+{
+  debug_assert(value >= 0);
+  // √(v 2¹⁶) 2⁸ = √(v 2¹⁶ 2¹⁶) = √(v 2³²)
+  u64 valueInQ32 = (u64)value << Q16_FRACTION_BITS;
+  return (q16)SquareRootU64(valueInQ32);
+}
+
+#define Q16_PI Q16(3.14159265358979323846)
+
+/*
+ * Sine of angle in radians.
+ * Angle is reduced to [-π/2, π/2], then Taylor series up to x⁷ is evaluated
+ * with Horner's method. Error is below 0.0002.
+ */
+static inline q16
+q16_sin(q16 angle)
+{
+  // [-π, π]
+  angle %= 2 * Q16_PI;
+  if (angle > Q16_PI)
+    angle -= 2 * Q16_PI;
+  else if (angle < -Q16_PI)
+    angle += 2 * Q16_PI;
+
+  // sin(π - x) = sin(x), so [-π/2, π/2]
+  if (angle > Q16_PI / 2)
+    angle = Q16_PI - angle;
+  else if (angle < -Q16_PI / 2)
+    angle = -Q16_PI - angle;
+
+  // x (1 - x²/6 (1 - x²/20 (1 - x²/42)))
+  q16 angleSquare = q16_mul(angle, angle);
+  q16 result = Q16_ONE - q16_mul(angleSquare, Q16(1.0 / 42.0));
+  result = Q16_ONE - q16_mul(q16_mul(angleSquare, Q16(1.0 / 20.0)), result);
+  result = Q16_ONE - q16_mul(q16_mul(angleSquare, Q16(1.0 / 6.0)), result);
+  return q16_mul(angle, result);
+}
+
+/* cos(x) = sin(x + π/2) */
+static inline q16
+q16_cos(q16 angle)
+{
+  // reduced first, so adding π/2 cannot overflow
+  return q16_sin(angle % (2 * Q16_PI) + Q16_PI / 2);
+}
+
+typedef struct v2q {
+  q16 x;
+  q16 y;
+} v2q;
+
+static inline v2q
+v2q_from_v2(v2 a)
+{
+  return (v2q){q16_from_f32(a.x), q16_from_f32(a.y)};
+}
+
+static inline v2
+v2q_to_v2(v2q a)
+{
+  return (v2){q16_to_f32(a.x), q16_to_f32(a.y)};
+}
+
+static inline v2q
+v2q_add(v2q a, v2q b)
+{
+  return (v2q){a.x + b.x, a.y + b.y};
+}
+
+static inline v2q
+v2q_sub(v2q a, v2q b)
+{
+  return (v2q){a.x - b.x, a.y - b.y};
+}
+
+static inline v2q
+v2q_scale(v2q a, q16 scaler)
+{
+  return (v2q){q16_mul(a.x, scaler), q16_mul(a.y, scaler)};
+}
+
+static inline v2q
+v2q_neg(v2q a)
+{
+  return (v2q){-a.x, -a.y};
+}
+
+static inline q16
+v2q_dot(v2q a, v2q b)
+{
+  // accumulate in Q32.32, round once
+  s64 dot = (s64)a.x * (s64)b.x + (s64)a.y * (s64)b.y;
+  return (q16)(dot >> Q16_FRACTION_BITS);
+}
+
+static inline q16
+v2q_length_square(v2q a)
+{
+  return v2q_dot(a, a);
+}
+
+static inline q16
+v2q_length(v2q a)
+{
+  // x² + y² is Q32.32, square root of it is Q16.16
+  u64 lengthSquareInQ32 = (u64)((s64)a.x * (s64)a.x) + (u64)((s64)a.y * (s64)a.y);
+  return (q16)SquareRootU64(lengthSquareInQ32);
+}
+
+static inline v2q
+v2q_normalize(v2q a)
+{
+  q16 length = v2q_length(a);
+  if (length == 0)
+    return (v2q){0, 0};
+  return (v2q){q16_div(a.x, length), q16_div(a.y, length)};
+}
+
+/* rotates counter-clockwise in math space */
+static inline v2q
+v2q_rotate(v2q a, q16 radians)
+{
+  q16 cosine = q16_cos(radians);
+  q16 sine = q16_sin(radians);
+  return (v2q){
+      q16_mul(a.x, cosine) - q16_mul(a.y, sine),
+      q16_mul(a.x, sine) + q16_mul(a.y, cosine),
+  };
+}
@@ -0,0 +1,177 @@
+#pragma once
+
+#include "assert.h"
+#include "memory.h"
+#include "type.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+/*
+ * Fast non-cryptographic 64 bit hash, in the style of xxh3.
+ * Used to tell whether two runs produced same state, NOT for security and
+ * NOT compatible with xxh3 outputs.
+ *
+ *   input is cut into 64 byte stripes, 8 lanes of u64
+ *   for every lane:
+ *     dataKey      = data ^ key
+ *     acc[i]      += lo32(dataKey) * hi32(dataKey)
+ *     acc[i ^ 1]  += data
+ *   every 16 stripes accumulators are scrambled
+ *   last stripe is last 64 bytes of input, it overlaps when size is not
+ *   a multiple of 64
+ *
+ * Same input and seed give same hash on every machine, AVX2 and scalar paths
+ * compute exactly same values.
+ */
+
+#define HASH_STRIPE_SIZE 64
+#define HASH_STRIPES_PER_BLOCK 16
+#define HASH_PRIME32_1 0x9e3779b1u
+#define HASH_PRIME64_1 0x9e3779b185ebca87ull
+
+// splitmix64 sequence from 0
+static const u64 HASH_SECRET[24] = {
+    0xe220a8397b1dcdafull, 0x6e789e6aa1b965f4ull, 0x06c45d188009454full, 0xf88bb8a8724c81ecull,
+    0x1b39896a51a8749bull, 0x53cb9f0c747ea2eaull, 0x2c829abe1f4532e1ull, 0xc584133ac916ab3cull,
+    0x3ee5789041c98ac3ull, 0xf3b8488c368cb0a6ull, 0x657eecdd3cb13d09ull, 0xc2d326e0055bdef6ull,
+    0x8621a03fe0bbdb7bull, 0x8e1f7555983aa92full, 0xb54e0f1600cc4d19ull, 0x84bb3f97971d80abull,
+    0x7d29825c75521255ull, 0xc3cf17102b7f7f86ull, 0x3466e9a083914f64ull, 0xd81a8d2b5a4485acull,
+    0xdb01602b100b9ed7ull, 0xa9038a921825f10dull, 0xedf5f1d90dca2f6aull, 0x54496ad67bd2634cull,
+};
+
+static inline u64
+HashAvalanche(u64 hash)
+{
+  hash ^= hash >> 37;
+  hash *= 0x165667919e3779f9ull;
+  hash ^= hash >> 32;
+  return hash;
+}
+
+static inline u64
+HashMultiplyFold(u64 left, u64 right)
+{
+  __uint128_t product = (__uint128_t)left * right;
+  return (u64)product ^ (u64)(product >> 64);
+}
+
+#if defined(__AVX2__)
+
+static inline void
+HashAccumulateStripe(__m256i acc[2], u8 *stripe, u64 *key)
+{
+  for (u32 half = 0; half < 2; half++) {
+    __m256i data = _mm256_loadu_si256((__m256i *)(stripe + half * 32));
+    __m256i dataKey = _mm256_xor_si256(data, _mm256_loadu_si256((__m256i *)(key + half * 4)));
+    __m256i product = _mm256_mul_epu32(dataKey, _mm256_srli_epi64(dataKey, 32));
+    // swaps lanes 0 <-> 1, 2 <-> 3
+    __m256i swapped = _mm256_shuffle_epi32(data, _MM_SHUFFLE(1, 0, 3, 2));
+    acc[half] = _mm256_add_epi64(acc[half], _mm256_add_epi64(product, swapped));
+  }
+}
+
+static inline void
+HashScramble(__m256i acc[2], u64 *key)
+{
+  __m256i prime = _mm256_set1_epi32((s32)HASH_PRIME32_1);
+  for (u32 half = 0; half < 2; half++) {
+    __m256i value = _mm256_xor_si256(acc[half], _mm256_srli_epi64(acc[half], 47));
+    value = _mm256_xor_si256(value, _mm256_loadu_si256((__m256i *)(key + half * 4)));
+    // 64 bit multiply by 32 bit constant
+    __m256i low = _mm256_mul_epu32(value, prime);
+    __m256i high = _mm256_slli_epi64(_mm256_mul_epu32(_mm256_srli_epi64(value, 32), prime), 32);
+    acc[half] = _mm256_add_epi64(low, high);
+  }
+}
+
+#else
+
+static inline void
+HashAccumulateStripe(u64 acc[8], u8 *stripe, u64 *key)
+{
+  for (u32 lane = 0; lane < 8; lane++) {
+    u64 data;
+    memcpy(&data, stripe + lane * sizeof(u64), sizeof(data));
+    u64 dataKey = data ^ key[lane];
+    acc[lane] += (dataKey & 0xffffffff) * (dataKey >> 32);
+    acc[lane ^ 1] += data;
+  }
+}
+
+static inline void
+HashScramble(u64 acc[8], u64 *key)
+{
+  for (u32 lane = 0; lane < 8; lane++) {
+    u64 value = acc[lane] ^ (acc[lane] >> 47);
+    value ^= key[lane];
+    acc[lane] = value * HASH_PRIME32_1;
+  }
+}
+
+#endif
+
+/* @return hash of size bytes at data, data does not need to be aligned */
+static u64
+Hash64(void *data, u64 size, u64 seed)
+{
+  u64 key[ARRAY_COUNT(HASH_SECRET)];
+  for (u32 index = 0; index < ARRAY_COUNT(HASH_SECRET); index++)
+    key[index] = (index & 1) ? HASH_SECRET[index] - seed : HASH_SECRET[index] + seed;
+
+  // short input is padded with zeros to one stripe, size is mixed in at the end
+  u8 *bytes = data;
+  u8 padded[HASH_STRIPE_SIZE] = {};
+  if (size < HASH_STRIPE_SIZE) {
+    if (size > 0)
+      memcpy(padded, bytes, size);
+    bytes = padded;
+  }
+  u64 paddedSize = size < HASH_STRIPE_SIZE ? HASH_STRIPE_SIZE : size;
+
+#if defined(__AVX2__)
+  __m256i accVector[2];
+  {
+    u64 init[8] = {HASH_SECRET[0], HASH_SECRET[1], HASH_SECRET[2], HASH_SECRET[3],
+                   HASH_SECRET[4], HASH_SECRET[5], HASH_SECRET[6], HASH_SECRET[7]};
+    accVector[0] = _mm256_loadu_si256((__m256i *)init);
+    accVector[1] = _mm256_loadu_si256((__m256i *)(init + 4));
+  }
+  __m256i *acc = accVector;
+#else
+  u64 acc[8] = {HASH_SECRET[0], HASH_SECRET[1], HASH_SECRET[2], HASH_SECRET[3],
+                HASH_SECRET[4], HASH_SECRET[5], HASH_SECRET[6], HASH_SECRET[7]};
+#endif
+
+  // every stripe except last one, which is always read from end
+  u64 stripeCount = (paddedSize - 1) / HASH_STRIPE_SIZE;
+  u64 blockSize = HASH_STRIPE_SIZE * HASH_STRIPES_PER_BLOCK;
+  u64 blockCount = stripeCount / HASH_STRIPES_PER_BLOCK;
+  for (u64 blockIndex = 0; blockIndex < blockCount; blockIndex++) {
+    u8 *block = bytes + blockIndex * blockSize;
+    for (u32 stripeIndex = 0; stripeIndex < HASH_STRIPES_PER_BLOCK; stripeIndex++)
+      HashAccumulateStripe(acc, block + stripeIndex * HASH_STRIPE_SIZE, key + stripeIndex);
+    HashScramble(acc, key + 16);
+  }
+
+  u8 *block = bytes + blockCount * blockSize;
+  u32 remainingStripeCount = (u32)(stripeCount - blockCount * HASH_STRIPES_PER_BLOCK);
+  for (u32 stripeIndex = 0; stripeIndex < remainingStripeCount; stripeIndex++)
+    HashAccumulateStripe(acc, block + stripeIndex * HASH_STRIPE_SIZE, key + stripeIndex);
+  HashAccumulateStripe(acc, bytes + paddedSize - HASH_STRIPE_SIZE, key + 7);
+
+  u64 lanes[8];
+#if defined(__AVX2__)
+  _mm256_storeu_si256((__m256i *)lanes, acc[0]);
+  _mm256_storeu_si256((__m256i *)(lanes + 4), acc[1]);
+#else
+  for (u32 lane = 0; lane < 8; lane++)
+    lanes[lane] = acc[lane];
+#endif
+
+  u64 hash = size * HASH_PRIME64_1;
+  for (u32 lane = 0; lane < 8; lane += 2)
+    hash += HashMultiplyFold(lanes[lane] ^ key[11 + lane], lanes[lane + 1] ^ key[12 + lane]);
+  return HashAvalanche(hash);
+}
@@ -0,0 +1,115 @@
+#pragma once
+
+#include "type.h"
+
+/*
+ * High dynamic range histogram, in the spirit of HdrHistogram.
+ * Counts values from 0 to HISTOGRAM_VALUE_MAX in constant memory, every
+ * recorded value is within 1/64 of bucket it lands in. Used to report
+ * percentiles of frame and block times, which averages hide.
+ *
+ *   power of two ranges are split into 64 linear buckets:
+ *     [0, 128)          width 1     index 0..127
+ *     [128, 256)        width 2     index 128..191
+ *     [256, 512)        width 4     index 192..255
+ *     ...
+ *
+ *   histogram histogram;
+ *   HistogramReset(&histogram);
+ *   HistogramRecord(&histogram, frameTimeInNanoseconds);
+ *   u64 p99 = HistogramValueAtPercentile(&histogram, 99.0);
+ */
+
+#define HISTOGRAM_SUB_BUCKET_BITS 7
+#define HISTOGRAM_SUB_BUCKET_COUNT (1 << HISTOGRAM_SUB_BUCKET_BITS)
+#define HISTOGRAM_SUB_BUCKET_HALF_COUNT (HISTOGRAM_SUB_BUCKET_COUNT / 2)
+#define HISTOGRAM_VALUE_BITS 40 // larger values are counted as HISTOGRAM_VALUE_MAX
+#define HISTOGRAM_VALUE_MAX ((1ull << HISTOGRAM_VALUE_BITS) - 1)
+#define HISTOGRAM_BUCKET_COUNT                                                                                         \
+  ((HISTOGRAM_VALUE_BITS - HISTOGRAM_SUB_BUCKET_BITS + 2) * HISTOGRAM_SUB_BUCKET_HALF_COUNT)
+
+typedef struct {
+  u64 counts[HISTOGRAM_BUCKET_COUNT];
+  u64 totalCount;
+  u64 min; // U64_MAX when empty
+  u64 max;
+} histogram;
+
+static void
+HistogramReset(histogram *histogram)
+{
+  for (u32 index = 0; index < HISTOGRAM_BUCKET_COUNT; index++)
+    histogram->counts[index] = 0;
+  histogram->totalCount = 0;
+  histogram->min = U64_MAX;
+  histogram->max = 0;
+}
+
+/* @return index of bucket that counts value */
+static inline u32
+HistogramBucketIndex(u64 value)
+{
+  // values below sub bucket count have shift 0, every power of two above adds 1
+  u32 highestBit = 63 - (u32)__builtin_clzll(value | (HISTOGRAM_SUB_BUCKET_COUNT - 1));
+  u32 shift = highestBit - (HISTOGRAM_SUB_BUCKET_BITS - 1);
+  return shift * HISTOGRAM_SUB_BUCKET_HALF_COUNT + (u32)(value >> shift);
+}
+
+/* @return lowest value that is counted in bucket */
+static inline u64
+HistogramBucketLowestValue(u32 index)
+{
+  u32 shift = index < HISTOGRAM_SUB_BUCKET_COUNT ? 0 : index / HISTOGRAM_SUB_BUCKET_HALF_COUNT - 1;
+  return (u64)(index - shift * HISTOGRAM_SUB_BUCKET_HALF_COUNT) << shift;
+}
+
+/* @return highest value that is counted in bucket */
+static inline u64
+HistogramBucketHighestValue(u32 index)
+{
+  u32 shift = index < HISTOGRAM_SUB_BUCKET_COUNT ? 0 : index / HISTOGRAM_SUB_BUCKET_HALF_COUNT - 1;
+  return HistogramBucketLowestValue(index) + (1ull << shift) - 1;
+}
+
+static inline void
+HistogramRecord(histogram *histogram, u64 value)
+{
+  if (value > HISTOGRAM_VALUE_MAX)
+    value = HISTOGRAM_VALUE_MAX;
+  histogram->counts[HistogramBucketIndex(value)]++;
+  histogram->totalCount++;
+  if (value < histogram->min)
+    histogram->min = value;
+  if (value > histogram->max)
+    histogram->max = value;
+}
+
+/*
+ * Percentile is from 0 to 100, e.g. 99.9.
+ * @return highest value of bucket that holds percentile, but never more than
+ *         recorded max, 0 when histogram is empty
+ */
+static u64
+HistogramValueAtPercentile(histogram *histogram, f64 percentile)
+{
+  if (histogram->totalCount == 0)
+    return 0;
+
+  if (percentile > 100.0)
+    percentile = 100.0;
+  // rounded up, at least one value so p0 is bucket of min
+  f64 exactCount = percentile / 100.0 * (f64)histogram->totalCount;
+  u64 countAtPercentile = (u64)exactCount;
+  if ((f64)countAtPercentile < exactCount || countAtPercentile == 0)
+    countAtPercentile++;
+
+  u64 count = 0;
+  for (u32 index = 0; index < HISTOGRAM_BUCKET_COUNT; index++) {
+    count += histogram->counts[index];
+    if (count >= countAtPercentile) {
+      u64 value = HistogramBucketHighestValue(index);
+      return value < histogram->max ? value : histogram->max;
+    }
+  }
+  return histogram->max;
+}
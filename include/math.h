@@ -160,6 +160,38 @@ SquareRoot(f32 value)
   return sqrtf(value);
 }
 
+#define PI 3.14159265358979323846f
+
+extern f32
+sinf(f32 value);
+
+static inline f32
+Sin(f32 radians)
+{
+  return sinf(radians);
+}
+
+extern f32
+cosf(f32 value);
+
+static inline f32
+Cos(f32 radians)
+{
+  return cosf(radians);
+}
+
+extern long
+lrintf(f32 value);
+
+/*
+ * Rounds half to even in default rounding mode, same as cvtps2dq.
+ */
+static inline s32
+RoundF32ToS32(f32 value)
+{
+  return (s32)lrintf(value);
+}
+
 typedef struct v2 {
   union {
     struct {
@@ -326,3 +358,141 @@ IsPointInsideRect(struct v2 point, struct rect rect)
       //
       ;
 }
+
+/*
+ * 2D affine transform, stored as 3 columns.
+ *
+ *   | x.x  y.x  origin.x |   | p.x |
+ *   | x.y  y.y  origin.y | * | p.y |
+ *                            |  1  |
+ *
+ *   p' = origin + x p.x + y p.y
+ */
+typedef struct m2x3 {
+  union {
+    struct {
+      v2 x;      // where x axis lands
+      v2 y;      // where y axis lands
+      v2 origin; // translation
+    };
+    f32 e[6];
+  };
+} m2x3;
+
+static inline m2x3
+m2x3_identity(void)
+{
+  return (m2x3){
+      .x = {1.0f, 0.0f},
+      .y = {0.0f, 1.0f},
+      .origin = {0.0f, 0.0f},
+  };
+}
+
+/* rotates counter-clockwise in math space */
+static inline m2x3
+m2x3_rotation(f32 radians)
+{
+  f32 cosine = Cos(radians);
+  f32 sine = Sin(radians);
+  return (m2x3){
+      .x = {cosine, sine},
+      .y = {-sine, cosine},
+      .origin = {0.0f, 0.0f},
+  };
+}
+
+static inline m2x3
+m2x3_scale(v2 scale)
+{
+  return (m2x3){
+      .x = {scale.x, 0.0f},
+      .y = {0.0f, scale.y},
+      .origin = {0.0f, 0.0f},
+  };
+}
+
+static inline m2x3
+m2x3_translation(v2 translation)
+{
+  return (m2x3){
+      .x = {1.0f, 0.0f},
+      .y = {0.0f, 1.0f},
+      .origin = translation,
+  };
+}
+
+/* transform point, translation is applied */
+static inline v2
+m2x3_transform(m2x3 m, v2 p)
+{
+  return (v2){
+      m.origin.x + m.x.x * p.x + m.y.x * p.y,
+      m.origin.y + m.x.y * p.x + m.y.y * p.y,
+  };
+}
+
+/* transform direction, translation is not applied */
+static inline v2
+m2x3_transform_vector(m2x3 m, v2 v)
+{
+  return (v2){
+      m.x.x * v.x + m.y.x * v.y,
+      m.x.y * v.x + m.y.y * v.y,
+  };
+}
+
+/*
+ * Returns transform that applies b first, then a.
+ *   (a * b) p = a (b p)
+ */
+static inline m2x3
+m2x3_mul(m2x3 a, m2x3 b)
+{
+  return (m2x3){
+      .x = m2x3_transform_vector(a, b.x),
+      .y = m2x3_transform_vector(a, b.y),
+      .origin = m2x3_transform(a, b.origin),
+  };
+}
+
+/*
+ * Inverse of transform.
+ * Transform must not be degenerate, eg. scale of 0.
+ *
+ *   |a c|⁻¹      1    | d -c|
+ *   |b d|    = ------- |-b  a|
+ *              ad - bc
+ */
+static inline m2x3
+m2x3_invert(m2x3 m)
+{
+  f32 determinant = m.x.x * m.y.y - m.y.x * m.x.y;
+  debug_assert(determinant != 0.0f && "transform is not invertible");
+  f32 invDeterminant = 1.0f / determinant;
+
+  m2x3 result = {
+      .x = {m.y.y * invDeterminant, -m.x.y * invDeterminant},
+      .y = {-m.y.x * invDeterminant, m.x.x * invDeterminant},
+  };
+  result.origin = v2_neg(m2x3_transform_vector(result, m.origin));
+  return result;
+}
+
+/*
+ * Transforms count points from src into dest.
+ * src and dest can be same array.
+ * Each component is 2 multiply-adds on top of translation, loop is left
+ * simple so that compiler can vectorize it.
+ */
+static inline void
+m2x3_transform_array(m2x3 m, v2 *src, v2 *dest, u64 count)
+{
+  for (u64 index = 0; index < count; index++) {
+    v2 p = src[index];
+    dest[index] = (v2){
+        m.origin.x + m.x.x * p.x + m.y.x * p.y,
+        m.origin.y + m.x.y * p.x + m.y.y * p.y,
+    };
+  }
+}
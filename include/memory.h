@@ -26,6 +26,7 @@ typedef struct {
   void *block;
   u64 used;
   u64 total;
+  u64 usedMax; // high-water mark, temporary memory included
 } memory_arena;
 
 typedef struct {
@@ -50,6 +51,7 @@ MemoryArenaSub(memory_arena *master, u64 size)
   };
 
   master->used += size;
+  master->usedMax = Maximum(master->usedMax, master->used);
   return sub;
 }
 
@@ -59,6 +61,7 @@ MemoryArenaPushUnaligned(memory_arena *mem, u64 size)
   debug_assert(mem->used + size <= mem->total);
   void *result = mem->block + mem->used;
   mem->used += size;
+  mem->usedMax = Maximum(mem->usedMax, mem->used);
   return result;
 }
 
@@ -80,6 +83,7 @@ MemoryArenaPush(memory_arena *mem, u64 size, u64 alignment)
 
   debug_assert(mem->used + size <= mem->total);
   mem->used += size;
+  mem->usedMax = Maximum(mem->usedMax, mem->used);
 
   return block;
 }
@@ -1,68 +1,293 @@
 #pragma once
 
+#include "compiler.h"
 #include "memory.h"
 #include "teju.h"
 #include "text.h"
+#include <unistd.h> // write()
+
+/*
+ * String builder
+ *   Appends into outBuffer. What happens when outBuffer fills up depends on
+ *   its sink:
+ *     none   appends that do not fit are cut, isTruncated is set
+ *     fd     outBuffer is written to fd, builder starts over at its beginning
+ *     arena  outBuffer is kept as a chunk, builder continues in new block
+ *            pushed from arena, so text grows until arena is full
+ *
+ *   string_builder sb = {.outBuffer = &(struct string){.value = bytes, .length = sizeof(bytes)}};
+ *   StringBuilderAttachFd(&sb, fd);
+ *   for (...)
+ *     StringBuilderAppendU64(&sb, value);
+ *   b8 isWritten = StringBuilderFlushToSink(&sb);
+ *
+ * Formatters write straight into outBuffer, StringBuilderReserve() lets callers
+ * do the same.
+ */
+
+#define STRING_BUILDER_ARENA_BLOCK_SIZE 4096 // unit: bytes, smallest block pushed from arena
+#define STRING_BUILDER_U64_LENGTH_MAX 20     // 18446744073709551615
+#define STRING_BUILDER_HEX_LENGTH_MAX 18     // 0x and 16 digits
+// sign, 39 digits of F32_MAX, point, then fraction
+#define STRING_BUILDER_F32_LENGTH_MAX(fractionCount) (41 + (fractionCount))
+
+typedef enum {
+  STRING_BUILDER_SINK_NONE,
+  STRING_BUILDER_SINK_FD,
+  STRING_BUILDER_SINK_ARENA,
+} string_builder_sink;
+
+typedef struct string_builder_chunk {
+  struct string string;
+  struct string_builder_chunk *next;
+} string_builder_chunk;
 
 typedef struct {
-  struct string *outBuffer;
-  struct string *stringBuffer;
+  struct string *outBuffer; // arena sink moves it to every new block
   u64 length;
+
+  string_builder_sink sink;
+  s32 fd;                           // fd sink
+  memory_arena *arena;              // arena sink
+  string_builder_chunk *firstChunk; // arena sink, filled blocks in order
+  string_builder_chunk *lastChunk;
+  b8 isTruncated; // bytes were cut or could not be written
 } string_builder;
 
 static inline void
-StringBuilderAppendZeroTerminated(string_builder *stringBuilder, const char *src, u64 max)
+StringBuilderAttachFd(string_builder *stringBuilder, s32 fd)
+{
+  stringBuilder->sink = STRING_BUILDER_SINK_FD;
+  stringBuilder->fd = fd;
+  stringBuilder->isTruncated = 0;
+}
+
+static inline void
+StringBuilderAttachArena(string_builder *stringBuilder, memory_arena *arena)
+{
+  stringBuilder->sink = STRING_BUILDER_SINK_ARENA;
+  stringBuilder->arena = arena;
+  stringBuilder->firstChunk = 0;
+  stringBuilder->lastChunk = 0;
+  stringBuilder->isTruncated = 0;
+}
+
+/* @return 1 when every byte is written */
+static b8
+StringBuilderWriteFd(s32 fd, u8 *bytes, u64 size)
+{
+  while (size > 0) {
+    ssize_t written = write(fd, bytes, size);
+    if (written <= 0)
+      return 0;
+    bytes += written;
+    size -= (u64)written;
+  }
+  return 1;
+}
+
+/*
+ * Keeps written part of outBuffer as last chunk of arena sink, outBuffer
+ * continues after it.
+ * @return 0 when arena is full
+ */
+static b8
+StringBuilderCloseChunk(string_builder *stringBuilder)
+{
+  struct string *outBuffer = stringBuilder->outBuffer;
+  if (stringBuilder->length == 0)
+    return 1;
+
+  memory_arena *arena = stringBuilder->arena;
+  if (arena->used + sizeof(string_builder_chunk) + 8 > arena->total)
+    return 0;
+
+  string_builder_chunk *chunk = MemoryArenaPush(arena, sizeof(*chunk), 8);
+  chunk->string = (struct string){.value = outBuffer->value, .length = stringBuilder->length};
+  chunk->next = 0;
+  if (stringBuilder->lastChunk)
+    stringBuilder->lastChunk->next = chunk;
+  else
+    stringBuilder->firstChunk = chunk;
+  stringBuilder->lastChunk = chunk;
+
+  outBuffer->value += stringBuilder->length;
+  outBuffer->length -= stringBuilder->length;
+  stringBuilder->length = 0;
+  return 1;
+}
+
+/*
+ * Makes room for at least size bytes by passing outBuffer to sink.
+ * @return 0 when there is no sink or it cannot take more
+ */
+static b8
+StringBuilderSpill(string_builder *stringBuilder, u64 size)
+{
+  struct string *outBuffer = stringBuilder->outBuffer;
+  switch (stringBuilder->sink) {
+  case STRING_BUILDER_SINK_FD: {
+    if (!StringBuilderWriteFd(stringBuilder->fd, outBuffer->value, stringBuilder->length))
+      stringBuilder->isTruncated = 1;
+    stringBuilder->length = 0;
+    return size <= outBuffer->length;
+  }
+
+  case STRING_BUILDER_SINK_ARENA: {
+    if (!StringBuilderCloseChunk(stringBuilder))
+      return 0;
+
+    memory_arena *arena = stringBuilder->arena;
+    u64 blockSize = size > STRING_BUILDER_ARENA_BLOCK_SIZE ? size : STRING_BUILDER_ARENA_BLOCK_SIZE;
+    if (arena->used + blockSize > arena->total)
+      return 0;
+    outBuffer->value = MemoryArenaPushUnaligned(arena, blockSize);
+    outBuffer->length = blockSize;
+    return 1;
+  }
+
+  case STRING_BUILDER_SINK_NONE:
+  default:
+    return 0;
+  }
+}
+
+/*
+ * Reserves size bytes at end of builder to write into directly, then
+ * StringBuilderCommit() appends how many of them are used.
+ *
+ *   u8 *dest = StringBuilderReserve(sb, 2);
+ *   if (dest) {
+ *     dest[0] = 'o';
+ *     dest[1] = 'k';
+ *     StringBuilderCommit(sb, 2);
+ *   }
+ *
+ * @return 0 when size bytes do not fit, builder is marked as truncated
+ */
+static inline u8 *
+StringBuilderReserve(string_builder *stringBuilder, u64 size)
 {
   struct string *outBuffer = stringBuilder->outBuffer;
+  if (unlikely(stringBuilder->length + size > outBuffer->length) && !StringBuilderSpill(stringBuilder, size)) {
+    stringBuilder->isTruncated = 1;
+    return 0;
+  }
+  return outBuffer->value + stringBuilder->length;
+}
+
+static inline void
+StringBuilderCommit(string_builder *stringBuilder, u64 size)
+{
+  stringBuilder->length += size;
+  debug_assert(stringBuilder->length <= stringBuilder->outBuffer->length);
+}
+
+/* Copies bytes in parts, so they may be larger than outBuffer when builder has a sink. */
+static inline void
+StringBuilderAppendBytes(string_builder *stringBuilder, u8 *bytes, u64 size)
+{
+  for (;;) {
+    struct string *outBuffer = stringBuilder->outBuffer;
+    u64 available = outBuffer->length - stringBuilder->length;
+    u64 count = size < available ? size : available;
+    memcpy(outBuffer->value + stringBuilder->length, bytes, count);
+    stringBuilder->length += count;
+    bytes += count;
+    size -= count;
+    if (likely(size == 0))
+      return;
+
+    if (!StringBuilderSpill(stringBuilder, 1)) {
+      stringBuilder->isTruncated = 1;
+      return;
+    }
+  }
+}
+
+static inline void
+StringBuilderAppendZeroTerminated(string_builder *stringBuilder, const char *src, u64 max)
+{
   struct string string = StringFromZeroTerminated((u8 *)src, max);
-  memcpy(outBuffer->value + stringBuilder->length, string.value, string.length);
-  stringBuilder->length += string.length;
-  debug_assert(stringBuilder->length <= outBuffer->length);
+  StringBuilderAppendBytes(stringBuilder, string.value, string.length);
 }
 
 static inline void
 StringBuilderAppendString(string_builder *stringBuilder, struct string *string)
+{
+  StringBuilderAppendBytes(stringBuilder, string->value, string->length);
+}
+
+/*
+ * Formatters write in place when their longest output fits, otherwise into
+ * fallback, which is then copied in parts like any other append.
+ * @return where formatter writes
+ */
+static inline u8 *
+StringBuilderFormatBegin(string_builder *stringBuilder, u64 lengthMax, u8 *fallback)
 {
   struct string *outBuffer = stringBuilder->outBuffer;
-  memcpy(outBuffer->value + stringBuilder->length, string->value, string->length);
-  stringBuilder->length += string->length;
-  debug_assert(stringBuilder->length <= outBuffer->length);
+  if (likely(stringBuilder->length + lengthMax <= outBuffer->length))
+    return outBuffer->value + stringBuilder->length;
+  return fallback;
 }
 
 static inline void
-StringBuilderAppendU64(string_builder *stringBuilder, u64 value)
+StringBuilderFormatEnd(string_builder *stringBuilder, struct string string, u8 *fallback)
 {
-  struct string *outBuffer = stringBuilder->outBuffer;
-  struct string *stringBuffer = stringBuilder->stringBuffer;
+  if (likely(string.value != fallback))
+    StringBuilderCommit(stringBuilder, string.length);
+  else
+    StringBuilderAppendBytes(stringBuilder, string.value, string.length);
+}
 
-  struct string string = FormatU64(stringBuffer, value);
-  memcpy(outBuffer->value + stringBuilder->length, string.value, string.length);
-  stringBuilder->length += string.length;
-  debug_assert(stringBuilder->length <= outBuffer->length);
+static inline void
+StringBuilderAppendU64(string_builder *stringBuilder, u64 value)
+{
+  u8 fallback[STRING_BUILDER_U64_LENGTH_MAX];
+  u8 *dest = StringBuilderFormatBegin(stringBuilder, sizeof(fallback), fallback);
+  struct string string = FormatU64(&(struct string){.value = dest, .length = sizeof(fallback)}, value);
+  StringBuilderFormatEnd(stringBuilder, string, fallback);
 }
 
 static inline void
 StringBuilderAppendHex(string_builder *stringBuilder, u64 value)
 {
-  struct string *outBuffer = stringBuilder->outBuffer;
-  struct string *stringBuffer = stringBuilder->stringBuffer;
-
-  struct string string = FormatHex(stringBuffer, value);
-  memcpy(outBuffer->value + stringBuilder->length, string.value, string.length);
-  stringBuilder->length += string.length;
-  debug_assert(stringBuilder->length <= outBuffer->length);
+  u8 fallback[STRING_BUILDER_HEX_LENGTH_MAX];
+  u8 *dest = StringBuilderFormatBegin(stringBuilder, sizeof(fallback), fallback);
+  struct string string = FormatHex(&(struct string){.value = dest, .length = sizeof(fallback)}, value);
+  StringBuilderFormatEnd(stringBuilder, string, fallback);
 }
 
+/* fractionCount [1,51] */
 static inline void
 StringBuilderAppendF32(string_builder *stringBuilder, f32 value, u32 fractionCount)
 {
-  struct string *outBuffer = stringBuilder->outBuffer;
-  struct string *stringBuffer = stringBuilder->stringBuffer;
+  u8 fallback[STRING_BUILDER_F32_LENGTH_MAX(51)];
+  u64 lengthMax = STRING_BUILDER_F32_LENGTH_MAX(fractionCount);
+  u8 *dest = StringBuilderFormatBegin(stringBuilder, lengthMax, fallback);
+  struct string string = FormatF32(&(struct string){.value = dest, .length = lengthMax}, value, fractionCount);
+  StringBuilderFormatEnd(stringBuilder, string, fallback);
+}
 
-  struct string string = FormatF32(stringBuffer, value, fractionCount);
-  memcpy(outBuffer->value + stringBuilder->length, string.value, string.length);
-  stringBuilder->length += string.length;
-  debug_assert(stringBuilder->length <= outBuffer->length);
+/* Fewest digits that parse back to value, e.g. 0.1 or 1.5e-7. */
+static inline void
+StringBuilderAppendF32Shortest(string_builder *stringBuilder, f32 value)
+{
+  u8 fallback[FORMAT_SHORTEST_LENGTH_MAX];
+  u8 *dest = StringBuilderFormatBegin(stringBuilder, sizeof(fallback), fallback);
+  struct string string = FormatF32Shortest(&(struct string){.value = dest, .length = sizeof(fallback)}, value);
+  StringBuilderFormatEnd(stringBuilder, string, fallback);
+}
+
+/* @see StringBuilderAppendF32Shortest() */
+static inline void
+StringBuilderAppendF64Shortest(string_builder *stringBuilder, f64 value)
+{
+  u8 fallback[FORMAT_SHORTEST_LENGTH_MAX];
+  u8 *dest = StringBuilderFormatBegin(stringBuilder, sizeof(fallback), fallback);
+  struct string string = FormatF64Shortest(&(struct string){.value = dest, .length = sizeof(fallback)}, value);
+  StringBuilderFormatEnd(stringBuilder, string, fallback);
 }
 
 /*
@@ -84,11 +309,39 @@ StringBuilderFlush(string_builder *stringBuilder)
   return result;
 }
 
+/* Last byte is cut when outBuffer is full, so terminator always fits. */
 static inline struct string
 StringBuilderFlushZeroTerminated(string_builder *stringBuilder)
 {
+  debug_assert(stringBuilder->outBuffer->length > 0);
+  if (unlikely(stringBuilder->length == stringBuilder->outBuffer->length)) {
+    stringBuilder->length--;
+    stringBuilder->isTruncated = 1;
+  }
   struct string result = StringBuilderFlush(stringBuilder);
   result.value[result.length] = 0;
-  debug_assert(result.length + 1 <= stringBuilder->outBuffer->length);
   return result;
 }
+
+/*
+ * Passes what is left in outBuffer to sink. For fd sink it is written, for
+ * arena sink it becomes last chunk, so chunks from firstChunk hold whole text.
+ *
+ *   for (string_builder_chunk *chunk = sb.firstChunk; chunk; chunk = chunk->next)
+ *     ...chunk->string...
+ *
+ * @return 0 when bytes were cut or could not be written since sink was attached
+ */
+static b8
+StringBuilderFlushToSink(string_builder *stringBuilder)
+{
+  if (stringBuilder->sink == STRING_BUILDER_SINK_FD) {
+    struct string string = StringBuilderFlush(stringBuilder);
+    if (!StringBuilderWriteFd(stringBuilder->fd, string.value, string.length))
+      stringBuilder->isTruncated = 1;
+  } else if (stringBuilder->sink == STRING_BUILDER_SINK_ARENA) {
+    if (!StringBuilderCloseChunk(stringBuilder))
+      stringBuilder->isTruncated = 1;
+  }
+  return !stringBuilder->isTruncated;
+}
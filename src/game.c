@@ -1,5 +1,6 @@
 #include "game.h"
 #include "color.h"
+#include "hash.h"
 #include "math.h"
 #include "renderer.h"
 #include "string_builder.h"
@@ -7,16 +8,575 @@
 #include "physics.c"
 #include "random.c"
 #include "renderer.c"
+#include "rewind.c"
 
-#if IS_BUILD_DEBUG
-#include <unistd.h> // write()
+static inline u32
+GameStateHashParticlesPerChunk(u32 particleCount)
+{
+  u32 particlesPerChunk = (particleCount + GAME_STATE_HASH_CHUNK_MAX - 1) / GAME_STATE_HASH_CHUNK_MAX;
+  if (particlesPerChunk == 0)
+    particlesPerChunk = 1;
+  return particlesPerChunk;
+}
+
+/* Cuts particles into chunks, every chunk must be hashed before GameStateHashEnd() */
+static void
+GameStateHashBegin(game_state_hash *hash, u32 particleCount)
+{
+  u32 particlesPerChunk = GameStateHashParticlesPerChunk(particleCount);
+  hash->particleCount = particleCount;
+  hash->particlesPerChunk = particlesPerChunk;
+  hash->chunkCount = (particleCount + particlesPerChunk - 1) / particlesPerChunk;
+}
+
+static inline void
+GameStateHashChunk(game_state *state, game_state_hash *hash, u32 chunkIndex)
+{
+  u32 firstParticleIndex = chunkIndex * hash->particlesPerChunk;
+  u32 chunkParticleCount = Minimum(hash->particlesPerChunk, hash->particleCount - firstParticleIndex);
+  hash->chunks[chunkIndex] =
+      Hash64(state->particles + firstParticleIndex, sizeof(*state->particles) * chunkParticleCount, chunkIndex);
+}
+
+/*
+ * Pointers are not hashed, permanent storage is always at same address.
+ * Only values that simulation produces are.
+ */
+static void
+GameStateHashEnd(game_state *state, game_state_hash *hash)
+{
+  u32 isImpulseAiming = state->isImpulseAiming;
+  u64 fieldsHash = 0;
+  fieldsHash = Hash64(&state->effectsEntropy, sizeof(state->effectsEntropy), fieldsHash);
+  fieldsHash = Hash64(&state->particleCount, sizeof(state->particleCount), fieldsHash);
+  fieldsHash = Hash64(&state->liquid, sizeof(state->liquid), fieldsHash);
+  fieldsHash = Hash64(&state->springAnchorPosition, sizeof(state->springAnchorPosition), fieldsHash);
+  fieldsHash = Hash64(&state->camera, sizeof(state->camera), fieldsHash);
+  fieldsHash = Hash64(&isImpulseAiming, sizeof(isImpulseAiming), fieldsHash);
+  fieldsHash = Hash64(&state->time, sizeof(state->time), fieldsHash);
+
+  hash->fieldsHash = fieldsHash;
+  hash->value = Hash64(hash->chunks, sizeof(*hash->chunks) * hash->chunkCount, fieldsHash);
+}
+
+static void
+GameStateHashUpdate(game_state *state, game_state_hash *hash)
+{
+  GameStateHashBegin(hash, state->particleCount);
+  for (u32 chunkIndex = 0; chunkIndex < hash->chunkCount; chunkIndex++)
+    GameStateHashChunk(state, hash, chunkIndex);
+  GameStateHashEnd(state, hash);
+}
+
+// unit: m, particles bounce off it
+comptime f32 GROUND = -5.8f;
+
+#if IS_PHYSICS_FIXED_POINT
+/*
+ * ScreenToWorld() of mouse stick done in fixed point. Float matrices are
+ * contracted to FMA or not depending on compiler and flags, so aiming from
+ * them would break replays across builds.
+ * Inverse of RendererSetCamera(): p + R(θ) (c.x rsX, c.y rsY) / (60 zoom)
+ */
+static v2q
+MouseStickToWorldFixed(render_camera camera, v2 screenCenter, f32 rsX, f32 rsY)
+{
+  q16 pixelsPerMeter = q16_mul(Q16(PIXELS_PER_METER), q16_from_f32(camera.zoom));
+  v2q offset = {
+      q16_div(q16_mul(q16_from_f32(rsX), q16_from_f32(screenCenter.x)), pixelsPerMeter),
+      q16_div(q16_mul(q16_from_f32(rsY), q16_from_f32(screenCenter.y)), pixelsPerMeter),
+  };
+  offset = v2q_rotate(offset, q16_from_f32(camera.rotation));
+  return v2q_add(v2q_from_v2(camera.position), offset);
+}
+#endif
+
+/*
+ * Advances world by one step. Reads nothing but state and stepInput, so
+ * replaying steps on top of a snapshot gives same frames again.
+ */
+static void
+GameStep(game_state *state, game_step_input *stepInput, game_state_hash *hash)
+{
+  struct particle *firstParticle = state->particles + 0;
+  state->time += stepInput->dt;
+
+  if (stepInput->isLeftButtonDown) {
+    state->isImpulseAiming = 1;
+  }
+
+  if (state->isImpulseAiming && !stepInput->isLeftButtonDown) {
+    state->isImpulseAiming = 0;
+
+#if IS_PHYSICS_FIXED_POINT
+    // ‖d‖ 5 normalized(d) = 5 d
+    v2q diff = v2q_sub(firstParticle->position, stepInput->mousePositionFixed);
+    firstParticle->velocity = v2q_scale(diff, Q16(5.0));
+#else
+    v2 diff = v2_sub(firstParticle->position, stepInput->mousePosition);
+    f32 impulseMagnitude = v2_length(diff) * 5.0f;
+    v2 impulseDirection = v2_normalize(diff);
+    v2 impulseVector = v2_scale(impulseDirection, impulseMagnitude);
+    firstParticle->velocity = impulseVector;
+#endif
+
+#if (1 && IS_BUILD_DEBUG)
+    {
+#if IS_PHYSICS_FIXED_POINT
+      v2 impulseVector = v2q_to_v2(firstParticle->velocity);
+#endif
+      string_builder *sb = LogBegin();
+      StringBuilderAppendString(sb, &STRING_FROM_ZERO_TERMINATED("impulse: "));
+      StringBuilderAppendF32(sb, impulseVector.x, 2);
+      StringBuilderAppendString(sb, &STRING_FROM_ZERO_TERMINATED(","));
+      StringBuilderAppendF32(sb, impulseVector.y, 2);
+      StringBuilderAppendString(sb, &STRING_FROM_ZERO_TERMINATED("\n"));
+      LogEnd(sb, STDOUT_FILENO);
+    }
+#endif
+  }
+#if 0
+  static f32 lbPressedAt = 0.0f;
+  if (stepInput->isLeftButtonDown) {
+    if (lbPressedAt == 0.0f && state->particleCount != state->particleMax) {
+      u32 particleIndex = state->particleCount;
+      struct particle *particle = state->particles + particleIndex;
+      particle->position = stepInput->mousePosition;
+      particle->mass = 1.0f;
+      particle->invMass = 1.0f / particle->mass;
+
+      state->particleCount++;
+
+      lbPressedAt = state->time;
+    }
+
+    // Register click at 100ms intervals.
+    // 1s = 10³ms
+    if ((state->time - lbPressedAt) >= 0.1f) {
+      lbPressedAt = 0.0f;
+    }
+  } else {
+    lbPressedAt = 0.0f;
+  }
 #endif
 
+#if (0 && IS_BUILD_DEBUG)
+  {
+    particle *slowestParticle = state->particles + 0;
+    particle *fastestParticle = state->particles + 0;
+    for (u32 particleIndex = 0; particleIndex < state->particleCount; particleIndex++) {
+      struct particle *particle = state->particles + particleIndex;
+
+      if (v2_length_square(particle->velocity) < v2_length_square(slowestParticle->velocity))
+        slowestParticle = particle;
+
+      if (v2_length_square(particle->velocity) > v2_length_square(fastestParticle->velocity))
+        fastestParticle = particle;
+    }
+
+    string_builder *sb = LogBegin();
+#define STRING_BUILDER_APPEND_PARTICLE(prefix, particle)                                                               \
+  StringBuilderAppendString(sb, &STRING_FROM_ZERO_TERMINATED(prefix));                                                 \
+  StringBuilderAppendString(sb, &STRING_FROM_ZERO_TERMINATED("\n  mass:         "));                                   \
+  StringBuilderAppendF32(sb, particle->mass, 2);                                                                       \
+  StringBuilderAppendString(sb, &STRING_FROM_ZERO_TERMINATED("kg "));                                                  \
+  StringBuilderAppendString(sb, &STRING_FROM_ZERO_TERMINATED("\n  position:     "));                                   \
+  StringBuilderAppendF32(sb, particle->position.x, 2);                                                                 \
+  StringBuilderAppendString(sb, &STRING_FROM_ZERO_TERMINATED(", "));                                                   \
+  StringBuilderAppendF32(sb, particle->position.y, 2);                                                                 \
+  StringBuilderAppendString(sb, &STRING_FROM_ZERO_TERMINATED("\n  velocity:     "));                                   \
+  StringBuilderAppendF32(sb, v2_length(particle->velocity), 2);                                                        \
+  StringBuilderAppendString(sb, &STRING_FROM_ZERO_TERMINATED("m/s "));                                                 \
+  StringBuilderAppendF32(sb, particle->velocity.x, 2);                                                                 \
+  StringBuilderAppendString(sb, &STRING_FROM_ZERO_TERMINATED(", "));                                                   \
+  StringBuilderAppendF32(sb, particle->velocity.y, 2);                                                                 \
+  StringBuilderAppendString(sb, &STRING_FROM_ZERO_TERMINATED("\n"))
+
+    STRING_BUILDER_APPEND_PARTICLE("slowest particle:", slowestParticle);
+    STRING_BUILDER_APPEND_PARTICLE("fastest particle:", fastestParticle);
+#undef STRING_BUILDER_APPEND_PARTICLE
+
+    LogEnd(sb, STDOUT_FILENO);
+  }
+#endif
+
+#if (0 && IS_BUILD_DEBUG)
+  {
+    string_builder *sb = LogBegin();
+    StringBuilderAppendF32(sb, &STRING_FROM_ZERO_TERMINATED("\n"));
+    StringBuilderAppendString(sb, &STRING_FROM_ZERO_TERMINATED("\n"));
+    LogEnd(sb, STDOUT_FILENO);
+  }
+#endif
+
+  // particles are stepped in same chunks as they are hashed
+  u32 particleCount = state->particleCount;
+  u32 particlesPerChunk = GameStateHashParticlesPerChunk(particleCount);
+  u32 chunkCount = (particleCount + particlesPerChunk - 1) / particlesPerChunk;
+  if (hash)
+    GameStateHashBegin(hash, particleCount);
+
+#if IS_PHYSICS_FIXED_POINT
+  q16 dtFixed = q16_from_f32(stepInput->dt);
+  q16 groundFixed = q16_from_f32(GROUND);
+  v2q inputForceFixed = v2q_scale(stepInput->inputForceFixed, Q16(15.0));
+  v2q springAnchorPositionFixed = v2q_from_v2(state->springAnchorPosition);
+  for (u32 chunkIndex = 0; chunkIndex < chunkCount; chunkIndex++) {
+    u32 particleIndexEnd = Minimum((chunkIndex + 1) * particlesPerChunk, particleCount);
+    for (u32 particleIndex = chunkIndex * particlesPerChunk; particleIndex < particleIndexEnd; particleIndex++) {
+      struct particle *particle = state->particles + particleIndex;
+
+      /*
+       * - Apply forces
+       */
+      v2q sumOfForces = inputForceFixed;
+
+      v2q weightForce = GenerateWeightForce(particle);
+      sumOfForces = v2q_add(sumOfForces, weightForce);
+
+      v2q dragForce = GenerateDragForce(particle, Q16(0.001));
+      sumOfForces = v2q_add(sumOfForces, dragForce);
+
+      if (particle == firstParticle) {
+        v2q springForce = GenerateSpringForce(particle, springAnchorPositionFixed, Q16(2.0), Q16(100.0));
+        sumOfForces = v2q_add(sumOfForces, springForce);
+      }
+
+      /*
+       * Integrate applied forces
+       */
+      IntegrateParticle(particle, sumOfForces, dtFixed);
+
+      // TODO: Ground collision is broken
+      if (particle->position.y <= groundFixed) {
+        // reflect
+        // v' = v - 2(v∙n)n
+        // where n is (0, 1)
+        particle->velocity.y = -particle->velocity.y;
+      }
+
+      // Is particle over 15m away from origin?
+      if (v2q_length(particle->position) > Q16(15.0)) {
+        random_series *effectsEntropy = &state->effectsEntropy;
+        particle->position = (v2q){
+            .x = RandomBetweens32(effectsEntropy, Q16(-5.0), Q16(5.0)),
+            .y = RandomBetweens32(effectsEntropy, Q16(-5.0), Q16(5.0)),
+        };
+        particle->velocity = (v2q){0, 0};
+      }
+    }
+
+    // stepped particles are still in cache
+    if (hash)
+      GameStateHashChunk(state, hash, chunkIndex);
+  }
+#else
+  for (u32 chunkIndex = 0; chunkIndex < chunkCount; chunkIndex++) {
+    u32 particleIndexEnd = Minimum((chunkIndex + 1) * particlesPerChunk, particleCount);
+    for (u32 particleIndex = chunkIndex * particlesPerChunk; particleIndex < particleIndexEnd; particleIndex++) {
+      struct particle *particle = state->particles + particleIndex;
+
+      /*
+       * - Apply forces
+       */
+      v2 sumOfForces = {0.0f, 0.0f};
+
+      // apply input force
+      sumOfForces = v2_add(sumOfForces, v2_scale(stepInput->inputForce, 15.0f));
+
+      // apply weight force
+      v2 weightForce = GenerateWeightForce(particle);
+      sumOfForces = v2_add(sumOfForces, weightForce);
+
+      // apply drag force
+      v2 dragForce = GenerateDragForce(particle, 0.001f);
+      sumOfForces = v2_add(sumOfForces, dragForce);
+
+      // apply spring force
+      if (particle == firstParticle) {
+        f32 restLength = 2.0f;
+        v2 springForce = GenerateSpringForce(particle, state->springAnchorPosition, restLength, 100.0f);
+        sumOfForces = v2_add(sumOfForces, springForce);
+      }
+
+      /*
+       * Integrate applied forces
+       */
+      IntegrateParticle(particle, sumOfForces, stepInput->dt);
+
+      // TODO: Ground collision is broken
+      if (particle->position.y <= GROUND) {
+        v2 groundNormal = {0.0f, 1.0f};
+
+        // reflect
+        // v' = v - 2(v∙n)n
+        particle->velocity =
+            v2_sub(particle->velocity, v2_scale(groundNormal, 2.0f * v2_dot(particle->velocity, groundNormal)));
+      }
+
+      // Is particle over 15m away from origin?
+      if (v2_length_square(particle->position) > Square(15.0f)) {
+        random_series *effectsEntropy = &state->effectsEntropy;
+        particle->position = (v2){
+            .x = RandomBetween(effectsEntropy, -5.0f, 5.0f),
+            .y = RandomBetween(effectsEntropy, -5.0f, 5.0f),
+        };
+        particle->velocity = (v2){0, 0};
+      }
+    }
+
+    // stepped particles are still in cache
+    if (hash)
+      GameStateHashChunk(state, hash, chunkIndex);
+  }
+#endif
+}
+
+#define GAME_REWIND_STREAM_COUNT 2
+
+static void
+GameRewindStreams(game_state *state, rewind_stream streams[GAME_REWIND_STREAM_COUNT])
+{
+  streams[0] = (rewind_stream){state, sizeof(*state)};
+  streams[1] = (rewind_stream){state->particles, sizeof(*state->particles) * state->particleCount};
+}
+
+/* @return frames that can be rewound to, newest included */
+static u32
+GameRewindFrameCount(transient_state *transientState)
+{
+  rewind_buffer *rewind = &transientState->rewind;
+  if (rewind->frameCount == 0)
+    return 0;
+  return (rewind->frameCount - 1) * REWIND_SNAPSHOT_INTERVAL + transientState->rewindFramesSinceSnapshot + 1;
+}
+
+/* Appends step input of newest frame, world state is only copied every REWIND_SNAPSHOT_INTERVAL frames. */
+static void
+GameRewindCapture(game_state *state, transient_state *transientState, game_step_input *stepInput)
+{
+  rewind_buffer *rewind = &transientState->rewind;
+  if (!rewind->data)
+    return;
+
+  transientState->rewindStepIndex = (transientState->rewindStepIndex + 1) % REWIND_FRAME_MAX;
+  transientState->rewindSteps[transientState->rewindStepIndex] = *stepInput;
+  if (rewind->frameCount > 0 && transientState->rewindFramesSinceSnapshot + 1 < REWIND_SNAPSHOT_INTERVAL) {
+    transientState->rewindFramesSinceSnapshot++;
+    return;
+  }
+
+  rewind_stream streams[GAME_REWIND_STREAM_COUNT];
+  GameRewindStreams(state, streams);
+  RewindBufferCapture(rewind, streams, GAME_REWIND_STREAM_COUNT);
+  transientState->rewindFramesSinceSnapshot = 0;
+}
+
+/*
+ * Writes frame that is framesAgo before newest into state, by restoring
+ * snapshot before it and replaying steps after the snapshot.
+ * When isTruncating, frames after it are dropped and capture continues from it.
+ */
+static void
+GameRewind(game_state *state, transient_state *transientState, u32 framesAgo, b8 isTruncating)
+{
+  debug_assert(framesAgo < GameRewindFrameCount(transientState));
+  rewind_buffer *rewind = &transientState->rewind;
+  rewind_stream streams[GAME_REWIND_STREAM_COUNT];
+  GameRewindStreams(state, streams);
+
+  // newest snapshot is rewindFramesSinceSnapshot frames ago, older ones are REWIND_SNAPSHOT_INTERVAL apart
+  u32 framesSinceSnapshot = transientState->rewindFramesSinceSnapshot;
+  u32 snapshotsAgo = 0;
+  if (framesAgo > framesSinceSnapshot)
+    snapshotsAgo = (framesAgo - framesSinceSnapshot + REWIND_SNAPSHOT_INTERVAL - 1) / REWIND_SNAPSHOT_INTERVAL;
+  u32 snapshotFramesAgo = framesSinceSnapshot + snapshotsAgo * REWIND_SNAPSHOT_INTERVAL;
+  u32 stepCount = snapshotFramesAgo - framesAgo;
+
+  if (isTruncating)
+    RewindBufferTruncate(rewind, streams, GAME_REWIND_STREAM_COUNT, snapshotsAgo);
+  else
+    RewindBufferRestore(rewind, streams, GAME_REWIND_STREAM_COUNT, snapshotsAgo);
+
+  u32 snapshotStepIndex =
+      (transientState->rewindStepIndex + REWIND_FRAME_MAX - snapshotFramesAgo) % REWIND_FRAME_MAX;
+  for (u32 stepIndex = 1; stepIndex <= stepCount; stepIndex++)
+    GameStep(state, transientState->rewindSteps + (snapshotStepIndex + stepIndex) % REWIND_FRAME_MAX, 0);
+
+  if (isTruncating) {
+    transientState->rewindStepIndex =
+        (transientState->rewindStepIndex + REWIND_FRAME_MAX - framesAgo) % REWIND_FRAME_MAX;
+    transientState->rewindFramesSinceSnapshot = stepCount;
+  }
+}
+
+/* Appends used / total in megabytes, used is high-water mark of arena */
+static void
+HudAppendArena(string_builder *sb, memory_arena *arena)
+{
+  const f32 bytesToMegabytes = 1.0f / (1 << 20);
+  StringBuilderAppendF32(sb, (f32)arena->usedMax * bytesToMegabytes, 1);
+  StringBuilderAppendString(sb, &STRING_FROM_ZERO_TERMINATED(" / "));
+  StringBuilderAppendF32(sb, (f32)arena->total * bytesToMegabytes, 1);
+  StringBuilderAppendString(sb, &STRING_FROM_ZERO_TERMINATED(" MB\n"));
+}
+
+/* Appends instructions per cycle and misses per particle of timed block, or a dash when counter is not open */
+static void
+HudAppendCounters(string_builder *sb, const char *blockName, u32 particleCount)
+{
+  profiler_counters counters;
+  if (!ProfilerFindCounters(globalProfiler, blockName, &counters)) {
+    StringBuilderAppendString(sb, &STRING_FROM_ZERO_TERMINATED("-\n"));
+    return;
+  }
+
+  u64 *values = counters.values;
+  StringBuilderAppendString(sb, &STRING_FROM_ZERO_TERMINATED("ipc "));
+  if ((counters.mask & (1u << PROFILER_COUNTER_INSTRUCTIONS)) && values[PROFILER_COUNTER_CYCLES] > 0)
+    StringBuilderAppendF32(sb, (f32)values[PROFILER_COUNTER_INSTRUCTIONS] / (f32)values[PROFILER_COUNTER_CYCLES], 2);
+  else
+    StringBuilderAppendString(sb, &STRING_FROM_ZERO_TERMINATED("-"));
+
+  static const char *MISS_LABELS[] = {" l1d/p ", " llc/p ", " br/p "};
+  f32 invParticleCount = 1.0f / (f32)Maximum(particleCount, 1);
+  for (u32 counter = PROFILER_COUNTER_L1D_MISSES; counter < PROFILER_COUNTER_COUNT; counter++) {
+    StringBuilderAppendZeroTerminated(sb, MISS_LABELS[counter - PROFILER_COUNTER_L1D_MISSES], 8);
+    if (counters.mask & (1u << counter))
+      StringBuilderAppendF32(sb, (f32)values[counter] * invParticleCount, 2);
+    else
+      StringBuilderAppendString(sb, &STRING_FROM_ZERO_TERMINATED("-"));
+  }
+  StringBuilderAppendString(sb, &STRING_FROM_ZERO_TERMINATED("\n"));
+}
+
+/*
+ * Draws performance overlay at top left of screen.
+ * Render stats are of last rendered frame, renderer memory is used until end
+ * of frame so its high-water mark also lags one frame.
+ * With hardware counters, see ProfilerOpenCounters(), it also shows them for
+ * physics, render recording and last render frame.
+ */
+static void
+HudDraw(game_memory *memory, transient_state *transientState, game_renderer *renderer)
+{
+  game_state *state = memory->permanentStorage;
+  string_builder *sb = transientState->sb;
+  render_stats *stats = &renderer->stats;
+
+  comptime f32 SCALE = 1.0f;
+  comptime f32 PADDING = 8.0f;
+  comptime u32 LABEL_WIDTH = 12; // unit: characters, longest label and a space
+  comptime f32 BAR_WIDTH = 2.0f;
+  comptime f32 GRAPH_HEIGHT = 64.0f;
+  comptime f32 GRAPH_TIME_MAX = 2.0f / 60.0f; // unit: sec, top of graph
+  comptime f32 FRAME_TIME_TARGET = 1.0f / 60.0f;
+
+  b8 isCounting = globalProfiler && globalProfiler->counterMask;
+  u32 lineCount = isCounting ? 13 : 10;
+  u32 valueWidth = isCounting ? 40 : 22; // unit: characters
+
+  // glyphs are square, so it is also line height
+  f32 glyphSize = FONT_GLYPH_SIZE * SCALE;
+  f32 graphWidth = HUD_FRAME_TIME_COUNT * BAR_WIDTH;
+  f32 panelWidth = Maximum(graphWidth, (f32)(LABEL_WIDTH + valueWidth) * glyphSize) + 2.0f * PADDING;
+  f32 panelHeight = (f32)lineCount * glyphSize + GRAPH_HEIGHT + 3.0f * PADDING;
+  v2 textPosition = {PADDING, PADDING};
+  v2 graphMin = {PADDING, PADDING + (f32)lineCount * glyphSize + PADDING};
+
+  RendererSetLayer(renderer, RENDER_LAYER_SCREEN);
+
+  v4 panelColor = COLOR_ZINC_950;
+  panelColor.a = 0.8f;
+  DrawRect(renderer, (rect){{0.0f, 0.0f}, {panelWidth, panelHeight}}, panelColor);
+
+  // frame time graph, oldest frame at left, bars grow up from bottom
+  u32 frameTimeIndex = transientState->frameTimeIndex;
+  f32 frameTimeSum = 0.0f;
+  for (u32 barIndex = 0; barIndex < HUD_FRAME_TIME_COUNT; barIndex++) {
+    f32 frameTime = transientState->frameTimes[(frameTimeIndex + barIndex) % HUD_FRAME_TIME_COUNT];
+    frameTimeSum += frameTime;
+    if (frameTime <= 0.0f)
+      continue;
+
+    f32 barHeight = Minimum(frameTime / GRAPH_TIME_MAX, 1.0f) * GRAPH_HEIGHT;
+    f32 x = graphMin.x + (f32)barIndex * BAR_WIDTH;
+    f32 bottom = graphMin.y + GRAPH_HEIGHT;
+    v4 color = frameTime > FRAME_TIME_TARGET * 1.05f ? COLOR_RED_500 : COLOR_GREEN_500;
+    DrawRect(renderer, (rect){{x, bottom - barHeight}, {x + BAR_WIDTH, bottom}}, color);
+  }
+  f32 targetY = graphMin.y + GRAPH_HEIGHT * (1.0f - FRAME_TIME_TARGET / GRAPH_TIME_MAX);
+  DrawLine(renderer, (v2){graphMin.x, targetY}, (v2){graphMin.x + graphWidth, targetY}, COLOR_AMBER_400, 0);
+
+  // labels and values are separate columns, so values line up
+  StringBuilderAppendString(sb, &STRING_FROM_ZERO_TERMINATED("frame\n"
+                                                              "average\n"
+                                                              "physics\n"
+                                                              "hud\n"
+                                                              "commands\n"
+                                                              "particles\n"
+                                                              "world\n"
+                                                              "transient\n"
+                                                              "renderer\n"
+                                                              "rewind\n"));
+  if (isCounting)
+    StringBuilderAppendString(sb, &STRING_FROM_ZERO_TERMINATED("physics pmu\n"
+                                                                "record pmu\n"
+                                                                "render pmu\n"));
+  struct string labels = StringBuilderFlush(sb);
+  DrawText(renderer, &labels, textPosition, SCALE, COLOR_ZINC_400);
+
+  f32 frameTime = transientState->frameTimes[(frameTimeIndex + HUD_FRAME_TIME_COUNT - 1) % HUD_FRAME_TIME_COUNT];
+  StringBuilderAppendF32(sb, frameTime * 1000.0f, 2);
+  StringBuilderAppendString(sb, &STRING_FROM_ZERO_TERMINATED(" ms\n"));
+  f32 averageFrameTime = frameTimeSum / HUD_FRAME_TIME_COUNT;
+  StringBuilderAppendF32(sb, averageFrameTime * 1000.0f, 2);
+  StringBuilderAppendString(sb, &STRING_FROM_ZERO_TERMINATED(" ms "));
+  StringBuilderAppendU64(sb, averageFrameTime > 0.0f ? (u64)(1.0f / averageFrameTime + 0.5f) : 0);
+  StringBuilderAppendString(sb, &STRING_FROM_ZERO_TERMINATED(" fps\n"));
+  StringBuilderAppendF32(sb, transientState->physicsTime * 1000.0f, 2);
+  StringBuilderAppendString(sb, &STRING_FROM_ZERO_TERMINATED(" ms\n"));
+  StringBuilderAppendF32(sb, transientState->hudTime * 1000.0f, 3);
+  StringBuilderAppendString(sb, &STRING_FROM_ZERO_TERMINATED(" ms\n"));
+  StringBuilderAppendU64(sb, stats->commandCount);
+  StringBuilderAppendString(sb, &STRING_FROM_ZERO_TERMINATED(" in "));
+  StringBuilderAppendU64(sb, stats->drawCallCount);
+  StringBuilderAppendString(sb, &STRING_FROM_ZERO_TERMINATED(" draws\n"));
+  StringBuilderAppendU64(sb, state->particleCount);
+  StringBuilderAppendString(sb, &STRING_FROM_ZERO_TERMINATED("\n"));
+  HudAppendArena(sb, &state->worldArena);
+  HudAppendArena(sb, &transientState->transientArena);
+  HudAppendArena(sb, &renderer->memory);
+  rewind_buffer *rewind = &transientState->rewind;
+  if (rewind->data) {
+    StringBuilderAppendU64(sb, GameRewindFrameCount(transientState));
+    StringBuilderAppendString(sb, &STRING_FROM_ZERO_TERMINATED(" / "));
+    StringBuilderAppendU64(sb, REWIND_FRAME_MAX);
+    StringBuilderAppendString(sb, &STRING_FROM_ZERO_TERMINATED(" frames\n"));
+  } else if (memory->isRewindEnabled) {
+    StringBuilderAppendString(sb, &STRING_FROM_ZERO_TERMINATED("off, does not fit\n"));
+  } else {
+    StringBuilderAppendString(sb, &STRING_FROM_ZERO_TERMINATED("off\n"));
+  }
+  if (isCounting) {
+    HudAppendCounters(sb, "Physics", state->particleCount);
+    HudAppendCounters(sb, "RenderRecording", state->particleCount);
+    HudAppendCounters(sb, "RenderFrame", state->particleCount);
+  }
+  struct string values = StringBuilderFlush(sb);
+  DrawText(renderer, &values, v2_add(textPosition, (v2){(f32)LABEL_WIDTH * glyphSize, 0.0f}), SCALE,
+           COLOR_ZINC_200);
+
+  RendererSetLayer(renderer, RENDER_LAYER_WORLD);
+}
+
 void
 GameUpdateAndRender(game_memory *memory, game_input *input, game_renderer *renderer)
 {
   game_state *state = memory->permanentStorage;
   debug_assert(memory->permanentStorageSize >= sizeof(*state));
+  globalProfiler = memory->profiler;
+  globalLogger = memory->logger;
 
   /*****************************************************************
    * PERMANENT STORAGE INITIALIZATION
@@ -32,11 +592,24 @@ GameUpdateAndRender(game_memory *memory, game_input *input, game_renderer *rende
     state->effectsEntropy = RandomSeed(213);
     random_series *effectsEntropy = &state->effectsEntropy;
 
-    state->particleMax = 2;
-    state->particleCount = 1;
+    state->particleCount = memory->particleCount ? memory->particleCount : 1;
+    state->particleMax = Maximum(state->particleCount, 2);
+    debug_assert(sizeof(*state->particles) * state->particleMax <= worldArena->total &&
+                 "not enough memory for particles");
     state->particles = MemoryArenaPush(worldArena, sizeof(*state->particles) * state->particleMax, 4);
     for (u32 particleIndex = 0; particleIndex < state->particleCount; particleIndex++) {
       struct particle *particle = state->particles + particleIndex;
+#if IS_PHYSICS_FIXED_POINT
+      *particle = (struct particle){
+          .position =
+              {
+                  .x = RandomBetweens32(effectsEntropy, Q16(-5.0), Q16(5.0)),
+                  .y = RandomBetweens32(effectsEntropy, Q16(-5.0), Q16(5.0)),
+              },
+          .mass = RandomBetweens32(effectsEntropy, Q16(0.1), Q16(8.0)),
+      };
+      particle->invMass = q16_div(Q16_ONE, particle->mass);
+#else
       *particle = (struct particle){
           .position =
               {
@@ -47,8 +620,15 @@ GameUpdateAndRender(game_memory *memory, game_input *input, game_renderer *rende
       };
       particle->mass = RandomBetween(effectsEntropy, 0.1f, 8.0f);
       particle->invMass = 1.0f / particle->mass;
+#endif
     }
 
+    state->camera = (render_camera){
+        .position = {0.0f, 0.0f},
+        .zoom = 1.0f,
+        .rotation = 0.0f,
+    };
+
     rect surfaceRect = RendererGetSurfaceRect(renderer);
     state->liquid = (rect){
         .min = surfaceRect.min,
@@ -59,9 +639,15 @@ GameUpdateAndRender(game_memory *memory, game_input *input, game_renderer *rende
     {
       state->springAnchorPosition = (v2){0.0f, 2.0f};
       particle *firstParticle = state->particles + 0;
+#if IS_PHYSICS_FIXED_POINT
+      firstParticle->position = (v2q){Q16(0.0), Q16(0.0)};
+      firstParticle->mass = Q16(3.0);
+      firstParticle->invMass = q16_div(Q16_ONE, firstParticle->mass);
+#else
       firstParticle->position = (v2){0.0f, 0.0f};
       firstParticle->mass = 3.0f;
       firstParticle->invMass = 1.0f / firstParticle->mass;
+#endif
     }
 #endif
 
@@ -79,34 +665,53 @@ GameUpdateAndRender(game_memory *memory, game_input *input, game_renderer *rende
         .block = memory->transientStorage + sizeof(*transientState),
     };
 
+    // every snapshot is a keyframe, particles move every frame so delta of one would cost as much as a copy
+    // ring grows with state
+    rewind_stream streams[GAME_REWIND_STREAM_COUNT];
+    GameRewindStreams(state, streams);
+    u64 rewindStateSize = RewindStateSize(streams, GAME_REWIND_STREAM_COUNT);
+    u64 rewindMemorySize = Maximum(16 * 1024 * 1024, REWIND_STATE_COPY_COUNT * rewindStateSize);
+    if (memory->isRewindEnabled)
+      RewindBufferInit(&transientState->rewind, &transientState->transientArena, rewindMemorySize,
+                       REWIND_FRAME_MAX / REWIND_SNAPSHOT_INTERVAL, 1, streams, GAME_REWIND_STREAM_COUNT);
+    if (memory->isRewindEnabled && !transientState->rewind.data) {
+      string_builder *sb = LogBegin();
+      StringBuilderAppendString(sb, &STRING_FROM_ZERO_TERMINATED("warning: rewind is off, transient storage cannot "
+                                                                 "fit one keyframe of "));
+      StringBuilderAppendU64(sb, rewindStateSize);
+      StringBuilderAppendString(sb, &STRING_FROM_ZERO_TERMINATED(" bytes\n"));
+      LogEnd(sb, STDERR_FILENO);
+    }
+
     transientState->isInitialized = 1;
   }
 
-  string_builder *sb = transientState->sb;
+  // frames in ring are of state that is gone, deltas against it would be garbage
+  if (memory->isStateReplaced) {
+    RewindBufferReset(&transientState->rewind);
+    transientState->rewindFramesSinceSnapshot = 0;
+    transientState->rewindFramesAgo = 0;
+    memory->isStateReplaced = 0;
+  }
 
   /*****************************************************************
    * TIME
    *****************************************************************/
   f32 dt = input->dt;
   debug_assert(dt > 0);
-  state->time += dt;
-#if (0 && IS_BUILD_DEBUG)
-  {
-    StringBuilderAppendString(sb, &STRING_FROM_ZERO_TERMINATED("dt: "));
-    StringBuilderAppendF32(sb, dt, 4);
-    StringBuilderAppendString(sb, &STRING_FROM_ZERO_TERMINATED("\n"));
-    string string = StringBuilderFlush(sb);
-    write(STDOUT_FILENO, string.value, string.length);
-  }
-#endif
+  transientState->frameTimes[transientState->frameTimeIndex] = dt;
+  transientState->frameTimeIndex = (transientState->frameTimeIndex + 1) % HUD_FRAME_TIME_COUNT;
+
+  /*****************************************************************
+   * CAMERA
+   *****************************************************************/
+  RendererSetCamera(renderer, state->camera);
 
   /*****************************************************************
    * INPUT HANDLING
    *****************************************************************/
-  global b8 impulse = 0;
-  struct particle *firstParticle = state->particles + 0;
-  struct particle *secondParticle = state->particles + 1;
-  v2 mousePosition = {};
+  PROFILE_BEGIN(InputHandling);
+  game_step_input stepInput = {.dt = dt};
   v2 inputForce = {};
   for (u32 controllerIndex = 0; controllerIndex < ARRAY_COUNT(input->controllers); controllerIndex++) {
     game_controller *controller = input->controllers + controllerIndex;
@@ -119,195 +724,101 @@ GameUpdateAndRender(game_memory *memory, game_input *input, game_renderer *rende
     }
 
     if (controllerIndex == GAME_CONTROLLER_KEYBOARD_AND_MOUSE_INDEX) {
-      v2 surfaceHalfDim = RectGetHalfDim(RendererGetSurfaceRect(renderer));
-      mousePosition = v2_hadamard((v2){controller->rsX, controller->rsY}, // [-1.0, 1.0]
-                                  surfaceHalfDim);
-
-      if (controller->lb) {
-        impulse = 1;
-      }
-
-      if (impulse && !controller->lb) {
-        impulse = 0;
-
-        v2 diff = v2_sub(firstParticle->position, mousePosition);
-        f32 impulseMagnitude = v2_length(diff) * 5.0f;
-        v2 impulseDirection = v2_normalize(diff);
-        v2 impulseVector = v2_scale(impulseDirection, impulseMagnitude);
-        firstParticle->velocity = impulseVector;
-
-#if (1 && IS_BUILD_DEBUG)
-        {
-          StringBuilderAppendString(sb, &STRING_FROM_ZERO_TERMINATED("impulse: "));
-          StringBuilderAppendF32(sb, impulseVector.x, 2);
-          StringBuilderAppendString(sb, &STRING_FROM_ZERO_TERMINATED(","));
-          StringBuilderAppendF32(sb, impulseVector.y, 2);
-          StringBuilderAppendString(sb, &STRING_FROM_ZERO_TERMINATED("\n"));
-          string string = StringBuilderFlush(sb);
-          write(STDOUT_FILENO, string.value, string.length);
-        }
-#endif
-      }
-#if 0
-      static f32 lbPressedAt = 0.0f;
-      if (controller->lb) {
-        if (lbPressedAt == 0.0f && state->particleCount != state->particleMax) {
-          u32 particleIndex = state->particleCount;
-          struct particle *particle = state->particles + particleIndex;
-          particle->position = mousePosition;
-          particle->mass = 1.0f;
-          particle->invMass = 1.0f / particle->mass;
-
-          state->particleCount++;
-
-          lbPressedAt = state->time;
-        }
-
-        // Register click at 100ms intervals.
-        // 1s = 10³ms
-        if ((state->time - lbPressedAt) >= 0.1f) {
-          lbPressedAt = 0.0f;
-        }
-      } else {
-        lbPressedAt = 0.0f;
-      }
+      // [-1.0, 1.0] math coordinates to screen coordinates
+      v2 screenCenter = renderer->screenCenter;
+      v2 mouseInScreenSpace = {
+          screenCenter.x * (1.0f + controller->rsX),
+          screenCenter.y * (1.0f - controller->rsY),
+      };
+      stepInput.mousePosition = ScreenToWorld(renderer, mouseInScreenSpace);
+      stepInput.isLeftButtonDown = controller->lb;
+#if IS_PHYSICS_FIXED_POINT
+      stepInput.mousePositionFixed =
+          MouseStickToWorldFixed(state->camera, screenCenter, controller->rsX, controller->rsY);
 #endif
     }
 
     inputForce = v2_add(inputForce, input);
+#if IS_PHYSICS_FIXED_POINT
+    v2q inputFixed = {q16_from_f32(controller->lsX), q16_from_f32(controller->lsY)};
+    if (v2q_length_square(inputFixed) > Q16_ONE)
+      inputFixed = v2q_normalize(inputFixed);
+    stepInput.inputForceFixed = v2q_add(stepInput.inputForceFixed, inputFixed);
+#endif
+  }
+  stepInput.inputForce = inputForce;
+
+  // overlay is toggled when back is pressed on any controller
+  {
+    b8 isBackPressed = 0;
+    for (u32 controllerIndex = 0; controllerIndex < ARRAY_COUNT(input->controllers); controllerIndex++)
+      isBackPressed = isBackPressed || input->controllers[controllerIndex].back;
+    if (isBackPressed && !transientState->isHudTogglePressed)
+      transientState->isHudHidden = !transientState->isHudHidden;
+    transientState->isHudTogglePressed = isBackPressed;
   }
+  PROFILE_END(InputHandling);
 
   /*****************************************************************
    * PHYSICS
    *****************************************************************/
-#if (0 && IS_BUILD_DEBUG)
-  {
-    particle *slowestParticle = state->particles + 0;
-    particle *fastestParticle = state->particles + 0;
-    for (u32 particleIndex = 0; particleIndex < state->particleCount; particleIndex++) {
-      struct particle *particle = state->particles + particleIndex;
+  PROFILE_BEGIN(Physics);
+  u64 physicsBeginCounter = SDL_GetPerformanceCounter();
+  // particles are hashed by the step while they are in cache, only when platform compares hashes
+  game_state_hash *stateHash = memory->isStateHashEnabled ? &memory->stateHash : 0;
+  GameStep(state, &stepInput, stateHash);
+  transientState->physicsTime =
+      (f32)(SDL_GetPerformanceCounter() - physicsBeginCounter) / (f32)SDL_GetPerformanceFrequency();
+  PROFILE_END(Physics);
 
-      if (v2_length_square(particle->velocity) < v2_length_square(slowestParticle->velocity))
-        slowestParticle = particle;
-
-      if (v2_length_square(particle->velocity) > v2_length_square(fastestParticle->velocity))
-        fastestParticle = particle;
+  /*****************************************************************
+   * REWIND
+   *****************************************************************/
+  PROFILE_BEGIN(Rewind);
+  b8 isRewound = 0;
+  {
+    // hold right button to step back one frame every frame, release to continue from there
+    game_controller *keyboardAndMouse =
+        GameControllerGetKeyboardAndMouse(input->controllers, ARRAY_COUNT(input->controllers));
+    u32 rewindFrameCount = GameRewindFrameCount(transientState);
+    if (keyboardAndMouse->rb && rewindFrameCount > 0) {
+      // this frame's step is thrown away, rewound frame is shown instead
+      if (transientState->rewindFramesAgo + 1 < rewindFrameCount)
+        transientState->rewindFramesAgo++;
+      GameRewind(state, transientState, transientState->rewindFramesAgo, 0);
+      isRewound = 1;
+    } else if (transientState->rewindFramesAgo > 0) {
+      GameRewind(state, transientState, transientState->rewindFramesAgo, 1);
+      transientState->rewindFramesAgo = 0;
+      isRewound = 1;
+    } else {
+      GameRewindCapture(state, transientState, &stepInput);
     }
-
-#define STRING_BUILDER_APPEND_PARTICLE(prefix, particle)                                                               \
-  StringBuilderAppendString(sb, &STRING_FROM_ZERO_TERMINATED(prefix));                                                 \
-  StringBuilderAppendString(sb, &STRING_FROM_ZERO_TERMINATED("\n  mass:         "));                                   \
-  StringBuilderAppendF32(sb, particle->mass, 2);                                                                       \
-  StringBuilderAppendString(sb, &STRING_FROM_ZERO_TERMINATED("kg "));                                                  \
-  StringBuilderAppendString(sb, &STRING_FROM_ZERO_TERMINATED("\n  position:     "));                                   \
-  StringBuilderAppendF32(sb, particle->position.x, 2);                                                                 \
-  StringBuilderAppendString(sb, &STRING_FROM_ZERO_TERMINATED(", "));                                                   \
-  StringBuilderAppendF32(sb, particle->position.y, 2);                                                                 \
-  StringBuilderAppendString(sb, &STRING_FROM_ZERO_TERMINATED("\n  velocity:     "));                                   \
-  StringBuilderAppendF32(sb, v2_length(particle->velocity), 2);                                                        \
-  StringBuilderAppendString(sb, &STRING_FROM_ZERO_TERMINATED("m/s "));                                                 \
-  StringBuilderAppendF32(sb, particle->velocity.x, 2);                                                                 \
-  StringBuilderAppendString(sb, &STRING_FROM_ZERO_TERMINATED(", "));                                                   \
-  StringBuilderAppendF32(sb, particle->velocity.y, 2);                                                                 \
-  StringBuilderAppendString(sb, &STRING_FROM_ZERO_TERMINATED("\n  acceleration: "));                                   \
-  StringBuilderAppendF32(sb, particle->acceleration.x, 2);                                                             \
-  StringBuilderAppendString(sb, &STRING_FROM_ZERO_TERMINATED(", "));                                                   \
-  StringBuilderAppendF32(sb, particle->acceleration.y, 2);                                                             \
-  StringBuilderAppendString(sb, &STRING_FROM_ZERO_TERMINATED("\n"))
-
-    STRING_BUILDER_APPEND_PARTICLE("slowest particle:", slowestParticle);
-    STRING_BUILDER_APPEND_PARTICLE("fastest particle:", fastestParticle);
-#undef STRING_BUILDER_APPEND_PARTICLE
-
-    string string = StringBuilderFlush(sb);
-    write(STDOUT_FILENO, string.value, string.length);
   }
-#endif
+  PROFILE_END(Rewind);
 
-  f32 ground = -5.8f;
-
-#if (0 && IS_BUILD_DEBUG)
-  {
-    StringBuilderAppendF32(sb, &STRING_FROM_ZERO_TERMINATED("\n"));
-    StringBuilderAppendString(sb, &STRING_FROM_ZERO_TERMINATED("\n"));
-    string string = StringBuilderFlush(sb);
-    write(STDOUT_FILENO, string.value, string.length);
+  /*****************************************************************
+   * STATE HASH
+   *****************************************************************/
+  PROFILE_BEGIN(StateHash);
+  if (stateHash && isRewound) {
+    // particles the step hashed were replaced
+    GameStateHashUpdate(state, stateHash);
+  } else if (stateHash) {
+    GameStateHashEnd(state, stateHash);
   }
-#endif
-
-  for (u32 particleIndex = 0; particleIndex < state->particleCount; particleIndex++) {
-    struct particle *particle = state->particles + particleIndex;
-
-    /*
-     * - Apply forces
-     */
-    v2 sumOfForces = {0.0f, 0.0f};
+  PROFILE_END(StateHash);
+  memory->permanentStorageUsed = sizeof(*state) + state->worldArena.used;
 
-    // apply input force
-    sumOfForces = v2_add(sumOfForces, v2_scale(inputForce, 15.0f));
-
-    // apply weight force
-    v2 weightForce = GenerateWeightForce(particle);
-    sumOfForces = v2_add(sumOfForces, weightForce);
-
-    // apply drag force
-    v2 dragForce = GenerateDragForce(particle, 0.001f);
-    sumOfForces = v2_add(sumOfForces, dragForce);
-
-    // apply spring force
-    if (particle == firstParticle) {
-      f32 restLength = 2.0f;
-      v2 springForce = GenerateSpringForce(particle, state->springAnchorPosition, restLength, 100.0f);
-      sumOfForces = v2_add(sumOfForces, springForce);
-    }
-
-    /*
-     * Integrate applied forces
-     */
-    // F = ma
-    // a = F/m
-    particle->acceleration = v2_scale(sumOfForces, particle->invMass);
-
-    // acceleration = f''(t) = a
-    // particle->acceleration = v2_scale((v2){1.0f, 0.0f}, speed);
-
-    // velocity     = ∫f''(t)
-    //              = f'(t) = at + v₀
-    // position     = ∫f'(t)
-    //              = f(t) = ½at² + vt + p₀
-    particle->velocity = v2_add(particle->velocity, v2_scale(particle->acceleration, dt));
-    particle->position =
-        // ½at² + vt + p₀
-        v2_add(particle->position, v2_add(
-                                       // ½at²
-                                       v2_scale(particle->acceleration, 0.5f * Square(dt)),
-                                       // + vt
-                                       v2_scale(particle->velocity, dt)));
-
-    // TODO: Ground collision is broken
-    if (particle->position.y <= ground) {
-      v2 groundNormal = {0.0f, 1.0f};
-
-      // reflect
-      // v' = v - 2(v∙n)n
-      particle->velocity =
-          v2_sub(particle->velocity, v2_scale(groundNormal, 2.0f * v2_dot(particle->velocity, groundNormal)));
-    }
-
-    // Is particle over 15m away from origin?
-    if (v2_length_square(particle->position) > Square(15.0f)) {
-      random_series *effectsEntropy = &state->effectsEntropy;
-      particle->position = (v2){
-          .x = RandomBetween(effectsEntropy, -5.0f, 5.0f),
-          .y = RandomBetween(effectsEntropy, -5.0f, 5.0f),
-      };
-      particle->velocity = (v2){0, 0};
-    }
-  }
+  // null backend would discard every command, recording them would be most of the measured step
+  if (renderer->backend == RENDER_BACKEND_NULL)
+    return;
 
   /*****************************************************************
    * RENDER
    *****************************************************************/
+  PROFILE_BEGIN(RenderRecording);
+  struct particle *firstParticle = state->particles + 0;
   ClearScreen(renderer, COLOR_ZINC_900);
 
 #if (0 && IS_BUILD_DEBUG)
@@ -317,7 +828,7 @@ GameUpdateAndRender(game_memory *memory, game_input *input, game_renderer *rende
 #endif
 
   // ground
-  DrawLine(renderer, (v2){-15, ground}, (v2){15, ground}, COLOR_GRAY_500, 1);
+  DrawLine(renderer, (v2){-15, GROUND}, (v2){15, GROUND}, COLOR_GRAY_500, 0.05f);
 
 #if 0
   // liquid
@@ -325,27 +836,43 @@ GameUpdateAndRender(game_memory *memory, game_input *input, game_renderer *rende
 #endif
 
   // mouse
-  DrawCrosshair(renderer, mousePosition, 0.5f, COLOR_RED_500);
+  DrawCrosshair(renderer, stepInput.mousePosition, 0.5f, COLOR_RED_500);
 
-  if (impulse)
-    DrawLine(renderer, firstParticle->position, mousePosition, COLOR_RED_300, 1);
+  if (state->isImpulseAiming)
+    DrawLine(renderer, ParticleGetPosition(firstParticle), stepInput.mousePosition, COLOR_RED_300, 0.03f);
 
   // spring
   v2 springAnchorPosition = state->springAnchorPosition;
   DrawLine(renderer, v2_add(springAnchorPosition, (v2){-1.0f, 0.0}), v2_add(springAnchorPosition, (v2){1.0f, 0.0f}),
-           COLOR_RED_500, 1);
-  DrawLine(renderer, springAnchorPosition, firstParticle->position, COLOR_RED_500, 1);
+           COLOR_RED_500, 0.05f);
+  DrawLine(renderer, springAnchorPosition, ParticleGetPosition(firstParticle), COLOR_RED_500, 0.03f);
 
   // particles
   for (u32 particleIndex = 0; particleIndex < state->particleCount; particleIndex++) {
     struct particle *particle = state->particles + particleIndex;
 
-    f32 massNormalized = particle->mass / 10.0f /* maximum particle mass */;
+    f32 mass = ParticleGetMass(particle);
+    f32 massNormalized = mass / 10.0f /* maximum particle mass */;
     u32 colorIndex = (u32)(Lerp(0.0f, ARRAY_COUNT(COLORS) / 11, massNormalized));
     const v4 *color = COLORS + colorIndex * 11 + 6;
 
-    DrawCircle(renderer, particle->position, 0.01f + particle->mass / 10.0f, *color);
+    DrawFilledCircle(renderer, ParticleGetPosition(particle), 0.01f + mass / 10.0f, *color);
+  }
+  PROFILE_END(RenderRecording);
+
+  /*****************************************************************
+   * HUD
+   *****************************************************************/
+  if (!transientState->isHudHidden) {
+    PROFILE_BEGIN(Hud);
+    u64 hudBeginCounter = SDL_GetPerformanceCounter();
+    HudDraw(memory, transientState, renderer);
+    transientState->hudTime =
+        (f32)(SDL_GetPerformanceCounter() - hudBeginCounter) / (f32)SDL_GetPerformanceFrequency();
+    PROFILE_END(Hud);
   }
 
+  PROFILE_BEGIN(RenderFrame);
   RenderFrame(renderer);
+  PROFILE_END(RenderFrame);
 }
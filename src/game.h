@@ -2,16 +2,16 @@
 
 #include "math.h"
 #include "memory.h"
-#include "type.h"
-
-#if IS_BUILD_DEBUG
 #include "string_builder.h"
-#endif
+#include "type.h"
 
+#include "logger.h"
 #include "physics.h"
 #include "platform.h"
+#include "profiler.h"
 #include "random.h"
 #include "renderer.h"
+#include "rewind.h"
 
 typedef struct {
   b8 isInitialized : 1;
@@ -26,13 +26,52 @@ typedef struct {
   rect liquid;
   v2 springAnchorPosition;
 
+  render_camera camera;
+
+  b8 isImpulseAiming : 1; // left button is held, impulse is applied on release
+
   f32 time; // unit: sec
 } game_state;
 
+/* What one simulation step reads, rewind replays these on top of a snapshot. */
+typedef struct {
+  f32 dt;            // unit: sec
+  v2 inputForce;     // sum of sticks, each is at most 1 long
+  v2 mousePosition;  // unit: m, in world
+  b8 isLeftButtonDown;
+#if IS_PHYSICS_FIXED_POINT
+  // same as above, built from raw sticks in fixed point, float ones are only drawn
+  v2q inputForceFixed;
+  v2q mousePositionFixed;
+#endif
+} game_step_input;
+
+#define HUD_FRAME_TIME_COUNT 120
+// rewind ring is sized to this many copies of world state, platform adds it to transient storage
+#define REWIND_STATE_COPY_COUNT 8
+// 10 seconds at 60Hz
+#define REWIND_FRAME_MAX 600
+// unit: frames, frames between snapshots are replayed from their step inputs
+#define REWIND_SNAPSHOT_INTERVAL 20
+
 typedef struct {
   b8 isInitialized : 1;
   memory_arena transientArena;
   string_builder *sb;
+
+  rewind_buffer rewind;                          // snapshot of every REWIND_SNAPSHOT_INTERVAL th frame
+  game_step_input rewindSteps[REWIND_FRAME_MAX]; // ring, input of every frame
+  u32 rewindStepIndex;                           // of newest frame
+  u32 rewindFramesSinceSnapshot;                 // newest frame is this many steps after newest snapshot
+  u32 rewindFramesAgo;                           // while scrubbing, 0 means newest frame
+
+  // performance overlay, back button toggles it, Tab on keyboard
+  b8 isHudHidden : 1;
+  b8 isHudTogglePressed : 1;
+  f32 frameTimes[HUD_FRAME_TIME_COUNT]; // unit: sec, ring of dt
+  u32 frameTimeIndex;                   // next to be written
+  f32 physicsTime;                      // unit: sec
+  f32 hudTime;                          // unit: sec, of recording overlay last frame
 } transient_state;
 
 typedef void (*pfnGameUpdateAndRender)(game_memory *memory, game_input *input, game_renderer *renderer);
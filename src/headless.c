@@ -0,0 +1,424 @@
+/*
+ * Runs game without window, as fast as possible.
+ * Used for bulk simulations and benchmarks on machines without display.
+ *
+ *   $ ./build/game_headless --steps=10000 --particles=100000
+ *   steps:                10000
+ *   particles:            100000
+ *   ...
+ */
+#include <time.h>   // clock_gettime()
+#include <unistd.h> // write()
+
+#include "compiler.h"
+#include "game.h"
+#include "type.h"
+
+#include "game.c"
+#include "input_recording.c"
+#include "logger.c"
+#include "permanent_storage.c"
+#include "profiler.c"
+#include "profiler_stats.c"
+#include "work_queue.c"
+
+typedef enum {
+  HEADLESS_ERROR_NONE = 0,
+  HEADLESS_ERROR_ARGUMENT,
+  HEADLESS_ERROR_MEMORY,
+  HEADLESS_ERROR_PLAYBACK,
+  HEADLESS_ERROR_STATE,
+  HEADLESS_ERROR_RECORD,
+  HEADLESS_ERROR_DIVERGED,
+  HEADLESS_ERROR_PROFILE,
+  HEADLESS_ERROR_HISTOGRAM,
+} headless_error;
+
+static u64
+NowInNanoseconds(void)
+{
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (u64)now.tv_sec * 1000000000ull + (u64)now.tv_nsec;
+}
+
+static b8
+ParseArgumentU64(struct string *arg, struct string *name, u64 *value)
+{
+  if (!IsStringStartsWith(arg, name))
+    return 0;
+
+  struct string valueString = {.value = arg->value + name->length, .length = arg->length - name->length};
+  return ParseU64(&valueString, value);
+}
+
+static void
+Usage(void)
+{
+  struct string *usage = &STRING_FROM_ZERO_TERMINATED(
+      "NAME\n"
+      "  game_headless [OPTIONS]\n"
+      "\n"
+      "DESCRIPTION\n"
+      "  Runs simulation without window at fixed time step, then reports\n"
+      "  throughput and hash of final state.\n"
+      "  Exits with 6 when playback diverges from recording.\n"
+      "\n"
+      "OPTIONS\n"
+      "  --steps=N\n"
+      "    Number of updates. Default is 10000.\n"
+      "\n"
+      "  --hz=N\n"
+      "    Updates per simulated second, ∆t is 1/N. Default is 60.\n"
+      "\n"
+      "  --particles=N\n"
+      "    Number of particles. Default is what game decides.\n"
+      "\n"
+      "  --renderer=null|software\n"
+      "    null skips drawing, so only simulation is measured. software records\n"
+      "    draw commands and rasterizes them into memory.\n"
+      "    Default is null.\n"
+      "\n"
+      "  --threads=N\n"
+      "    Worker threads of software renderer. Default is 0, only main thread.\n"
+      "\n"
+      "  --record=path\n"
+      "    Records inputs and state hash of every step. Another build plays it\n"
+      "    back with --playback to find first step where they differ.\n"
+      "\n"
+      "  --playback=path\n"
+      "    Feeds inputs and dt from recording made with --record=path, starting\n"
+      "    from its snapshot. Runs until recording ends or --steps. Reports\n"
+      "    first step and particles that differ from recording.\n"
+      "    --hz and --particles are ignored.\n"
+      "\n"
+      "  --loop\n"
+      "    Starts recording over when it ends, until --steps.\n"
+      "\n"
+      "  --state=path\n"
+      "    Starts from permanent storage saved by game or --save-state, instead\n"
+      "    of initializing. File is not changed. --particles is ignored.\n"
+      "\n"
+      "  --save-state=path\n"
+      "    Saves permanent storage to file when run ends.\n"
+      "\n"
+      "  --rewind\n"
+      "    Keeps rewind history like the game does, input of every step and\n"
+      "    a snapshot of world every 20th. Off by default, so throughput is\n"
+      "    of simulation and rendering only.\n"
+      "\n"
+      "  --repeat=N\n"
+      "    Runs N times, every run starts from same state. Fastest run is\n"
+      "    reported. Default is 1.\n"
+      "\n"
+      "  --profile=path\n"
+      "    Writes timed blocks of last steps as Chrome trace event JSON. Only\n"
+      "    in builds with profiler, see ./build.sh --enable-profiler.\n"
+      "\n"
+      "  --perf-counters\n"
+      "    Also records cycles, instructions, cache and branch misses of timed\n"
+      "    blocks with perf_event_open. When they are not permitted, only time\n"
+      "    is recorded. Only in builds with profiler.\n"
+      "\n"
+      "  --histogram=path\n"
+      "    Writes histogram buckets of step time and, in builds with profiler,\n"
+      "    of timed blocks as CSV. Percentiles are always reported.\n");
+  write(STDERR_FILENO, usage->value, usage->length);
+}
+
+int
+main(int argc, char *argv[])
+{
+  headless_error errorCode = HEADLESS_ERROR_NONE;
+
+  u64 stepCount = 10000;
+  u64 hz = 60;
+  u64 particleCount = 0;
+  u64 threadCount = 0;
+  render_backend backend = RENDER_BACKEND_NULL;
+  const char *recordPath = 0;
+  const char *playbackPath = 0;
+  b8 isLooping = 0;
+  const char *statePath = 0;
+  const char *saveStatePath = 0;
+  const char *profilePath = 0;
+  b8 isCounting = 0;
+  const char *histogramPath = 0;
+  u64 repeatCount = 1;
+  b8 isRewindEnabled = 0;
+
+  for (s32 argIndex = 1; argIndex < argc; argIndex++) {
+    struct string arg = StringFromZeroTerminated((u8 *)argv[argIndex], 1024);
+    if (ParseArgumentU64(&arg, &STRING_FROM_ZERO_TERMINATED("--steps="), &stepCount) ||
+        ParseArgumentU64(&arg, &STRING_FROM_ZERO_TERMINATED("--hz="), &hz) ||
+        ParseArgumentU64(&arg, &STRING_FROM_ZERO_TERMINATED("--particles="), &particleCount) ||
+        ParseArgumentU64(&arg, &STRING_FROM_ZERO_TERMINATED("--threads="), &threadCount) ||
+        ParseArgumentU64(&arg, &STRING_FROM_ZERO_TERMINATED("--repeat="), &repeatCount)) {
+      continue;
+    } else if (IsStringStartsWith(&arg, &STRING_FROM_ZERO_TERMINATED("--record="))) {
+      recordPath = argv[argIndex] + STRING_FROM_ZERO_TERMINATED("--record=").length;
+    } else if (IsStringStartsWith(&arg, &STRING_FROM_ZERO_TERMINATED("--playback="))) {
+      playbackPath = argv[argIndex] + STRING_FROM_ZERO_TERMINATED("--playback=").length;
+    } else if (IsStringEqual(&arg, &STRING_FROM_ZERO_TERMINATED("--loop"))) {
+      isLooping = 1;
+    } else if (IsStringStartsWith(&arg, &STRING_FROM_ZERO_TERMINATED("--state="))) {
+      statePath = argv[argIndex] + STRING_FROM_ZERO_TERMINATED("--state=").length;
+    } else if (IsStringStartsWith(&arg, &STRING_FROM_ZERO_TERMINATED("--profile="))) {
+      profilePath = argv[argIndex] + STRING_FROM_ZERO_TERMINATED("--profile=").length;
+    } else if (IsStringEqual(&arg, &STRING_FROM_ZERO_TERMINATED("--rewind"))) {
+      isRewindEnabled = 1;
+    } else if (IsStringEqual(&arg, &STRING_FROM_ZERO_TERMINATED("--perf-counters"))) {
+      isCounting = 1;
+    } else if (IsStringStartsWith(&arg, &STRING_FROM_ZERO_TERMINATED("--histogram="))) {
+      histogramPath = argv[argIndex] + STRING_FROM_ZERO_TERMINATED("--histogram=").length;
+    } else if (IsStringStartsWith(&arg, &STRING_FROM_ZERO_TERMINATED("--save-state="))) {
+      saveStatePath = argv[argIndex] + STRING_FROM_ZERO_TERMINATED("--save-state=").length;
+    } else if (IsStringEqual(&arg, &STRING_FROM_ZERO_TERMINATED("--renderer=null"))) {
+      backend = RENDER_BACKEND_NULL;
+    } else if (IsStringEqual(&arg, &STRING_FROM_ZERO_TERMINATED("--renderer=software"))) {
+      backend = RENDER_BACKEND_SOFTWARE;
+    } else {
+      Usage();
+      errorCode = HEADLESS_ERROR_ARGUMENT;
+      goto end;
+    }
+  }
+
+  if (hz == 0 || particleCount > U32_MAX || repeatCount == 0 || (statePath && saveStatePath) ||
+      (recordPath && (playbackPath || repeatCount > 1)) || ((profilePath || isCounting) && !IS_PROFILER_ENABLED)) {
+    Usage();
+    errorCode = HEADLESS_ERROR_ARGUMENT;
+    goto end;
+  }
+
+  // setup memory, same layout as platform
+  const u64 KILOBYTES = 1 << 10;
+  const u64 MEGABYTES = 1 << 20;
+  // saved state and recording already have permanent storage, size comes from the file
+  u64 PERMANANT_MEMORY_USAGE = 8 * MEGABYTES + particleCount * sizeof(particle);
+  if (playbackPath)
+    PERMANANT_MEMORY_USAGE = InputPlaybackPermanentStorageSize(playbackPath);
+  else if (statePath)
+    PERMANANT_MEMORY_USAGE = PermanentStorageFileSize(statePath);
+  if (playbackPath || statePath) {
+    if (PERMANANT_MEMORY_USAGE < sizeof(game_state)) {
+      errorCode = playbackPath ? HEADLESS_ERROR_PLAYBACK : HEADLESS_ERROR_STATE;
+      goto end;
+    }
+    // same count as the run that made the file, game only reads it when storage is not initialized
+    particleCount = (PERMANANT_MEMORY_USAGE - Minimum(PERMANANT_MEMORY_USAGE, 8 * MEGABYTES)) / sizeof(particle);
+  }
+  // rewind ring grows with particles, see REWIND_STATE_COPY_COUNT
+  const u64 TRANSIENT_MEMORY_USAGE =
+      32 * MEGABYTES + (isRewindEnabled ? REWIND_STATE_COPY_COUNT * particleCount * sizeof(particle) : 0);
+  // commands and scratch that renderer needs for every particle
+  const u64 RENDERER_MEMORY_USAGE = 8 * MEGABYTES + particleCount * 256;
+  const u64 STRING_BUILDER_MEMORY_USAGE = 1 * KILOBYTES;
+  const u64 PROFILER_MEMORY_USAGE = IS_PROFILER_ENABLED ? PROFILER_MEMORY_SIZE : 0;
+  const u64 PROFILER_STATS_MEMORY_USAGE = PROFILER_STATS_MEMORY_SIZE;
+  const u64 LOG_MEMORY_USAGE = LOG_MEMORY_SIZE;
+  const s32 windowWidth = 1280;
+  const s32 windowHeight = 720;
+  const u64 FRAMEBUFFER_MEMORY_USAGE =
+      backend == RENDER_BACKEND_SOFTWARE ? (u64)windowWidth * (u64)windowHeight * sizeof(u32) : 0;
+
+  memory_arena memory = {};
+  {
+    // permanent storage is mapped at fixed address, see PermanentStorageInit()
+    memory.total = TRANSIENT_MEMORY_USAGE + RENDERER_MEMORY_USAGE + STRING_BUILDER_MEMORY_USAGE +
+                   PROFILER_MEMORY_USAGE + PROFILER_STATS_MEMORY_USAGE + LOG_MEMORY_USAGE +
+                   FRAMEBUFFER_MEMORY_USAGE;
+    memory.block = SDL_malloc(memory.total);
+    if (memory.block == 0) {
+      errorCode = HEADLESS_ERROR_MEMORY;
+      goto end;
+    }
+  }
+
+  game_renderer renderer = {
+      .backend = backend,
+  };
+  {
+    renderer.memory = MemoryArenaSub(&memory, RENDERER_MEMORY_USAGE);
+    memset(renderer.memory.block, 0, renderer.memory.total);
+
+    renderer.screenCenter = (v2){(f32)windowWidth * 0.5f, (f32)windowHeight * 0.5f};
+
+    if (backend == RENDER_BACKEND_SOFTWARE) {
+      renderer.framebuffer = (render_framebuffer){
+          .pixels = MemoryArenaPush(&memory, FRAMEBUFFER_MEMORY_USAGE, 4),
+          .width = (u32)windowWidth,
+          .height = (u32)windowHeight,
+          .pitch = (u32)windowWidth,
+      };
+    }
+  }
+
+  platform_work_queue workQueue;
+  if (backend == RENDER_BACKEND_SOFTWARE && threadCount > 0 && WorkQueueInit(&workQueue, (u32)threadCount)) {
+    renderer.workQueue = &workQueue;
+    renderer.PlatformAddWorkEntry = WorkQueueAddEntry;
+    renderer.PlatformCompleteAllWork = WorkQueueCompleteAllWork;
+  }
+
+  string_builder sb = {};
+  {
+    memory_arena sbMemory = MemoryArenaSub(&memory, STRING_BUILDER_MEMORY_USAGE);
+    string *outBuffer = MemoryArenaPush(&sbMemory, sizeof(*outBuffer), 4);
+    *outBuffer = MemoryArenaPushString(&sbMemory, sbMemory.total - sbMemory.used);
+
+    sb.outBuffer = outBuffer;
+  }
+
+  permanent_storage permanentStorage;
+  game_memory gameMemory = {};
+  {
+    gameMemory.permanentStorageSize = PERMANANT_MEMORY_USAGE;
+    b8 isMapped;
+    if (statePath)
+      isMapped = PermanentStorageInit(&permanentStorage, statePath, PERMANANT_MEMORY_USAGE,
+                                      PERMANENT_STORAGE_OPEN_READONLY);
+    else
+      isMapped = PermanentStorageInit(&permanentStorage, saveStatePath, PERMANANT_MEMORY_USAGE,
+                                      PERMANENT_STORAGE_OPEN_NEW);
+    if (!isMapped) {
+      errorCode = statePath || saveStatePath ? HEADLESS_ERROR_STATE : HEADLESS_ERROR_MEMORY;
+      goto end;
+    }
+    gameMemory.permanentStorage = permanentStorage.block;
+
+    gameMemory.transientStorageSize = TRANSIENT_MEMORY_USAGE;
+    gameMemory.transientStorage = MemoryArenaPush(&memory, gameMemory.transientStorageSize, 4);
+    memset(gameMemory.transientStorage, 0, gameMemory.transientStorageSize);
+
+    transient_state *transientState = gameMemory.transientStorage;
+    transientState->sb = &sb;
+
+    gameMemory.particleCount = (u32)particleCount;
+    gameMemory.isRewindEnabled = isRewindEnabled;
+  }
+
+  profiler profiler;
+#if IS_PROFILER_ENABLED
+  ProfilerInit(&profiler, &memory);
+  if (isCounting && !ProfilerOpenCounters(&profiler)) {
+    struct string *message =
+        &STRING_FROM_ZERO_TERMINATED("hardware counters are not available, see perf_event_paranoid\n");
+    write(STDERR_FILENO, message->value, message->length);
+  }
+  gameMemory.profiler = &profiler;
+#endif
+  logger logger;
+  if (LoggerInit(&logger, &memory))
+    gameMemory.logger = &logger;
+
+  // step times of every run
+  profiler_stats profilerStats;
+  ProfilerStatsInit(&profilerStats, &memory);
+  debug_assert(memory.used <= memory.total);
+
+  // no one touches controllers, mouse stays at center of screen
+  game_input input = {
+      .dt = 1.0f / (f32)hz,
+  };
+
+  input_recorder recorder;
+  InputRecorderInit(&recorder);
+  if (playbackPath && !InputPlaybackBegin(&recorder, &gameMemory, playbackPath, isLooping)) {
+    errorCode = HEADLESS_ERROR_PLAYBACK;
+    goto end;
+  }
+  if (recordPath && !InputRecordingBegin(&recorder, &gameMemory, recordPath)) {
+    errorCode = HEADLESS_ERROR_RECORD;
+    goto end;
+  }
+
+  // every run starts from same state
+  if (repeatCount > 1 && !PermanentStorageSnapshot(&permanentStorage, 0, gameMemory.permanentStorageUsed)) {
+    errorCode = HEADLESS_ERROR_MEMORY;
+    goto end;
+  }
+
+  // run
+  u64 elapsedInNanoseconds = U64_MAX;
+  u64 step = 0;
+  for (u64 repeatIndex = 0; repeatIndex < repeatCount; repeatIndex++) {
+    if (repeatIndex > 0) {
+      PermanentStorageRestore(&permanentStorage, 0);
+      gameMemory.isStateReplaced = 1;
+      if (playbackPath)
+        InputPlaybackBegin(&recorder, &gameMemory, playbackPath, isLooping);
+    }
+
+    u64 startedAt = NowInNanoseconds();
+    for (step = 0; step < stepCount; step++) {
+      u64 stepStartedAt = NowInNanoseconds();
+      if (playbackPath && !InputPlaybackRead(&recorder, &gameMemory, &input))
+        break;
+      InputRecordingWrite(&recorder, &input);
+      // hash is compared while recording or playing back, and hash of final state is reported
+      gameMemory.isStateHashEnabled = recordPath || playbackPath || step + 1 == stepCount;
+      GameUpdateAndRender(&gameMemory, &input, &renderer);
+      InputRecordingWriteStateHash(&recorder, &gameMemory.stateHash);
+      InputPlaybackCheckStateHash(&recorder, &gameMemory.stateHash);
+      ProfilerStatsRecord(&profilerStats, NowInNanoseconds() - stepStartedAt, gameMemory.profiler);
+    }
+    u64 runElapsedInNanoseconds = NowInNanoseconds() - startedAt;
+    if (runElapsedInNanoseconds < elapsedInNanoseconds)
+      elapsedInNanoseconds = runElapsedInNanoseconds;
+  }
+  stepCount = step;
+  InputRecordingEnd(&recorder);
+  if (gameMemory.logger)
+    LoggerFlush(gameMemory.logger);
+
+  game_state *state = gameMemory.permanentStorage;
+  if (profilePath && !ProfilerWriteChromeTrace(&profiler, profilePath, state->particleCount)) {
+    errorCode = HEADLESS_ERROR_PROFILE;
+    goto end;
+  }
+
+  if (histogramPath && !ProfilerStatsWriteCsv(&profilerStats, gameMemory.profiler, histogramPath)) {
+    errorCode = HEADLESS_ERROR_HISTOGRAM;
+    goto end;
+  }
+
+  if (saveStatePath && !PermanentStorageSync(&permanentStorage)) {
+    errorCode = HEADLESS_ERROR_STATE;
+    goto end;
+  }
+
+  // report
+  f64 elapsedInSeconds = (f64)elapsedInNanoseconds * 1e-9;
+  u64 particleStepCount = stepCount * state->particleCount;
+
+  StringBuilderAppendString(&sb, &STRING_FROM_ZERO_TERMINATED("steps:                "));
+  StringBuilderAppendU64(&sb, stepCount);
+  StringBuilderAppendString(&sb, &STRING_FROM_ZERO_TERMINATED("\nruns:                 "));
+  StringBuilderAppendU64(&sb, repeatCount);
+  StringBuilderAppendString(&sb, &STRING_FROM_ZERO_TERMINATED("\nparticles:            "));
+  StringBuilderAppendU64(&sb, state->particleCount);
+  StringBuilderAppendString(&sb, &STRING_FROM_ZERO_TERMINATED("\nelapsed:              "));
+  StringBuilderAppendF32(&sb, (f32)elapsedInSeconds, 3);
+  StringBuilderAppendString(&sb, &STRING_FROM_ZERO_TERMINATED("s\nsteps/sec:            "));
+  StringBuilderAppendF32(&sb, elapsedInNanoseconds ? (f32)((f64)stepCount / elapsedInSeconds) : 0.0f, 1);
+  StringBuilderAppendString(&sb, &STRING_FROM_ZERO_TERMINATED("\nns per particle-step: "));
+  StringBuilderAppendF32(&sb, particleStepCount ? (f32)((f64)elapsedInNanoseconds / (f64)particleStepCount) : 0.0f,
+                         2);
+  StringBuilderAppendString(&sb, &STRING_FROM_ZERO_TERMINATED("\nhash:                 "));
+  StringBuilderAppendHex(&sb, gameMemory.stateHash.value);
+  if (playbackPath) {
+    StringBuilderAppendString(&sb, &STRING_FROM_ZERO_TERMINATED("\ndiverged:             "));
+    InputPlaybackAppendDivergence(&recorder, &sb);
+  }
+  StringBuilderAppendString(&sb, &STRING_FROM_ZERO_TERMINATED("\n"));
+  struct string report = StringBuilderFlush(&sb);
+  write(STDOUT_FILENO, report.value, report.length);
+  ProfilerStatsWriteSummary(&profilerStats, gameMemory.profiler, STDOUT_FILENO);
+
+  if (recorder.isDiverged)
+    errorCode = HEADLESS_ERROR_DIVERGED;
+
+end:
+  return (int)errorCode;
+}
@@ -0,0 +1,382 @@
+#include "physics.h"
+#include "platform.h"
+#include <fcntl.h>  // open()
+#include <stddef.h> // offsetof()
+#include <unistd.h> // read(), write(), lseek()
+
+/*
+ * Records inputs of every frame to a file, then plays them back.
+ * Same permanent storage and same inputs give same frames, so performance of
+ * different builds can be compared on exactly same sequence of frames.
+ * State hash of every frame is recorded too, playback reports first frame
+ * that differs from recording. Game only hashes when platform sets
+ * memory->isStateHashEnabled, so it must be set while either is on.
+ *
+ * File layout:
+ *   input_recording_header
+ *   permanent storage        used part, at the moment recording began
+ *   for every frame:
+ *     game_input             dt included
+ *     game_state_hash        without unused chunks, state after the frame
+ *
+ *   InputRecordingBegin(&recorder, memory, "game.rec");
+ *   for (;;) {
+ *     InputRecordingWrite(&recorder, input);
+ *     GameUpdateAndRender(memory, input, renderer);
+ *     InputRecordingWriteStateHash(&recorder, &memory->stateHash);
+ *   }
+ *
+ *   InputPlaybackBegin(&recorder, memory, "game.rec", isLooping);
+ *   while (InputPlaybackRead(&recorder, memory, &input)) {
+ *     GameUpdateAndRender(memory, &input, renderer);
+ *     InputPlaybackCheckStateHash(&recorder, &memory->stateHash);
+ *   }
+ */
+
+#define INPUT_RECORDING_MAGIC 0x43455247 // "GREC"
+#define INPUT_RECORDING_VERSION 3
+
+typedef struct {
+  u32 magic;
+  u32 version;
+  u64 permanentStorageAddress; // snapshot is only valid at same address
+  u64 permanentStorageSize;
+  u64 permanentStorageUsed; // size of snapshot after header
+  u64 inputSize;            // sizeof(game_input), changes when game_input changes
+  u32 physicsMode;          // IS_PHYSICS_FIXED_POINT, float and fixed point builds simulate different steps
+  u32 particleSize;         // sizeof(particle), changes when particle changes
+} input_recording_header;
+
+#define INPUT_RECORDING_STATE_HASH_HEADER_SIZE offsetof(game_state_hash, chunks)
+
+typedef struct {
+  s32 recordFile;   // -1 when not recording
+  s32 playbackFile; // -1 when not playing back
+  b8 isLooping : 1;
+  u64 frameCount;   // written or read since begin
+  u64 snapshotSize; // of permanent storage in playback file
+
+  // first frame where playback differs from recording, since playback began
+  b8 isDiverged : 1;
+  u64 divergedFrame;         // 1 is first frame of recording
+  u32 divergedParticleIndex; // first particle of chunk that differs, U32_MAX when only game state differs
+  u32 divergedParticleCount; // particles in that chunk
+} input_recorder;
+
+static void
+InputRecorderInit(input_recorder *recorder)
+{
+  *recorder = (input_recorder){
+      .recordFile = -1,
+      .playbackFile = -1,
+  };
+}
+
+static inline b8
+InputRecorderIsRecording(input_recorder *recorder)
+{
+  return recorder->recordFile >= 0;
+}
+
+static inline b8
+InputRecorderIsPlaying(input_recorder *recorder)
+{
+  return recorder->playbackFile >= 0;
+}
+
+/* @return 1 when every byte is transferred */
+static b8
+FileWriteAll(s32 fd, void *src, u64 size)
+{
+  u8 *bytes = src;
+  while (size > 0) {
+    ssize_t written = write(fd, bytes, size);
+    if (written <= 0)
+      return 0;
+    bytes += written;
+    size -= (u64)written;
+  }
+  return 1;
+}
+
+/* @return 1 when every byte is transferred */
+static b8
+FileReadAll(s32 fd, void *dest, u64 size)
+{
+  u8 *bytes = dest;
+  while (size > 0) {
+    ssize_t readCount = read(fd, bytes, size);
+    if (readCount <= 0)
+      return 0;
+    bytes += readCount;
+    size -= (u64)readCount;
+  }
+  return 1;
+}
+
+static void
+InputRecordingEnd(input_recorder *recorder)
+{
+  if (!InputRecorderIsRecording(recorder))
+    return;
+
+  close(recorder->recordFile);
+  recorder->recordFile = -1;
+}
+
+/*
+ * Snapshots permanent storage, then every InputRecordingWrite() appends one
+ * frame.
+ * @return 0 when file cannot be created
+ */
+static b8
+InputRecordingBegin(input_recorder *recorder, game_memory *memory, const char *path)
+{
+  InputRecordingEnd(recorder);
+
+  s32 fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0)
+    return 0;
+
+  // before first frame game has not written used yet, storage is zero past what was loaded into it
+  u64 used = memory->permanentStorageUsed;
+  if (used == 0) {
+    u64 *words = memory->permanentStorage;
+    u64 wordCount = memory->permanentStorageSize / sizeof(*words);
+    while (wordCount > 0 && words[wordCount - 1] == 0)
+      wordCount--;
+    used = wordCount * sizeof(*words);
+  }
+  input_recording_header header = {
+      .magic = INPUT_RECORDING_MAGIC,
+      .version = INPUT_RECORDING_VERSION,
+      .permanentStorageAddress = (u64)memory->permanentStorage,
+      .permanentStorageSize = memory->permanentStorageSize,
+      .permanentStorageUsed = used,
+      .inputSize = sizeof(game_input),
+      .physicsMode = IS_PHYSICS_FIXED_POINT,
+      .particleSize = sizeof(particle),
+  };
+  if (!FileWriteAll(fd, &header, sizeof(header)) || !FileWriteAll(fd, memory->permanentStorage, used)) {
+    close(fd);
+    return 0;
+  }
+
+  recorder->recordFile = fd;
+  recorder->frameCount = 0;
+  memory->isStateReplaced = 1;
+  return 1;
+}
+
+static void
+InputRecordingWrite(input_recorder *recorder, game_input *input)
+{
+  if (!InputRecorderIsRecording(recorder))
+    return;
+
+  if (!FileWriteAll(recorder->recordFile, input, sizeof(*input))) {
+    // disk is full, keep what is already written
+    InputRecordingEnd(recorder);
+    return;
+  }
+  recorder->frameCount++;
+}
+
+/* Appends state after the frame that InputRecordingWrite() wrote input of. */
+static void
+InputRecordingWriteStateHash(input_recorder *recorder, game_state_hash *hash)
+{
+  if (!InputRecorderIsRecording(recorder))
+    return;
+
+  debug_assert(hash->chunkCount <= GAME_STATE_HASH_CHUNK_MAX);
+  if (!FileWriteAll(recorder->recordFile, hash, INPUT_RECORDING_STATE_HASH_HEADER_SIZE) ||
+      !FileWriteAll(recorder->recordFile, hash->chunks, sizeof(*hash->chunks) * hash->chunkCount))
+    InputRecordingEnd(recorder);
+}
+
+static void
+InputPlaybackEnd(input_recorder *recorder)
+{
+  if (!InputRecorderIsPlaying(recorder))
+    return;
+
+  close(recorder->playbackFile);
+  recorder->playbackFile = -1;
+}
+
+/*
+ * Loads snapshot into permanent storage, next read is first frame.
+ * Snapshot is followed by zeros, only state that was in use is cleared.
+ */
+static b8
+InputPlaybackRewind(input_recorder *recorder, game_memory *memory)
+{
+  s32 fd = recorder->playbackFile;
+  if (lseek(fd, (off_t)sizeof(input_recording_header), SEEK_SET) < 0 ||
+      !FileReadAll(fd, memory->permanentStorage, recorder->snapshotSize))
+    return 0;
+
+  // used is 0 when no frame ran, storage may hold anything that was loaded into it
+  u64 used = memory->permanentStorageUsed ? memory->permanentStorageUsed : memory->permanentStorageSize;
+  if (used > recorder->snapshotSize)
+    bzero((u8 *)memory->permanentStorage + recorder->snapshotSize, used - recorder->snapshotSize);
+  memory->permanentStorageUsed = recorder->snapshotSize;
+
+  recorder->frameCount = 0;
+  memory->isStateReplaced = 1;
+  return 1;
+}
+
+/*
+ * Restores permanent storage from the recording. Recording must be made by
+ * a build with same game_input, same physics mode and particle, and same
+ * permanent storage address and size.
+ * @return 0 when file cannot be played back
+ */
+static b8
+InputPlaybackBegin(input_recorder *recorder, game_memory *memory, const char *path, b8 isLooping)
+{
+  InputPlaybackEnd(recorder);
+
+  s32 fd = open(path, O_RDONLY);
+  if (fd < 0)
+    return 0;
+
+  input_recording_header header;
+  if (!FileReadAll(fd, &header, sizeof(header)) || header.magic != INPUT_RECORDING_MAGIC ||
+      header.version != INPUT_RECORDING_VERSION || header.inputSize != sizeof(game_input) ||
+      header.physicsMode != IS_PHYSICS_FIXED_POINT || header.particleSize != sizeof(particle) ||
+      header.permanentStorageAddress != (u64)memory->permanentStorage ||
+      header.permanentStorageSize != memory->permanentStorageSize ||
+      header.permanentStorageUsed > memory->permanentStorageSize) {
+    close(fd);
+    return 0;
+  }
+
+  recorder->playbackFile = fd;
+  recorder->snapshotSize = header.permanentStorageUsed;
+  recorder->isLooping = isLooping;
+  recorder->isDiverged = 0;
+  if (!InputPlaybackRewind(recorder, memory)) {
+    InputPlaybackEnd(recorder);
+    return 0;
+  }
+
+  return 1;
+}
+
+/*
+ * Reads input of next frame.
+ * At end of recording either starts over from snapshot when looping, or ends
+ * playback.
+ * @return 0 when playback is ended
+ */
+static b8
+InputPlaybackRead(input_recorder *recorder, game_memory *memory, game_input *input)
+{
+  if (!InputRecorderIsPlaying(recorder))
+    return 0;
+
+  if (!FileReadAll(recorder->playbackFile, input, sizeof(*input))) {
+    // recording with no frames would loop forever
+    if (!recorder->isLooping || recorder->frameCount == 0 || !InputPlaybackRewind(recorder, memory) ||
+        !FileReadAll(recorder->playbackFile, input, sizeof(*input))) {
+      InputPlaybackEnd(recorder);
+      return 0;
+    }
+  }
+
+  recorder->frameCount++;
+  return 1;
+}
+
+/*
+ * Compares state after frame that InputPlaybackRead() read input of with
+ * recorded one. Only first divergence is kept, frames after it differ
+ * because of it.
+ * @return 0 when state differs from recording
+ */
+static b8
+InputPlaybackCheckStateHash(input_recorder *recorder, game_state_hash *hash)
+{
+  if (!InputRecorderIsPlaying(recorder))
+    return 1;
+
+  game_state_hash recorded;
+  if (!FileReadAll(recorder->playbackFile, &recorded, INPUT_RECORDING_STATE_HASH_HEADER_SIZE) ||
+      recorded.chunkCount > GAME_STATE_HASH_CHUNK_MAX ||
+      !FileReadAll(recorder->playbackFile, recorded.chunks, sizeof(*recorded.chunks) * recorded.chunkCount)) {
+    InputPlaybackEnd(recorder);
+    return 1;
+  }
+
+  if (recorded.value == hash->value && recorded.particleCount == hash->particleCount)
+    return 1;
+
+  if (!recorder->isDiverged) {
+    recorder->isDiverged = 1;
+    recorder->divergedFrame = recorder->frameCount;
+    recorder->divergedParticleIndex = U32_MAX;
+    recorder->divergedParticleCount = 0;
+
+    if (recorded.particlesPerChunk == hash->particlesPerChunk) {
+      u32 chunkCount = Minimum(recorded.chunkCount, hash->chunkCount);
+      for (u32 chunkIndex = 0; chunkIndex < chunkCount; chunkIndex++) {
+        if (recorded.chunks[chunkIndex] != hash->chunks[chunkIndex]) {
+          recorder->divergedParticleIndex = chunkIndex * hash->particlesPerChunk;
+          recorder->divergedParticleCount =
+              Minimum(hash->particlesPerChunk, hash->particleCount - recorder->divergedParticleIndex);
+          break;
+        }
+      }
+    }
+    if (recorder->divergedParticleIndex == U32_MAX && recorded.particleCount != hash->particleCount) {
+      // particles were added or removed, chunks are cut differently
+      recorder->divergedParticleIndex = Minimum(recorded.particleCount, hash->particleCount);
+      recorder->divergedParticleCount = 0;
+    }
+  }
+
+  return 0;
+}
+
+/* Appends "no", "frame 12, game state" or "frame 12, particles [0, 4)". */
+static void
+InputPlaybackAppendDivergence(input_recorder *recorder, string_builder *sb)
+{
+  if (!recorder->isDiverged) {
+    StringBuilderAppendString(sb, &STRING_FROM_ZERO_TERMINATED("no"));
+    return;
+  }
+
+  StringBuilderAppendString(sb, &STRING_FROM_ZERO_TERMINATED("frame "));
+  StringBuilderAppendU64(sb, recorder->divergedFrame);
+  if (recorder->divergedParticleIndex == U32_MAX) {
+    StringBuilderAppendString(sb, &STRING_FROM_ZERO_TERMINATED(", game state"));
+  } else {
+    StringBuilderAppendString(sb, &STRING_FROM_ZERO_TERMINATED(", particles ["));
+    StringBuilderAppendU64(sb, recorder->divergedParticleIndex);
+    StringBuilderAppendString(sb, &STRING_FROM_ZERO_TERMINATED(", "));
+    StringBuilderAppendU64(sb, (u64)recorder->divergedParticleIndex + recorder->divergedParticleCount);
+    StringBuilderAppendString(sb, &STRING_FROM_ZERO_TERMINATED(")"));
+  }
+}
+
+/*
+ * Reads size of permanent storage the recording is made with.
+ * @return 0 when file is not a recording
+ */
+static u64
+InputPlaybackPermanentStorageSize(const char *path)
+{
+  s32 fd = open(path, O_RDONLY);
+  if (fd < 0)
+    return 0;
+
+  input_recording_header header;
+  b8 isValid = FileReadAll(fd, &header, sizeof(header)) && header.magic == INPUT_RECORDING_MAGIC &&
+               header.version == INPUT_RECORDING_VERSION;
+  close(fd);
+  return isValid ? header.permanentStorageSize : 0;
+}
@@ -0,0 +1,130 @@
+#include "logger.h"
+#include <sys/uio.h> // writev()
+
+/*
+ * Platform side of logger: owns ring and consumer thread that writes
+ * records in order they were claimed.
+ *
+ *   LoggerInit(&logger, &arena);
+ *   memory->logger = &logger;
+ *   ...
+ *   LoggerFlush(&logger); // before exit
+ */
+
+#define LOG_BATCH_MAX 64        // records per writev()
+#define LOG_WAKE_UP_INTERVAL 10 // unit: ms
+#define LOG_FLUSH_TIMEOUT 1000  // unit: ms
+
+/*
+ * Writes every ready record, consecutive records of same file are written
+ * with one writev().
+ * @return 1 when there were records
+ */
+static b8
+LoggerWriteRecords(logger *logger)
+{
+  b8 isWritten = 0;
+  for (;;) {
+    struct iovec iov[LOG_BATCH_MAX];
+    u32 iovCount = 0;
+    s32 fd = -1;
+    u32 readIndex = logger->readIndex;
+    while (iovCount < LOG_BATCH_MAX) {
+      log_record *record = logger->records + ((readIndex + iovCount) & (LOG_RECORD_COUNT - 1));
+      if (SDL_GetAtomicInt(&record->sequence) != (s32)(readIndex + iovCount + 1))
+        break;
+      SDL_MemoryBarrierAcquire();
+      if (iovCount > 0 && record->fd != fd)
+        break;
+      fd = record->fd;
+      iov[iovCount++] = (struct iovec){.iov_base = record->message, .iov_len = record->length};
+    }
+    if (iovCount == 0)
+      break;
+
+    // short writes are not retried, terminal logs are best effort
+    writev(fd, iov, (s32)iovCount);
+
+    // frees slots for producers of next lap
+    for (u32 iovIndex = 0; iovIndex < iovCount; iovIndex++) {
+      log_record *record = logger->records + ((readIndex + iovIndex) & (LOG_RECORD_COUNT - 1));
+      SDL_SetAtomicInt(&record->sequence, (s32)(readIndex + iovIndex + LOG_RECORD_COUNT));
+    }
+    logger->readIndex = readIndex + iovCount;
+    isWritten = 1;
+  }
+
+  s32 droppedCount = SDL_SetAtomicInt(&logger->droppedCount, 0);
+  if (droppedCount > 0) {
+    u8 outBufferBytes[64];
+    string_builder sb = {
+        .outBuffer = &(struct string){.value = outBufferBytes, .length = sizeof(outBufferBytes)},
+    };
+    StringBuilderAppendString(&sb, &STRING_FROM_ZERO_TERMINATED("log dropped "));
+    StringBuilderAppendU64(&sb, (u64)droppedCount);
+    StringBuilderAppendString(&sb, &STRING_FROM_ZERO_TERMINATED(" messages\n"));
+    struct string message = StringBuilderFlush(&sb);
+    write(STDERR_FILENO, message.value, message.length);
+  }
+  return isWritten;
+}
+
+static s32
+LoggerThreadProc(void *data)
+{
+  logger *logger = data;
+  for (;;) {
+    LoggerWriteRecords(logger);
+    SDL_WaitSemaphoreTimeout(logger->semaphore, LOG_WAKE_UP_INTERVAL);
+  }
+  return 0;
+}
+
+/*
+ * Starts consumer thread that lives until process exits.
+ * @return 0 when thread could not be created, then messages are written at
+ *         once by caller of LogEnd(), do not set logger to game memory
+ */
+static b8
+LoggerInit(logger *logger, memory_arena *arena)
+{
+  *logger = (struct logger){
+      .records = MemoryArenaPush(arena, LOG_MEMORY_SIZE, 8),
+  };
+  for (u32 recordIndex = 0; recordIndex < LOG_RECORD_COUNT; recordIndex++)
+    SDL_SetAtomicInt(&logger->records[recordIndex].sequence, (s32)recordIndex);
+
+  logger->semaphore = SDL_CreateSemaphore(0);
+  if (!logger->semaphore)
+    return 0;
+
+  SDL_Thread *thread = SDL_CreateThread(LoggerThreadProc, "logger", logger);
+  if (!thread)
+    return 0;
+  SDL_DetachThread(thread);
+
+  globalLogger = logger;
+  return 1;
+}
+
+/*
+ * Waits until consumer wrote every message pushed before the call, at most
+ * LOG_FLUSH_TIMEOUT. Messages pushed during the call may be left.
+ * Consumer writes in order, so a producer that claimed a slot but never
+ * published it, e.g. its thread is stopped in a debugger or killed between
+ * the two, holds back every message after it. Then the rest is given up.
+ * @return 0 when messages were left after timeout
+ */
+static b8
+LoggerFlush(logger *logger)
+{
+  u32 writeIndex = (u32)SDL_GetAtomicInt(&logger->writeIndex);
+  // consumer owns readIndex, only wait for it
+  for (u32 waited = 0; (s32)(writeIndex - *(volatile u32 *)&logger->readIndex) > 0; waited++) {
+    if (waited == LOG_FLUSH_TIMEOUT)
+      return 0;
+    SDL_SignalSemaphore(logger->semaphore);
+    SDL_Delay(1);
+  }
+  return 1;
+}
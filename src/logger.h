@@ -0,0 +1,114 @@
+#pragma once
+
+#include "compiler.h"
+#include "platform.h"
+#include "string_builder.h"
+#include "type.h"
+#include <SDL3/SDL.h>
+#include <unistd.h> // write()
+
+/*
+ * Logger
+ *   Any thread formats a message into its own string builder, then pushes it
+ *   as one record into a lock-free ring with many producers and one consumer.
+ *   Platform thread writes ready records in batches with writev(), so threads
+ *   that log never wait for terminal.
+ *
+ *   string_builder *sb = LogBegin();
+ *   StringBuilderAppendString(sb, &STRING_FROM_ZERO_TERMINATED("impulse: "));
+ *   StringBuilderAppendF32(sb, impulse.x, 2);
+ *   LogEnd(sb, STDOUT_FILENO);
+ *
+ * When ring is full message is dropped and counted, caller never waits.
+ * Without logger, e.g. in tests, message is written at once.
+ *
+ * Game and platform are different libraries in debug builds, every library
+ * sets globalLogger from game_memory.
+ */
+
+#define LOG_MESSAGE_MAX 512   // unit: bytes, buffer of string builder
+#define LOG_RECORD_COUNT 1024 // must be power of 2
+#define LOG_MEMORY_SIZE (sizeof(log_record) * LOG_RECORD_COUNT)
+
+typedef struct {
+  // position in ring this slot is ready for:
+  //   position              free for producer that claims position
+  //   position + 1          written, ready for consumer
+  SDL_AtomicInt sequence;
+  s32 fd;
+  u32 length;
+  u8 message[LOG_MESSAGE_MAX];
+} log_record;
+
+struct logger {
+  log_record *records;        // LOG_RECORD_COUNT
+  SDL_AtomicInt writeIndex;   // next position producers claim
+  u32 readIndex;              // only consumer reads and writes it
+  SDL_AtomicInt droppedCount; // messages lost because ring was full
+  SDL_Semaphore *semaphore;   // wakes consumer before ring fills up
+};
+
+static logger *globalLogger;
+
+// every thread formats into its own builder, set up with first LogBegin()
+static __thread u8 globalLogMessage[LOG_MESSAGE_MAX];
+static __thread struct string globalLogOutBuffer;
+static __thread string_builder globalLogStringBuilder;
+
+/* @return string builder of calling thread, message must fit in LOG_MESSAGE_MAX */
+static inline string_builder *
+LogBegin(void)
+{
+  string_builder *sb = &globalLogStringBuilder;
+  if (unlikely(!sb->outBuffer)) {
+    globalLogOutBuffer = (struct string){.value = globalLogMessage, .length = sizeof(globalLogMessage)};
+    sb->outBuffer = &globalLogOutBuffer;
+  }
+  sb->length = 0;
+  return sb;
+}
+
+/* Pushes message in string builder to be written to fd. */
+static void
+LogEnd(string_builder *sb, s32 fd)
+{
+  struct string message = StringBuilderFlush(sb);
+  logger *logger = globalLogger;
+  if (unlikely(!logger)) {
+    write(fd, message.value, message.length);
+    return;
+  }
+
+  // claim a position whose slot consumer has already freed
+  log_record *record;
+  s32 position = SDL_GetAtomicInt(&logger->writeIndex);
+  for (;;) {
+    record = logger->records + ((u32)position & (LOG_RECORD_COUNT - 1));
+    s32 sequence = SDL_GetAtomicInt(&record->sequence);
+    s32 difference = (s32)((u32)sequence - (u32)position);
+    if (difference == 0) {
+      if (SDL_CompareAndSwapAtomicInt(&logger->writeIndex, position, (s32)((u32)position + 1)))
+        break;
+      position = SDL_GetAtomicInt(&logger->writeIndex);
+    } else if (difference < 0) {
+      // slot still holds message from one lap ago
+      SDL_AddAtomicInt(&logger->droppedCount, 1);
+      SDL_SignalSemaphore(logger->semaphore);
+      return;
+    } else {
+      // other producer claimed it
+      position = SDL_GetAtomicInt(&logger->writeIndex);
+    }
+  }
+
+  memcpy(record->message, message.value, message.length);
+  record->length = (u32)message.length;
+  record->fd = fd;
+  // message must be visible before consumer sees it is ready
+  SDL_MemoryBarrierRelease();
+  SDL_SetAtomicInt(&record->sequence, (s32)((u32)position + 1));
+
+  // consumer wakes up by itself every few milliseconds, only hurry it when ring fills up
+  if (((u32)position & (LOG_RECORD_COUNT / 4 - 1)) == 0)
+    SDL_SignalSemaphore(logger->semaphore);
+}
@@ -1,4 +1,11 @@
-#include <unistd.h> // write()
+#include <errno.h>  // errno
+#include <fcntl.h>  // open()
+#include <stdio.h>  // rename()
+#include <unistd.h> // write(), read(), close()
+
+#if IS_BUILD_DEBUG
+#include <sys/inotify.h>
+#endif
 
 #include "compiler.h"
 #include "game.h"
@@ -13,9 +20,24 @@
 #include <SDL3/SDL_loadso.h>
 #include <SDL3/SDL_main.h>
 
+#include "input_recording.c"
+#include "logger.c"
+#include "permanent_storage.c"
+#include "profiler.c"
+#include "profiler_stats.c"
+#include "work_queue.c"
+
+#define GAME_LIBRARY_PATH_MAX 1024
+
 typedef struct {
-  u64 loadedAt;
   SDL_SharedObject *handle;
+  // watcher thread sets it after game.so is completely written
+  SDL_AtomicInt isChanged;
+  s32 watchFd;
+
+  char path[GAME_LIBRARY_PATH_MAX];       // written by compiler
+  char loadedPath[GAME_LIBRARY_PATH_MAX]; // private copy that is loaded
+  char copyPath[GAME_LIBRARY_PATH_MAX];   // copy is written here, then renamed
 
   pfnGameUpdateAndRender GameUpdateAndRender;
 } game_library;
@@ -28,6 +50,16 @@ typedef struct {
   game_input inputs[2];
   u32 inputIndex : 1;
   game_renderer renderer;
+  SDL_Texture *framebufferTexture; // presents software renderer output
+  platform_work_queue workQueue;
+  permanent_storage permanentStorage;
+  input_recorder recorder;
+  const char *recordingPath;
+  game_input playbackInput;
+  profiler profiler;
+  profiler_stats profilerStats;
+  logger logger;
+  const char *histogramPath; // 0 when histogram is not written
   u64 lastTime;
   string_builder sb;
 #if IS_BUILD_DEBUG
@@ -38,46 +70,151 @@ typedef struct {
 
 #if IS_BUILD_DEBUG
 
-static void
-GameLibraryReload(game_library *lib, sdl_state *state)
+/*
+ * Hot reload
+ *   Watcher thread blocks on inotify of executable directory, and flags the
+ *   library as changed when game.so is closed after writing or moved in.
+ *   Main loop reloads only then, so it never stats the file every frame and
+ *   never loads a half written library.
+ *   Library is loaded from a private copy, so compiler never writes into a
+ *   file that is mapped.
+ */
+
+static s32
+GameLibraryWatchProc(void *data)
+{
+  game_library *lib = data;
+  // events are variable length, name follows every event
+  u8 buffer[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+  for (;;) {
+    ssize_t readSize = read(lib->watchFd, buffer, sizeof(buffer));
+    if (readSize < 0 && errno == EINTR)
+      continue;
+    if (readSize <= 0)
+      break;
+
+    for (u8 *cursor = buffer; cursor < buffer + readSize;) {
+      struct inotify_event *event = (struct inotify_event *)cursor;
+      if (event->len > 0 && strcmp(event->name, "game.so") == 0)
+        SDL_SetAtomicInt(&lib->isChanged, 1);
+      cursor += sizeof(*event) + event->len;
+    }
+  }
+  return 0;
+}
+
+/* @return 0 when path does not fit */
+static b8
+GameLibraryMakePath(string_builder *sb, string *directory, const char *name, char *path)
+{
+  StringBuilderAppendString(sb, directory);
+  StringBuilderAppendString(sb, &STRING_FROM_ZERO_TERMINATED("/")); // seperator
+  StringBuilderAppendZeroTerminated(sb, name, GAME_LIBRARY_PATH_MAX);
+  string result = StringBuilderFlushZeroTerminated(sb);
+  if (result.length + 1 > GAME_LIBRARY_PATH_MAX)
+    return 0;
+  memcpy(path, result.value, result.length + 1);
+  return 1;
+}
+
+/*
+ * Starts watching library next to executable, library is loaded with first
+ * GameLibraryReload().
+ * @return 0 when paths do not fit, without watcher library is only loaded once
+ */
+static b8
+GameLibraryInit(game_library *lib, sdl_state *state)
 {
   // create absolute path, instead of relative
   string_builder *sb = &state->sb;
   string pwd = PathGetDirectory(&state->executablePath);
   debug_assert(pwd.length > 0);
+  if (!GameLibraryMakePath(sb, &pwd, "game.so", lib->path) ||
+      !GameLibraryMakePath(sb, &pwd, "game_loaded.so", lib->loadedPath) ||
+      !GameLibraryMakePath(sb, &pwd, "game_loaded.so.tmp", lib->copyPath))
+    return 0;
+
+  SDL_SetAtomicInt(&lib->isChanged, 1);
+  lib->watchFd = inotify_init1(IN_CLOEXEC);
   StringBuilderAppendString(sb, &pwd);
-  StringBuilderAppendString(sb, &STRING_FROM_ZERO_TERMINATED("/")); // seperator
-  StringBuilderAppendString(sb, &STRING_FROM_ZERO_TERMINATED("game.so"));
-  string libPath = StringBuilderFlushZeroTerminated(sb);
+  string directory = StringBuilderFlushZeroTerminated(sb);
+  if (lib->watchFd < 0 ||
+      inotify_add_watch(lib->watchFd, (const char *)directory.value, IN_CLOSE_WRITE | IN_MOVED_TO) < 0) {
+    string *message = &STRING_FROM_ZERO_TERMINATED("Cannot watch game library, hot reload is off\n");
+    write(STDERR_FILENO, message->value, message->length);
+    return 1;
+  }
+
+  SDL_Thread *thread = SDL_CreateThread(GameLibraryWatchProc, "library watcher", lib);
+  if (thread)
+    SDL_DetachThread(thread);
+  return 1;
+}
+
+/* @return 0 when library cannot be copied */
+static b8
+GameLibraryCopy(game_library *lib)
+{
+  s32 srcFd = open(lib->path, O_RDONLY | O_CLOEXEC);
+  if (srcFd < 0)
+    return 0;
+  s32 destFd = open(lib->copyPath, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0755);
+  if (destFd < 0) {
+    close(srcFd);
+    return 0;
+  }
+
+  b8 isCopied = 1;
+  u8 buffer[64 * 1024];
+  for (;;) {
+    ssize_t readSize = read(srcFd, buffer, sizeof(buffer));
+    if (readSize < 0 && errno == EINTR)
+      continue;
+    if (readSize <= 0) {
+      isCopied = readSize == 0;
+      break;
+    }
+    if (!FileWriteAll(destFd, buffer, (u64)readSize)) {
+      isCopied = 0;
+      break;
+    }
+  }
+  close(srcFd);
+  close(destFd);
+  return isCopied;
+}
 
-  // get create time
-  SDL_PathInfo libPathInfo;
-  b8 isFileExists = SDL_GetPathInfo((const char *)libPath.value, &libPathInfo);
-  if (!isFileExists)
+static void
+GameLibraryReload(game_library *lib, sdl_state *state)
+{
+  if (!SDL_CompareAndSwapAtomicInt(&lib->isChanged, 1, 0))
     return;
 
-  u64 libCreatedAt = (u64)libPathInfo.create_time;
-  if (lib->loadedAt == libCreatedAt)
+  // old library keeps running when new one cannot be copied
+  if (!GameLibraryCopy(lib)) {
+    debug_assert(lib->handle && "cannot copy library");
     return;
+  }
 
   // close already open library
   if (lib->handle) {
     SDL_UnloadObject(lib->handle);
     lib->handle = 0;
+    // names of timed blocks point into unloaded library
+    ProfilerClear(&state->profiler);
   }
 
-  lib->handle = SDL_LoadObject((const char *)libPath.value);
+  // new file, even if old one is still mapped somewhere it stays untouched
+  rename(lib->copyPath, lib->loadedPath);
+  lib->handle = SDL_LoadObject(lib->loadedPath);
   debug_assert(lib->handle && "cannot load library");
 
   lib->GameUpdateAndRender = (pfnGameUpdateAndRender)SDL_LoadFunction(lib->handle, "GameUpdateAndRender");
   debug_assert(lib->GameUpdateAndRender && "library malformed");
 
-  {
-    string *message = &STRING_FROM_ZERO_TERMINATED("Reloaded library!\n");
-    write(STDOUT_FILENO, message->value, message->length);
-  }
-
-  lib->loadedAt = libCreatedAt;
+  string_builder *sb = LogBegin();
+  StringBuilderAppendString(sb, &STRING_FROM_ZERO_TERMINATED("Reloaded library!\n"));
+  LogEnd(sb, STDOUT_FILENO);
 }
 
 #endif
@@ -90,6 +227,8 @@ SDL_AppIterate(void *appstate)
   u64 nowInNanoseconds = SDL_GetTicksNS();
   debug_assert(nowInNanoseconds > 0);
   u64 elapsedInNanoseconds = nowInNanoseconds - state->lastTime;
+  // blocks of last frame, before library reload drops them
+  ProfilerStatsRecord(&state->profilerStats, elapsedInNanoseconds, state->memory.profiler);
 #if IS_BUILD_DEBUG
   // Prevent ∆t to be valid when debugging
   if (elapsedInNanoseconds > 17000000 /* 17ms */)
@@ -106,7 +245,39 @@ SDL_AppIterate(void *appstate)
   GameLibraryReload(&state->lib, state);
   pfnGameUpdateAndRender GameUpdateAndRender = state->lib.GameUpdateAndRender;
 #endif
-  GameUpdateAndRender(memory, newInput, renderer);
+
+  PROFILE_BEGIN(InputRecording);
+  game_input *input = newInput;
+  InputRecordingWrite(&state->recorder, newInput);
+  if (InputPlaybackRead(&state->recorder, memory, &state->playbackInput))
+    input = &state->playbackInput;
+  // hash is only read while recording or playing back
+  memory->isStateHashEnabled =
+      InputRecorderIsRecording(&state->recorder) || InputRecorderIsPlaying(&state->recorder);
+  PROFILE_END(InputRecording);
+
+  PROFILE_BEGIN(GameUpdateAndRender);
+  GameUpdateAndRender(memory, input, renderer);
+  PROFILE_END(GameUpdateAndRender);
+
+  InputRecordingWriteStateHash(&state->recorder, &memory->stateHash);
+  b8 isDiverged = state->recorder.isDiverged;
+  if (!InputPlaybackCheckStateHash(&state->recorder, &memory->stateHash) && !isDiverged) {
+    string_builder *sb = LogBegin();
+    StringBuilderAppendString(sb, &STRING_FROM_ZERO_TERMINATED("playback diverged: "));
+    InputPlaybackAppendDivergence(&state->recorder, sb);
+    StringBuilderAppendString(sb, &STRING_FROM_ZERO_TERMINATED("\n"));
+    LogEnd(sb, STDERR_FILENO);
+  }
+
+  if (renderer->backend == RENDER_BACKEND_SOFTWARE) {
+    PROFILE_BEGIN(Present);
+    render_framebuffer *framebuffer = &renderer->framebuffer;
+    SDL_UpdateTexture(state->framebufferTexture, 0, framebuffer->pixels, (s32)(framebuffer->pitch * sizeof(u32)));
+    SDL_RenderTexture(renderer->renderer, state->framebufferTexture, 0, 0);
+    SDL_RenderPresent(renderer->renderer);
+    PROFILE_END(Present);
+  }
 
   state->lastTime = nowInNanoseconds;
 
@@ -129,9 +300,46 @@ SDL_AppEvent(void *appstate, SDL_Event *event)
     game_controller *keyboardAndMouse =
         GameControllerGetKeyboardAndMouse(input->controllers, ARRAY_COUNT(input->controllers));
 
+    // F5 starts/stops recording, F6 starts/stops looping playback of it
+    // F7 snapshots permanent storage, F8 restores it
+    // F9 writes timed blocks to profile.json
+    // F10 prints percentiles of frame and block times, writes histogram when --histogram=path
+    SDL_KeyboardEvent keyEvent = event->key;
+    if (keyEvent.down && !keyEvent.repeat) {
+      input_recorder *recorder = &state->recorder;
+      if (keyEvent.scancode == SDL_SCANCODE_F9) {
+        game_state *gameState = state->memory.permanentStorage;
+        if (state->memory.profiler)
+          ProfilerWriteChromeTrace(state->memory.profiler, "profile.json", gameState->particleCount);
+      } else if (keyEvent.scancode == SDL_SCANCODE_F10) {
+        ProfilerStatsWriteSummary(&state->profilerStats, state->memory.profiler, STDOUT_FILENO);
+        if (state->histogramPath)
+          ProfilerStatsWriteCsv(&state->profilerStats, state->memory.profiler, state->histogramPath);
+      } else if (keyEvent.scancode == SDL_SCANCODE_F7) {
+        PermanentStorageSnapshot(&state->permanentStorage, 0, state->memory.permanentStorageUsed);
+      } else if (keyEvent.scancode == SDL_SCANCODE_F8) {
+        if (PermanentStorageRestore(&state->permanentStorage, 0))
+          state->memory.isStateReplaced = 1;
+      } else if (keyEvent.scancode == SDL_SCANCODE_F5) {
+        if (InputRecorderIsRecording(recorder)) {
+          InputRecordingEnd(recorder);
+        } else {
+          InputPlaybackEnd(recorder);
+          InputRecordingBegin(recorder, &state->memory, state->recordingPath);
+        }
+      } else if (keyEvent.scancode == SDL_SCANCODE_F6) {
+        if (InputRecorderIsPlaying(recorder)) {
+          InputPlaybackEnd(recorder);
+        } else {
+          InputRecordingEnd(recorder);
+          InputPlaybackBegin(recorder, &state->memory, state->recordingPath, 1);
+        }
+      }
+    }
+
 #if (0 && IS_BUILD_DEBUG)
     SDL_KeyboardEvent keyboardEvent = event->key;
-    string_builder *sb = &state->sb;
+    string_builder *sb = LogBegin();
     StringBuilderAppendString(sb, &STRING_FROM_ZERO_TERMINATED("key scancode: "));
     StringBuilderAppendU64(sb, keyboardEvent.scancode);
     StringBuilderAppendString(sb, &STRING_FROM_ZERO_TERMINATED(" down: "));
@@ -139,8 +347,7 @@ SDL_AppEvent(void *appstate, SDL_Event *event)
     StringBuilderAppendString(sb, &STRING_FROM_ZERO_TERMINATED(" repeat: "));
     StringBuilderAppendU64(sb, keyboardEvent.repeat);
     StringBuilderAppendString(sb, &STRING_FROM_ZERO_TERMINATED("\n"));
-    string s = StringBuilderFlush(sb);
-    write(STDOUT_FILENO, s.value, s.length);
+    LogEnd(sb, STDOUT_FILENO);
 #endif
     b8 *keyboardState = (b8 *)SDL_GetKeyboardState(0);
     if (unlikely(!keyboardState))
@@ -159,6 +366,8 @@ SDL_AppEvent(void *appstate, SDL_Event *event)
       keyboardAndMouse->lsY = 1.0f;
     else
       keyboardAndMouse->lsY = 0.0f;
+
+    keyboardAndMouse->back = keyboardState[SDL_SCANCODE_TAB];
   } break;
 
   case SDL_EVENT_MOUSE_BUTTON_DOWN:
@@ -186,14 +395,13 @@ SDL_AppEvent(void *appstate, SDL_Event *event)
 
 #if (0 && IS_BUILD_DEBUG)
     SDL_KeyboardEvent keyboardEvent = event->key;
-    string_builder *sb = &state->sb;
+    string_builder *sb = LogBegin();
     StringBuilderAppendString(sb, &STRING_FROM_ZERO_TERMINATED("mouse x "));
     StringBuilderAppendF32(sb, mouseEvent.x, 2);
     StringBuilderAppendString(sb, &STRING_FROM_ZERO_TERMINATED(" y "));
     StringBuilderAppendF32(sb, mouseEvent.y, 2);
     StringBuilderAppendString(sb, &STRING_FROM_ZERO_TERMINATED("\n"));
-    string s = StringBuilderFlush(sb);
-    write(STDOUT_FILENO, s.value, s.length);
+    LogEnd(sb, STDOUT_FILENO);
 #endif
   } break;
 
@@ -348,18 +556,63 @@ SDL_AppInit(void **appstate, int argc, char *argv[])
     }
   }
 
+  const s32 windowWidth = 1280;
+  const s32 windowHeight = 720;
+
+  b8 isSoftwareRenderer = 0;
+  b8 isRecording = 0;
+  b8 isPlaying = 0;
+  b8 isLooping = 0;
+  b8 isCounting = 0;
+  const char *recordingPath = "game.rec";
+  const char *statePath = "game.state";
+  const char *histogramPath = 0;
+  permanent_storage_open_mode stateOpenMode = PERMANENT_STORAGE_OPEN_NEW;
+  for (s32 argIndex = 1; argIndex < argc; argIndex++) {
+    string arg = StringFromZeroTerminated((u8 *)argv[argIndex], 1024);
+    string recordOption = STRING_FROM_ZERO_TERMINATED("--record=");
+    string playbackOption = STRING_FROM_ZERO_TERMINATED("--playback=");
+    string stateOption = STRING_FROM_ZERO_TERMINATED("--state=");
+    string histogramOption = STRING_FROM_ZERO_TERMINATED("--histogram=");
+    if (IsStringEqual(&arg, &STRING_FROM_ZERO_TERMINATED("--software-renderer"))) {
+      isSoftwareRenderer = 1;
+    } else if (IsStringStartsWith(&arg, &recordOption)) {
+      isRecording = 1;
+      recordingPath = argv[argIndex] + recordOption.length;
+    } else if (IsStringStartsWith(&arg, &playbackOption)) {
+      isPlaying = 1;
+      recordingPath = argv[argIndex] + playbackOption.length;
+    } else if (IsStringEqual(&arg, &STRING_FROM_ZERO_TERMINATED("--loop"))) {
+      isLooping = 1;
+    } else if (IsStringStartsWith(&arg, &stateOption)) {
+      statePath = argv[argIndex] + stateOption.length;
+    } else if (IsStringEqual(&arg, &STRING_FROM_ZERO_TERMINATED("--resume"))) {
+      stateOpenMode = PERMANENT_STORAGE_OPEN_RESUME;
+    } else if (IsStringEqual(&arg, &STRING_FROM_ZERO_TERMINATED("--perf-counters"))) {
+      isCounting = 1;
+    } else if (IsStringStartsWith(&arg, &histogramOption)) {
+      histogramPath = argv[argIndex] + histogramOption.length;
+    }
+  }
+
   // setup memory
   const u64 KILOBYTES = 1 << 10;
   const u64 MEGABYTES = 1 << 20;
   const u64 PERMANANT_MEMORY_USAGE = 8 * MEGABYTES;
   const u64 TRANSIENT_MEMORY_USAGE = 32 * MEGABYTES;
-  const u64 RENDERER_MEMORY_USAGE = 1 * MEGABYTES;
+  const u64 RENDERER_MEMORY_USAGE = 8 * MEGABYTES;
   const u64 STRING_BUILDER_MEMORY_USAGE = 1 * KILOBYTES;
+  const u64 PROFILER_MEMORY_USAGE = IS_PROFILER_ENABLED ? PROFILER_MEMORY_SIZE : 0;
+  const u64 PROFILER_STATS_MEMORY_USAGE = PROFILER_STATS_MEMORY_SIZE;
+  const u64 LOG_MEMORY_USAGE = LOG_MEMORY_SIZE;
+  const u64 FRAMEBUFFER_MEMORY_USAGE = isSoftwareRenderer ? (u64)windowWidth * (u64)windowHeight * sizeof(u32) : 0;
 
   memory_arena memory = {};
   {
-    memory.total =
-        PERMANANT_MEMORY_USAGE + TRANSIENT_MEMORY_USAGE + RENDERER_MEMORY_USAGE + STRING_BUILDER_MEMORY_USAGE;
+    // permanent storage is mapped from file, see PermanentStorageInit()
+    memory.total = TRANSIENT_MEMORY_USAGE + RENDERER_MEMORY_USAGE + STRING_BUILDER_MEMORY_USAGE +
+                   PROFILER_MEMORY_USAGE + PROFILER_STATS_MEMORY_USAGE + LOG_MEMORY_USAGE +
+                   FRAMEBUFFER_MEMORY_USAGE;
     memory.total += sizeof(sdl_state); // for app state tracking
     memory.block = SDL_malloc(memory.total);
     if (memory.block == 0) {
@@ -371,8 +624,6 @@ SDL_AppInit(void **appstate, int argc, char *argv[])
   sdl_state *state = MemoryArenaPush(&memory, sizeof(*state), 4);
   memset(state, 0, sizeof(*state));
 
-  const s32 windowWidth = 1280;
-  const s32 windowHeight = 720;
   state->invWindowWidth = 1.0f / (f32)windowWidth;
   state->invWindowHeight = 1.0f / (f32)windowHeight;
 
@@ -382,37 +633,79 @@ SDL_AppInit(void **appstate, int argc, char *argv[])
     memset(renderer->memory.block, 0, renderer->memory.total);
 
     renderer->screenCenter = (v2){(f32)windowWidth * 0.5f, (f32)windowHeight * 0.5f};
+
+    if (isSoftwareRenderer) {
+      renderer->backend = RENDER_BACKEND_SOFTWARE;
+      renderer->framebuffer = (render_framebuffer){
+          .pixels = MemoryArenaPush(&memory, FRAMEBUFFER_MEMORY_USAGE, 4),
+          .width = (u32)windowWidth,
+          .height = (u32)windowHeight,
+          .pitch = (u32)windowWidth,
+      };
+    }
   }
 
   { // - string builder
     memory_arena sbMemory = MemoryArenaSub(&memory, STRING_BUILDER_MEMORY_USAGE);
-    string *stringBuffer = MemoryArenaPush(&sbMemory, sizeof(*stringBuffer), 4);
-    *stringBuffer = MemoryArenaPushString(&sbMemory, 32);
     string *outBuffer = MemoryArenaPush(&sbMemory, sizeof(*outBuffer), 4);
     *outBuffer = MemoryArenaPushString(&sbMemory, sbMemory.total - sbMemory.used);
 
     string_builder *sb = &state->sb;
     sb->outBuffer = outBuffer;
-    sb->stringBuffer = stringBuffer;
   }
 
+#if IS_PROFILER_ENABLED
+  ProfilerInit(&state->profiler, &memory);
+  if (isCounting && !ProfilerOpenCounters(&state->profiler)) {
+    string *message = &STRING_FROM_ZERO_TERMINATED("Hardware counters are not available, see perf_event_paranoid\n");
+    write(STDERR_FILENO, message->value, message->length);
+  }
+  state->memory.profiler = &state->profiler;
+#else
+  (void)isCounting;
+#endif
+  ProfilerStatsInit(&state->profilerStats, &memory);
+  state->histogramPath = histogramPath;
+
+  if (LoggerInit(&state->logger, &memory))
+    state->memory.logger = &state->logger;
+
 #if IS_BUILD_DEBUG
   state->executablePath = StringFromZeroTerminated((u8 *)argv[0], 1024);
+  if (!GameLibraryInit(&state->lib, state))
+    return SDL_APP_FAILURE;
   GameLibraryReload(&state->lib, state);
 #endif
 
   { // setup game memory
     game_memory *gameMemory = &state->memory;
     gameMemory->permanentStorageSize = PERMANANT_MEMORY_USAGE;
-    gameMemory->permanentStorage = MemoryArenaPush(&memory, gameMemory->permanentStorageSize, 4);
-    memset(gameMemory->permanentStorage, 0, gameMemory->permanentStorageSize);
+    permanent_storage *permanentStorage = &state->permanentStorage;
+    if (!PermanentStorageInit(permanentStorage, statePath, gameMemory->permanentStorageSize, stateOpenMode)) {
+      return SDL_APP_FAILURE;
+    }
+    // new file is zeroed by kernel
+    gameMemory->permanentStorage = permanentStorage->block;
 
     gameMemory->transientStorageSize = TRANSIENT_MEMORY_USAGE;
     gameMemory->transientStorage = MemoryArenaPush(&memory, gameMemory->transientStorageSize, 4);
+    gameMemory->isRewindEnabled = 1;
 
     transient_state *transientState = gameMemory->transientStorage;
     transientState->sb = &state->sb;
   }
+
+  { // input recording
+    input_recorder *recorder = &state->recorder;
+    InputRecorderInit(recorder);
+    state->recordingPath = recordingPath;
+    if (isRecording && !InputRecordingBegin(recorder, &state->memory, recordingPath)) {
+      return SDL_APP_FAILURE;
+    }
+    if (isPlaying && !InputPlaybackBegin(recorder, &state->memory, recordingPath, isLooping)) {
+      return SDL_APP_FAILURE;
+    }
+  }
   debug_assert(memory.used == memory.total && "Warning: you are not using specified memory amount");
 
   // SDL
@@ -431,6 +724,23 @@ SDL_AppInit(void **appstate, int argc, char *argv[])
     return SDL_APP_FAILURE;
   }
 
+  if (isSoftwareRenderer) {
+    state->framebufferTexture = SDL_CreateTexture(renderer->renderer, SDL_PIXELFORMAT_RGBA32,
+                                                  SDL_TEXTUREACCESS_STREAMING, windowWidth, windowHeight);
+    if (!state->framebufferTexture) {
+      return SDL_APP_FAILURE;
+    }
+
+    // main thread also works while waiting
+    s32 coreCount = SDL_GetNumLogicalCPUCores();
+    u32 threadCount = coreCount > 1 ? (u32)coreCount - 1 : 0;
+    if (WorkQueueInit(&state->workQueue, threadCount)) {
+      renderer->workQueue = &state->workQueue;
+      renderer->PlatformAddWorkEntry = WorkQueueAddEntry;
+      renderer->PlatformCompleteAllWork = WorkQueueCompleteAllWork;
+    }
+  }
+
   SDL_HideCursor();
 
   // if (!SDL_SetRenderScale(renderer->renderer, (f32)windowWidth * PIXELS_PER_METER,
@@ -447,5 +757,12 @@ void
 SDL_AppQuit(void *appstate, SDL_AppResult result)
 {
   sdl_state *state = appstate;
+  ProfilerStatsWriteSummary(&state->profilerStats, state->memory.profiler, STDOUT_FILENO);
+  if (state->histogramPath)
+    ProfilerStatsWriteCsv(&state->profilerStats, state->memory.profiler, state->histogramPath);
+  InputRecordingEnd(&state->recorder);
+  PermanentStorageSync(&state->permanentStorage);
+  if (state->memory.logger)
+    LoggerFlush(state->memory.logger);
   SDL_DestroyRenderer(state->renderer.renderer);
 }
@@ -0,0 +1,178 @@
+#include "platform.h"
+#include <fcntl.h>    // open()
+#include <sys/mman.h> // mmap(), msync()
+#include <sys/stat.h> // fstat()
+#include <unistd.h>   // ftruncate(), close()
+
+/*
+ * Permanent storage is a file that is mapped into memory.
+ *   - File always has latest state that is synced, so a repro case is saved
+ *     by syncing and copying the file.
+ *   - Snapshot slots are memory that is kept mapped and faulted in, so
+ *     snapshot and restore are one memcpy, no system calls.
+ *   - Only bytes that hold state are copied, storage is sized for the
+ *     largest world but most of it is never touched.
+ *
+ *   PermanentStorageInit(&storage, "game.state", size, PERMANENT_STORAGE_OPEN_NEW);
+ *   PermanentStorageSnapshot(&storage, 0, used); // warm state
+ *   ...
+ *   PermanentStorageRestore(&storage, 0);  // back to warm state
+ *   PermanentStorageSync(&storage);        // on disk
+ *
+ * Permanent storage is always mapped at same address.
+ * game_state keeps pointers into itself (particles, world arena), so a copy
+ * of permanent storage is only valid at the address it is taken from. With
+ * fixed address a snapshot that is written to disk can be loaded by another
+ * run of the program.
+ */
+#define PERMANENT_STORAGE_ADDRESS ((void *)0x200000000000ull) // 32 TiB
+#define PERMANENT_STORAGE_SLOT_COUNT 4
+
+typedef enum {
+  PERMANENT_STORAGE_OPEN_NEW,      // file is truncated, storage starts zeroed
+  PERMANENT_STORAGE_OPEN_RESUME,   // continues from file, changes are written back to file
+  PERMANENT_STORAGE_OPEN_READONLY, // continues from file, changes stay in memory
+} permanent_storage_open_mode;
+
+typedef struct {
+  void *block; // at PERMANENT_STORAGE_ADDRESS
+  u64 size;
+  s32 fd; // -1 when not backed by file
+  permanent_storage_open_mode mode;
+
+  void *slots[PERMANENT_STORAGE_SLOT_COUNT]; // 0 until first snapshot into it
+  u64 slotUsed[PERMANENT_STORAGE_SLOT_COUNT]; // 0 when nothing is snapshotted into slot
+} permanent_storage;
+
+/* @return 0 when mapping failed */
+static void *
+PermanentStorageMapAtFixedAddress(u64 size, s32 flags, s32 fd)
+{
+#if defined(MAP_FIXED_NOREPLACE)
+  // fail instead of replacing a mapping that is already there
+  flags |= MAP_FIXED_NOREPLACE;
+#endif
+  void *block = mmap(PERMANENT_STORAGE_ADDRESS, size, PROT_READ | PROT_WRITE, flags, fd, 0);
+  if (block == MAP_FAILED)
+    return 0;
+
+  // kernel only took it as a hint
+  if (block != PERMANENT_STORAGE_ADDRESS) {
+    munmap(block, size);
+    return 0;
+  }
+
+  return block;
+}
+
+/*
+ * Without path storage is anonymous memory, it is not saved anywhere.
+ * With RESUME and READONLY, size of file must be equal to size.
+ * @return 0 when file cannot be opened or mapped
+ */
+static b8
+PermanentStorageInit(permanent_storage *storage, const char *path, u64 size, permanent_storage_open_mode mode)
+{
+  *storage = (permanent_storage){
+      .size = size,
+      .fd = -1,
+      .mode = mode,
+  };
+
+  if (!path) {
+    storage->block = PermanentStorageMapAtFixedAddress(size, MAP_PRIVATE | MAP_ANONYMOUS, -1);
+    return storage->block != 0;
+  }
+
+  s32 openFlags = mode == PERMANENT_STORAGE_OPEN_NEW ? O_RDWR | O_CREAT | O_TRUNC : O_RDWR;
+  if (mode == PERMANENT_STORAGE_OPEN_READONLY)
+    openFlags = O_RDONLY;
+  s32 fd = open(path, openFlags, 0644);
+  if (fd < 0)
+    return 0;
+
+  b8 isSizeValid;
+  if (mode == PERMANENT_STORAGE_OPEN_NEW) {
+    // file is sparse, blocks are only allocated when they are touched
+    isSizeValid = ftruncate(fd, (off_t)size) == 0;
+  } else {
+    struct stat fileStat;
+    isSizeValid = fstat(fd, &fileStat) == 0 && (u64)fileStat.st_size == size;
+  }
+  if (!isSizeValid) {
+    close(fd);
+    return 0;
+  }
+
+  // read-only file is still writable in memory, copy-on-write keeps changes private
+  s32 mapFlags = mode == PERMANENT_STORAGE_OPEN_READONLY ? MAP_PRIVATE : MAP_SHARED;
+  storage->block = PermanentStorageMapAtFixedAddress(size, mapFlags, fd);
+  if (!storage->block) {
+    close(fd);
+    return 0;
+  }
+
+  storage->fd = fd;
+  return 1;
+}
+
+/* @return size of file, 0 when it does not exist */
+static u64
+PermanentStorageFileSize(const char *path)
+{
+  struct stat fileStat;
+  if (stat(path, &fileStat) != 0)
+    return 0;
+  return (u64)fileStat.st_size;
+}
+
+/*
+ * Copies first used bytes of storage into slot, 0 means whole storage.
+ * Bytes after used are not restored, so they must not hold state.
+ * First snapshot into a slot allocates it, pages are faulted in as they are
+ * copied into.
+ * @return 0 when slot cannot be allocated
+ */
+static b8
+PermanentStorageSnapshot(permanent_storage *storage, u32 slotIndex, u64 used)
+{
+  debug_assert(slotIndex < PERMANENT_STORAGE_SLOT_COUNT);
+  debug_assert(used <= storage->size);
+  if (!storage->slots[slotIndex]) {
+    void *slot = mmap(0, storage->size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (slot == MAP_FAILED)
+      return 0;
+    storage->slots[slotIndex] = slot;
+  }
+
+  if (used == 0)
+    used = storage->size;
+  memcpy(storage->slots[slotIndex], storage->block, used);
+  storage->slotUsed[slotIndex] = used;
+  return 1;
+}
+
+/* @return 0 when nothing is snapshotted into slot, storage is not touched */
+static b8
+PermanentStorageRestore(permanent_storage *storage, u32 slotIndex)
+{
+  debug_assert(slotIndex < PERMANENT_STORAGE_SLOT_COUNT);
+  u64 used = storage->slotUsed[slotIndex];
+  if (used == 0)
+    return 0;
+
+  memcpy(storage->block, storage->slots[slotIndex], used);
+  return 1;
+}
+
+/*
+ * Writes dirty pages to file, so it can be opened with RESUME or READONLY.
+ * @return 0 when storage is not written back to file or write failed
+ */
+static b8
+PermanentStorageSync(permanent_storage *storage)
+{
+  if (storage->fd < 0 || storage->mode == PERMANENT_STORAGE_OPEN_READONLY)
+    return 0;
+  return msync(storage->block, storage->size, MS_SYNC) == 0;
+}
@@ -1,6 +1,121 @@
 #include "physics.h"
 #include "math.h"
 
+#if IS_PHYSICS_FIXED_POINT
+
+static v2q
+GenerateWeightForce(struct particle *particle)
+{
+  // see: https://en.wikipedia.org/wiki/Gravity_of_Earth
+  // unit: m/s²
+  const v2q earthGravityForce = {Q16(0.0), Q16(-9.80665)};
+
+  /* Generate weight force
+   *   F = mg
+   */
+
+  v2q weightForce = v2q_scale(earthGravityForce, particle->mass);
+  return weightForce;
+}
+
+static v2q
+GenerateWindForce(void)
+{
+  v2q windForce = {Q16(2.0), Q16(0.0)};
+  return windForce;
+}
+
+static v2q
+GenerateFrictionForce(struct particle *particle, q16 k)
+{
+  /* Generate friction force
+   *   F = k (-normalized(v))
+   */
+
+  v2q frictionDirection = v2q_neg(v2q_normalize(particle->velocity));
+  v2q frictionForce = v2q_scale(frictionDirection, k);
+  return frictionForce;
+}
+
+static v2q
+GenerateDragForce(struct particle *particle, q16 k)
+{
+  /* Generate drag force
+   *   F = k ‖v‖² (-normalized(v))
+   * Because normalized(v) is v / ‖v‖, this is same as
+   *   F = -k ‖v‖ v
+   * which does not need division.
+   */
+
+  q16 speed = v2q_length(particle->velocity);
+  v2q dragForce = v2q_scale(particle->velocity, -q16_mul(k, speed));
+  return dragForce;
+}
+
+static v2q
+GenerateGravitationalAttractionForce(struct particle *a, struct particle *b, q16 G)
+{
+  /* Generate gravitational attraction force
+   *   F = G ((m₁ m₂) / ‖d‖²) normalized(d)
+   * Real gravitational constant is smaller than resolution of Q16.16, caller
+   * must provide scaled G.
+   */
+
+  v2q distance = v2q_sub(b->position, a->position);
+  q16 distanceSquared = v2q_length_square(distance);
+
+  // Avoid division by zero or excessively large forces when particles are too close
+  // Not physically accurate.
+  if (distanceSquared < Q16(0.1))
+    distanceSquared = Q16(0.1);
+  else if (distanceSquared > Q16(8.0))
+    distanceSquared = Q16(8.0);
+
+  q16 attractionMagnitude = q16_div(q16_mul(G, q16_mul(a->mass, b->mass)), distanceSquared);
+  v2q attractionDirection = v2q_normalize(distance);
+  v2q attractionForce = v2q_scale(attractionDirection, attractionMagnitude);
+
+  return attractionForce;
+}
+
+static v2q
+GenerateSpringForce(struct particle *particle, v2q anchorPosition, q16 restLength, q16 k)
+{
+  /* Generate spring force
+   *   F = -k ∆l normalized(d)
+   * normalized(d) is d / ‖d‖, so only one division is needed
+   *   F = d (-k ∆l / ‖d‖)
+   */
+
+  v2q distance = v2q_sub(particle->position, anchorPosition);
+  q16 length = v2q_length(distance);
+  if (length == 0)
+    return (v2q){0, 0};
+
+  q16 displacement = length - restLength;
+  q16 springMagnitude = q16_mul(-k, displacement);
+  v2q springForce = v2q_scale(distance, q16_div(springMagnitude, length));
+  return springForce;
+}
+
+static void
+IntegrateParticle(struct particle *particle, v2q sumOfForces, q16 dt)
+{
+  // a = F/m
+  v2q acceleration = v2q_scale(sumOfForces, particle->invMass);
+
+  // v = at + v₀
+  particle->velocity = v2q_add(particle->velocity, v2q_scale(acceleration, dt));
+
+  // p = ½at² + vt + p₀
+  //   = (½at + v)t + p₀
+  // ½t² is too small for Q16.16, so it is grouped to keep precision
+  v2q halfAccelerationTimesDt = v2q_scale(acceleration, dt / 2);
+  particle->position = v2q_add(particle->position, v2q_scale(v2q_add(halfAccelerationTimesDt, particle->velocity), dt));
+}
+
+#else
+
 static v2
 GenerateWeightForce(struct particle *particle)
 {
@@ -71,10 +186,10 @@ GenerateDragForce(struct particle *particle, f32 k)
 static v2
 GenerateGravitationalAttractionForce(struct particle *a, struct particle *b, f32 G)
 {
-  /* unit: m³ kg⁻¹ s⁻²
+  /* Universal gravitational constant is 6.6743015e-11, unit: m³ kg⁻¹ s⁻²
    * see: https://en.wikipedia.org/wiki/Gravitational_constant#Modern_value
+   * G is given by caller, so world scale can pick stronger one.
    */
-  const f32 UNIVERSAL_GRAVITATIONAL_CONSTANT = 6.6743015e-11f;
 
   /* Generate gravitational attraction force
    *   F = G ((m₁ m₂) / ‖d‖²) normalized(d)
@@ -114,3 +229,29 @@ GenerateSpringForce(struct particle *particle, v2 anchorPosition, f32 restLength
   v2 springForce = v2_scale(springDirection, springMagnitude);
   return springForce;
 }
+
+static void
+IntegrateParticle(struct particle *particle, v2 sumOfForces, f32 dt)
+{
+  // F = ma
+  // a = F/m
+  v2 acceleration = v2_scale(sumOfForces, particle->invMass);
+
+  // acceleration = f''(t) = a
+  // acceleration = v2_scale((v2){1.0f, 0.0f}, speed);
+
+  // velocity     = ∫f''(t)
+  //              = f'(t) = at + v₀
+  // position     = ∫f'(t)
+  //              = f(t) = ½at² + vt + p₀
+  particle->velocity = v2_add(particle->velocity, v2_scale(acceleration, dt));
+  particle->position =
+      // ½at² + vt + p₀
+      v2_add(particle->position, v2_add(
+                                     // ½at²
+                                     v2_scale(acceleration, 0.5f * Square(dt)),
+                                     // + vt
+                                     v2_scale(particle->velocity, dt)));
+}
+
+#endif
@@ -9,14 +9,101 @@
  *     y positive means up, negative down
  */
 
+#ifndef IS_PHYSICS_FIXED_POINT
+#define IS_PHYSICS_FIXED_POINT 0
+#endif
+
+#if IS_PHYSICS_FIXED_POINT
+/*
+ * Fixed point build of physics.
+ * Every quantity is Q16.16, so simulation is bit exact on every machine and
+ * build type. Use ParticleGetPosition() and ParticleGetMass() when floating
+ * point is needed, eg. rendering.
+ */
+#include "fixed.h"
+
+typedef struct particle {
+  v2q position;     // unit: m
+  v2q velocity;     // unit: m/s
+  q16 mass;         // unit: kg
+  q16 invMass;      // computed from 1/mass
+} particle;
+
+static inline v2
+ParticleGetPosition(struct particle *particle)
+{
+  return v2q_to_v2(particle->position);
+}
+
+static inline f32
+ParticleGetMass(struct particle *particle)
+{
+  return q16_to_f32(particle->mass);
+}
+
+/* Generate weight force */
+static v2q
+GenerateWeightForce(struct particle *particle);
+
+/* Generate wind force */
+static v2q
+GenerateWindForce(void);
+
+/* Generate friction force
+ * @param k friction constant
+ */
+static v2q
+GenerateFrictionForce(struct particle *particle, q16 k);
+
+/* Generate drag force
+ * @param k drag constant
+ */
+static v2q
+GenerateDragForce(struct particle *particle, q16 k);
+
+/* Generate gravitational attraction force
+ * @param G is universal gravitational constant
+ */
+static v2q
+GenerateGravitationalAttractionForce(struct particle *a, struct particle *b, q16 G);
+
+/* Generate spring force
+ * @param particle particle that attach to anchor
+ * @param anchorPosition position of anchor
+ * @param restLength length of spring that is not compressed or extended, equilibrium point
+ * @param k spring constant
+ */
+static v2q
+GenerateSpringForce(struct particle *particle, v2q anchorPosition, q16 restLength, q16 k);
+
+/* Integrate applied forces
+ * @param sumOfForces net force applied to particle
+ * @param dt time step
+ */
+static void
+IntegrateParticle(struct particle *particle, v2q sumOfForces, q16 dt);
+
+#else
+
 typedef struct particle {
   v2 position;     // unit: m
   v2 velocity;     // unit: m/s
-  v2 acceleration; // unit: m/s²
   f32 mass;        // unit: kg
   f32 invMass;     // computed from 1/mass
 } particle;
 
+static inline v2
+ParticleGetPosition(struct particle *particle)
+{
+  return particle->position;
+}
+
+static inline f32
+ParticleGetMass(struct particle *particle)
+{
+  return particle->mass;
+}
+
 /* Generate weight force */
 static v2
 GenerateWeightForce(struct particle *particle);
@@ -51,3 +138,12 @@ GenerateGravitationalAttractionForce(struct particle *a, struct particle *b, f32
  */
 static v2
 GenerateSpringForce(struct particle *particle, v2 anchorPosition, f32 restLength, f32 k);
+
+/* Integrate applied forces
+ * @param sumOfForces net force applied to particle
+ * @param dt time step
+ */
+static void
+IntegrateParticle(struct particle *particle, v2 sumOfForces, f32 dt);
+
+#endif
@@ -60,10 +60,54 @@ typedef struct {
   game_controller controllers[3]; // 1 keyboard + 2 controllers
 } game_input;
 
+typedef struct profiler profiler; // see profiler.h
+typedef struct logger logger;     // see logger.h
+
+#define GAME_STATE_HASH_CHUNK_MAX 256
+
+/*
+ * Hash of simulation state after a frame.
+ * Particles are hashed in chunks, so when two runs diverge the chunks tell
+ * which particles diverged first.
+ */
+typedef struct {
+  u64 value;      // of fieldsHash and every chunk
+  u64 fieldsHash; // game state except particles
+  u32 particleCount;
+  u32 particlesPerChunk;
+  u32 chunkCount;
+  u64 chunks[GAME_STATE_HASH_CHUNK_MAX]; // chunk i is particles [i * particlesPerChunk, (i + 1) * particlesPerChunk)
+} game_state_hash;
+
 typedef struct {
   void *permanentStorage; // required to be to zero
   u64 permanentStorageSize;
+  u64 permanentStorageUsed; // written by game at end of every frame, state lives in [0, used)
 
   void *transientStorage;
   u64 transientStorageSize;
+
+  u32 particleCount;  // read once at initialization, 0 means game decides
+  b8 isRewindEnabled; // read once at initialization, when 0 no frame is captured
+  b8 isStateReplaced; // platform sets it when it overwrites permanent storage, game clears it
+
+  b8 isStateHashEnabled;     // platform sets it on frames whose hash it reads
+  game_state_hash stateHash; // written by game at end of frame when isStateHashEnabled
+
+  profiler *profiler; // 0 when timed blocks are not recorded
+  logger *logger;     // 0 when messages are written at once
 } game_memory;
+
+/*
+ * Work queue
+ *   Platform runs entries on worker threads. Entries that are added must not
+ *   depend on each other, order they run is not known.
+ *
+ *   PlatformAddWorkEntry(queue, Callback, data);
+ *   PlatformCompleteAllWork(queue); // caller helps until every entry is done
+ */
+typedef struct platform_work_queue platform_work_queue;
+
+typedef void (*pfnPlatformWorkQueueCallback)(platform_work_queue *queue, void *data);
+typedef void (*pfnPlatformAddWorkEntry)(platform_work_queue *queue, pfnPlatformWorkQueueCallback callback, void *data);
+typedef void (*pfnPlatformCompleteAllWork)(platform_work_queue *queue);
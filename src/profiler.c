@@ -0,0 +1,255 @@
+#include "profiler.h"
+#include <fcntl.h>  // open()
+#include <unistd.h> // write(), close()
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/syscall.h> // syscall(), SYS_perf_event_open
+#endif
+
+/*
+ * Platform side of profiler: owns memory, converts ticks to time and exports
+ * Chrome trace event JSON.
+ *
+ *   ProfilerInit(&profiler, &arena);
+ *   ProfilerOpenCounters(&profiler); // optional, on thread that runs game
+ *   memory->profiler = &profiler;
+ *   ...
+ *   ProfilerWriteChromeTrace(&profiler, "profile.json");
+ */
+
+static void
+ProfilerInit(profiler *profiler, memory_arena *arena)
+{
+  *profiler = (struct profiler){
+      .eventMemory = MemoryArenaPush(arena, sizeof(profiler_event) * PROFILER_THREAD_MAX * PROFILER_EVENT_COUNT, 8),
+      .counterFd = -1,
+      .counterMemory = MemoryArenaPush(arena, sizeof(profiler_counters) * PROFILER_EVENT_COUNT, 8),
+      .startTick = ProfilerTick(),
+      .startNanoseconds = SDL_GetTicksNS(),
+  };
+  globalProfiler = profiler;
+}
+
+#if defined(__linux__)
+/* @return file descriptor of counter, -1 when it cannot be opened */
+static s32
+ProfilerOpenCounter(u32 type, u64 config, s32 groupFd)
+{
+  struct perf_event_attr attr = {
+      .type = type,
+      .size = sizeof(attr),
+      .config = config,
+      .read_format = PERF_FORMAT_GROUP,
+      // user space only, so it works with default perf_event_paranoid of 2
+      .exclude_kernel = 1,
+      .exclude_hv = 1,
+  };
+  // this thread on any cpu
+  return (s32)syscall(SYS_perf_event_open, &attr, 0, -1, groupFd, 0);
+}
+#endif
+
+/*
+ * Opens hardware counters of calling thread as one group, so they are read
+ * at once. Cycles must be available, other counters are skipped when cpu or
+ * virtual machine does not have them.
+ * Must be called before calling thread runs its first timed block.
+ * @return 0 when counters are not permitted or not supported, profiler still
+ *         records time
+ */
+static b8
+ProfilerOpenCounters(profiler *profiler)
+{
+#if defined(__linux__)
+  struct {
+    u32 type;
+    u64 config;
+  } counterConfigs[PROFILER_COUNTER_COUNT] = {
+      [PROFILER_COUNTER_CYCLES] = {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+      [PROFILER_COUNTER_INSTRUCTIONS] = {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+      [PROFILER_COUNTER_L1D_MISSES] = {PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D | PERF_COUNT_HW_CACHE_OP_READ << 8 |
+                                                               PERF_COUNT_HW_CACHE_RESULT_MISS << 16},
+      [PROFILER_COUNTER_LLC_MISSES] = {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+      [PROFILER_COUNTER_BRANCH_MISSES] = {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+  };
+
+  s32 groupFd = ProfilerOpenCounter(counterConfigs[0].type, counterConfigs[0].config, -1);
+  if (groupFd < 0)
+    return 0;
+
+  u32 counterMask = 1u << PROFILER_COUNTER_CYCLES;
+  for (u32 counter = 1; counter < PROFILER_COUNTER_COUNT; counter++) {
+    // members live as long as group leader, process never closes them
+    s32 fd = ProfilerOpenCounter(counterConfigs[counter].type, counterConfigs[counter].config, groupFd);
+    if (fd >= 0)
+      counterMask |= 1u << counter;
+  }
+
+  profiler->counterFd = groupFd;
+  profiler->counterThreadId = SDL_GetCurrentThreadID();
+  profiler->counterMask = counterMask;
+
+  // group must be readable, e.g. virtual machines may open counters that never schedule
+  profiler_counters counters;
+  if (!ProfilerReadCounters(profiler, &counters)) {
+    profiler->counterMask = 0;
+    return 0;
+  }
+  return 1;
+#else
+  (void)profiler;
+  return 0;
+#endif
+}
+
+/*
+ * Drops every event.
+ * Names of events point into game library, they are invalid after it is
+ * reloaded. Must be called when no timed block is running.
+ */
+static void
+ProfilerClear(profiler *profiler)
+{
+  s32 threadCount = Minimum(SDL_GetAtomicInt(&profiler->threadCount), PROFILER_THREAD_MAX);
+  for (s32 threadIndex = 0; threadIndex < threadCount; threadIndex++)
+    profiler->threads[threadIndex].writeIndex = 0;
+}
+
+/*
+ * Ticks are calibrated against SDL_GetTicksNS() between ProfilerInit() and
+ * now, so longer runs give more precise times.
+ */
+static f64
+ProfilerNanosecondsPerTick(profiler *profiler)
+{
+  u64 nowTick = ProfilerTick();
+  u64 nowNanoseconds = SDL_GetTicksNS();
+  return nowTick > profiler->startTick
+             ? (f64)(nowNanoseconds - profiler->startNanoseconds) / (f64)(nowTick - profiler->startTick)
+             : 0.0;
+}
+
+/* Appends nanoseconds as microseconds with 3 fraction digits, unit of Chrome trace. */
+static void
+ProfilerAppendMicroseconds(string_builder *sb, u64 nanoseconds)
+{
+  StringBuilderAppendU64(sb, nanoseconds / 1000);
+  u64 fraction = nanoseconds % 1000;
+  StringBuilderAppendString(sb, &STRING_FROM_ZERO_TERMINATED("."));
+  if (fraction < 100)
+    StringBuilderAppendString(sb, &STRING_FROM_ZERO_TERMINATED("0"));
+  if (fraction < 10)
+    StringBuilderAppendString(sb, &STRING_FROM_ZERO_TERMINATED("0"));
+  StringBuilderAppendU64(sb, fraction);
+}
+
+/*
+ * Appends counters of block as Chrome trace event args, misses are also
+ * divided by particle count when it is not 0.
+ */
+static void
+ProfilerAppendCounters(string_builder *sb, profiler_counters *counters, u32 particleCount)
+{
+  static const char *COUNTER_NAMES[PROFILER_COUNTER_COUNT] = {
+      [PROFILER_COUNTER_CYCLES] = "cycles",
+      [PROFILER_COUNTER_INSTRUCTIONS] = "instructions",
+      [PROFILER_COUNTER_L1D_MISSES] = "l1dMisses",
+      [PROFILER_COUNTER_LLC_MISSES] = "llcMisses",
+      [PROFILER_COUNTER_BRANCH_MISSES] = "branchMisses",
+  };
+  comptime u32 IPC_MASK = 1u << PROFILER_COUNTER_CYCLES | 1u << PROFILER_COUNTER_INSTRUCTIONS;
+
+  StringBuilderAppendString(sb, &STRING_FROM_ZERO_TERMINATED(",\"args\":{"));
+  b8 isFirstArg = 1;
+  for (u32 counter = 0; counter < PROFILER_COUNTER_COUNT; counter++) {
+    if (!(counters->mask & (1u << counter)))
+      continue;
+    if (!isFirstArg)
+      StringBuilderAppendString(sb, &STRING_FROM_ZERO_TERMINATED(","));
+    isFirstArg = 0;
+    StringBuilderAppendString(sb, &STRING_FROM_ZERO_TERMINATED("\""));
+    StringBuilderAppendZeroTerminated(sb, COUNTER_NAMES[counter], 32);
+    StringBuilderAppendString(sb, &STRING_FROM_ZERO_TERMINATED("\":"));
+    StringBuilderAppendU64(sb, counters->values[counter]);
+
+    if (counter >= PROFILER_COUNTER_L1D_MISSES && particleCount > 0) {
+      StringBuilderAppendString(sb, &STRING_FROM_ZERO_TERMINATED(",\""));
+      StringBuilderAppendZeroTerminated(sb, COUNTER_NAMES[counter], 32);
+      StringBuilderAppendString(sb, &STRING_FROM_ZERO_TERMINATED("PerParticle\":"));
+      StringBuilderAppendF32(sb, (f32)counters->values[counter] / (f32)particleCount, 4);
+    }
+  }
+  if ((counters->mask & IPC_MASK) == IPC_MASK && counters->values[PROFILER_COUNTER_CYCLES] > 0) {
+    StringBuilderAppendString(sb, &STRING_FROM_ZERO_TERMINATED(",\"ipc\":"));
+    StringBuilderAppendF32(sb,
+                           (f32)counters->values[PROFILER_COUNTER_INSTRUCTIONS] /
+                               (f32)counters->values[PROFILER_COUNTER_CYCLES],
+                           3);
+  }
+  StringBuilderAppendString(sb, &STRING_FROM_ZERO_TERMINATED("}"));
+}
+
+/*
+ * Writes events of every thread as Chrome trace event JSON.
+ * Blocks with hardware counters carry them as args, misses also per particle
+ * when particleCount is not 0.
+ * Must be called when no timed block is running, e.g. between frames.
+ * @return 0 when file cannot be written
+ */
+static b8
+ProfilerWriteChromeTrace(profiler *profiler, const char *path, u32 particleCount)
+{
+  s32 fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0)
+    return 0;
+
+  f64 nanosecondsPerTick = ProfilerNanosecondsPerTick(profiler);
+
+  u8 outBufferBytes[64 * 1024];
+  string_builder sb = {
+      .outBuffer = &(struct string){.value = outBufferBytes, .length = sizeof(outBufferBytes)},
+  };
+  StringBuilderAttachFd(&sb, fd);
+  comptime u64 PROFILER_NAME_MAX = 128;
+
+  StringBuilderAppendString(&sb, &STRING_FROM_ZERO_TERMINATED("{\"displayTimeUnit\":\"ns\",\"traceEvents\":["));
+  b8 isFirstEvent = 1;
+  s32 threadCount = Minimum(SDL_GetAtomicInt(&profiler->threadCount), PROFILER_THREAD_MAX);
+  for (s32 threadIndex = 0; threadIndex < threadCount; threadIndex++) {
+    profiler_thread *thread = profiler->threads + threadIndex;
+    if (!thread->events)
+      continue;
+
+    u32 writeIndex = thread->writeIndex;
+    SDL_MemoryBarrierAcquire();
+    u32 eventCount = Minimum(writeIndex, PROFILER_EVENT_COUNT);
+    for (u32 readIndex = writeIndex - eventCount; readIndex != writeIndex; readIndex++) {
+      u32 eventIndex = readIndex & (PROFILER_EVENT_COUNT - 1);
+      profiler_event *event = thread->events + eventIndex;
+
+      u64 beginNanoseconds = (u64)((f64)(event->beginTick - profiler->startTick) * nanosecondsPerTick);
+      u64 durationNanoseconds = (u64)((f64)(event->endTick - event->beginTick) * nanosecondsPerTick);
+
+      if (!isFirstEvent)
+        StringBuilderAppendString(&sb, &STRING_FROM_ZERO_TERMINATED(","));
+      isFirstEvent = 0;
+      StringBuilderAppendString(&sb, &STRING_FROM_ZERO_TERMINATED("\n{\"name\":\""));
+      StringBuilderAppendZeroTerminated(&sb, event->name, PROFILER_NAME_MAX);
+      StringBuilderAppendString(&sb, &STRING_FROM_ZERO_TERMINATED("\",\"ph\":\"X\",\"pid\":1,\"tid\":"));
+      StringBuilderAppendU64(&sb, thread->threadId);
+      StringBuilderAppendString(&sb, &STRING_FROM_ZERO_TERMINATED(",\"ts\":"));
+      ProfilerAppendMicroseconds(&sb, beginNanoseconds);
+      StringBuilderAppendString(&sb, &STRING_FROM_ZERO_TERMINATED(",\"dur\":"));
+      ProfilerAppendMicroseconds(&sb, durationNanoseconds);
+      if (thread->counters && thread->counters[eventIndex].mask)
+        ProfilerAppendCounters(&sb, thread->counters + eventIndex, particleCount);
+      StringBuilderAppendString(&sb, &STRING_FROM_ZERO_TERMINATED("}"));
+    }
+  }
+  StringBuilderAppendString(&sb, &STRING_FROM_ZERO_TERMINATED("\n]}\n"));
+
+  b8 isWritten = StringBuilderFlushToSink(&sb);
+  close(fd);
+  return isWritten;
+}
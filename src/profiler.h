@@ -0,0 +1,265 @@
+#pragma once
+
+#include "compiler.h"
+#include "type.h"
+#include <SDL3/SDL.h>
+#include <string.h> // strcmp()
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h> // __rdtsc()
+#endif
+#if defined(__linux__)
+#include <unistd.h> // read()
+#endif
+
+/*
+ * Frame profiler
+ *   Timed blocks are written into a ring per thread, so threads never wait
+ *   for each other. Timestamps are cpu ticks, platform converts them to time
+ *   when it exports them as Chrome trace event JSON, which chrome://tracing
+ *   and https://ui.perfetto.dev open.
+ *
+ *   PROFILE_BEGIN(Physics);
+ *   ...
+ *   PROFILE_END(Physics);
+ *
+ * Blocks compile to nothing unless IS_PROFILER_ENABLED, which is on in debug
+ * builds, or in release builds with ./build.sh --enable-profiler.
+ *
+ * Game and platform are different libraries in debug builds, every library
+ * sets globalProfiler from game_memory.
+ *
+ * Hardware counters
+ *   Optionally platform opens perf_event_open counters on thread that runs
+ *   game, see ProfilerOpenCounters(). Then its blocks also record how many
+ *   cycles, instructions, L1D misses, LLC misses and branch misses they took.
+ *   Counters are read with a syscall at both ends of block, which costs about
+ *   a microsecond, so they suit blocks that run few times per frame. Other
+ *   threads never read counters.
+ */
+
+#ifndef IS_PROFILER_ENABLED
+#define IS_PROFILER_ENABLED IS_BUILD_DEBUG
+#endif
+
+#define PROFILER_THREAD_MAX 16
+#define PROFILER_EVENT_COUNT (1 << 14) // per thread, must be power of 2
+#define PROFILER_MEMORY_SIZE                                                                                    \
+  (sizeof(profiler_event) * PROFILER_THREAD_MAX * PROFILER_EVENT_COUNT +                                      \
+   sizeof(profiler_counters) * PROFILER_EVENT_COUNT)
+
+typedef enum {
+  PROFILER_COUNTER_CYCLES,
+  PROFILER_COUNTER_INSTRUCTIONS,
+  PROFILER_COUNTER_L1D_MISSES,
+  PROFILER_COUNTER_LLC_MISSES,
+  PROFILER_COUNTER_BRANCH_MISSES,
+  PROFILER_COUNTER_COUNT,
+} profiler_counter;
+
+typedef struct {
+  u32 mask; // bit per profiler_counter, 0 when block has no counters
+  u64 values[PROFILER_COUNTER_COUNT];
+} profiler_counters;
+
+typedef struct {
+  const char *name; // must live as long as event does
+  u64 beginTick;
+  u64 endTick;
+} profiler_event;
+
+typedef struct {
+  SDL_ThreadID threadId;
+  profiler_event *events;
+  profiler_counters *counters; // parallel to events, 0 when thread is not counted
+  u32 writeIndex;              // only owner thread writes, total events ever written
+} profiler_thread;
+
+/* State at beginning of timed block. */
+typedef struct {
+  u64 tick;
+  profiler_counters counters;
+} profiler_block;
+
+struct profiler {
+  profiler_event *eventMemory; // PROFILER_THREAD_MAX * PROFILER_EVENT_COUNT
+  SDL_AtomicInt threadCount;
+  profiler_thread threads[PROFILER_THREAD_MAX];
+
+  // perf_event_open group, counted thread gets counterMemory as its ring
+  s32 counterFd;
+  u32 counterMask; // bit per profiler_counter that is open, 0 when counters are off
+  SDL_ThreadID counterThreadId;
+  profiler_counters *counterMemory; // PROFILER_EVENT_COUNT
+
+  // first calibration point, ticks are converted to nanoseconds since then
+  u64 startTick;
+  u64 startNanoseconds;
+};
+
+static profiler *globalProfiler;
+// 0 until thread records its first event in this library
+static __thread profiler_thread *globalProfilerThread;
+
+static inline u64
+ProfilerTick(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+  return __rdtsc();
+#else
+  return SDL_GetPerformanceCounter();
+#endif
+}
+
+/* @return 0 when profiler has no room for another thread */
+static profiler_thread *
+ProfilerGetThread(profiler *profiler)
+{
+  SDL_ThreadID threadId = SDL_GetCurrentThreadID();
+
+  // thread may have a ring from other library, only this thread adds its ring
+  s32 threadCount = SDL_GetAtomicInt(&profiler->threadCount);
+  if (threadCount > PROFILER_THREAD_MAX)
+    threadCount = PROFILER_THREAD_MAX;
+  for (s32 threadIndex = 0; threadIndex < threadCount; threadIndex++) {
+    profiler_thread *thread = profiler->threads + threadIndex;
+    b8 isReady = thread->events != 0;
+    SDL_MemoryBarrierAcquire();
+    if (isReady && thread->threadId == threadId)
+      return thread;
+  }
+
+  s32 threadIndex = SDL_AddAtomicInt(&profiler->threadCount, 1);
+  if (threadIndex >= PROFILER_THREAD_MAX)
+    return 0;
+
+  profiler_thread *thread = profiler->threads + threadIndex;
+  thread->threadId = threadId;
+  thread->counters = profiler->counterMask && threadId == profiler->counterThreadId ? profiler->counterMemory : 0;
+  thread->writeIndex = 0;
+  // ring must be visible with its owner before exporter reads it
+  SDL_MemoryBarrierRelease();
+  thread->events = profiler->eventMemory + (u64)threadIndex * PROFILER_EVENT_COUNT;
+  return thread;
+}
+
+/*
+ * Reads open counters of group into values, in profiler_counter order.
+ * @return 0 when counters cannot be read
+ */
+static b8
+ProfilerReadCounters(profiler *profiler, profiler_counters *counters)
+{
+#if defined(__linux__)
+  // PERF_FORMAT_GROUP layout: count of counters, then values in order they were opened
+  u64 group[1 + PROFILER_COUNTER_COUNT];
+  ssize_t readSize = read(profiler->counterFd, group, sizeof(group));
+  if (unlikely(readSize < (ssize_t)sizeof(u64)))
+    return 0;
+
+  u32 groupIndex = 1;
+  for (u32 counter = 0; counter < PROFILER_COUNTER_COUNT; counter++) {
+    counters->values[counter] = 0;
+    if ((profiler->counterMask & (1u << counter)) && groupIndex <= group[0])
+      counters->values[counter] = group[groupIndex++];
+  }
+  counters->mask = profiler->counterMask;
+  return 1;
+#else
+  (void)profiler;
+  (void)counters;
+  return 0;
+#endif
+}
+
+static inline profiler_block
+ProfilerBegin(void)
+{
+  profiler_block block;
+  block.counters.mask = 0;
+  profiler_thread *thread = globalProfilerThread;
+  // first block of thread has no ring yet, so it is not counted
+  if (unlikely(thread && thread->counters))
+    ProfilerReadCounters(globalProfiler, &block.counters);
+  block.tick = ProfilerTick();
+  return block;
+}
+
+static inline void
+ProfilerRecord(const char *name, profiler_block *begin)
+{
+  u64 endTick = ProfilerTick();
+  profiler *profiler = globalProfiler;
+  if (unlikely(!profiler))
+    return;
+
+  profiler_thread *thread = globalProfilerThread;
+  if (unlikely(!thread)) {
+    thread = ProfilerGetThread(profiler);
+    if (!thread)
+      return;
+    globalProfilerThread = thread;
+  }
+
+  // oldest event is overwritten when ring is full
+  u32 writeIndex = thread->writeIndex;
+  u32 eventIndex = writeIndex & (PROFILER_EVENT_COUNT - 1);
+  thread->events[eventIndex] = (profiler_event){
+      .name = name,
+      .beginTick = begin->tick,
+      .endTick = endTick,
+  };
+  if (unlikely(thread->counters)) {
+    profiler_counters *counters = thread->counters + eventIndex;
+    counters->mask = 0;
+    if (begin->counters.mask && ProfilerReadCounters(profiler, counters)) {
+      for (u32 counter = 0; counter < PROFILER_COUNTER_COUNT; counter++)
+        counters->values[counter] -= begin->counters.values[counter];
+    }
+  }
+  SDL_MemoryBarrierRelease();
+  thread->writeIndex = writeIndex + 1;
+}
+
+/*
+ * Finds counters of latest block with name on counted thread.
+ * Only looks at last blocks, enough for blocks that run every frame.
+ * @return 0 when there are no counters for name
+ */
+static b8
+ProfilerFindCounters(profiler *profiler, const char *name, profiler_counters *counters)
+{
+  comptime u32 SEARCH_COUNT = 256;
+
+  if (!profiler || !profiler->counterMask)
+    return 0;
+
+  s32 threadCount = SDL_GetAtomicInt(&profiler->threadCount);
+  if (threadCount > PROFILER_THREAD_MAX)
+    threadCount = PROFILER_THREAD_MAX;
+  for (s32 threadIndex = 0; threadIndex < threadCount; threadIndex++) {
+    profiler_thread *thread = profiler->threads + threadIndex;
+    if (!thread->counters)
+      continue;
+
+    u32 writeIndex = thread->writeIndex;
+    SDL_MemoryBarrierAcquire();
+    u32 eventCount = writeIndex < SEARCH_COUNT ? writeIndex : SEARCH_COUNT;
+    for (u32 readIndex = writeIndex; readIndex != writeIndex - eventCount; readIndex--) {
+      u32 eventIndex = (readIndex - 1) & (PROFILER_EVENT_COUNT - 1);
+      if (strcmp(thread->events[eventIndex].name, name) != 0)
+        continue;
+      *counters = thread->counters[eventIndex];
+      return counters->mask != 0;
+    }
+  }
+  return 0;
+}
+
+#if IS_PROFILER_ENABLED
+#define PROFILE_BEGIN(name) profiler_block profileBegin##name = ProfilerBegin()
+#define PROFILE_END(name) ProfilerRecord(#name, &profileBegin##name)
+#else
+#define PROFILE_BEGIN(name)
+#define PROFILE_END(name)
+#endif
@@ -0,0 +1,216 @@
+#include "histogram.h"
+#include "profiler.h"
+#include <fcntl.h>  // open()
+#include <unistd.h> // close()
+
+/*
+ * Percentiles of frame time and of every timed block, for the whole run.
+ * Frame times are nanoseconds, blocks are profiler ticks until they are
+ * reported, so calibration of ticks gets better as run goes.
+ *
+ *   ProfilerStatsInit(&profilerStats, &arena);
+ *   for (;;) {
+ *     // collects timed blocks that finished since last call
+ *     ProfilerStatsRecord(&profilerStats, frameTimeInNanoseconds, profiler);
+ *   }
+ *   ProfilerStatsWriteSummary(&profilerStats, profiler, STDOUT_FILENO);
+ *   ProfilerStatsWriteCsv(&profilerStats, profiler, "histogram.csv");
+ *
+ * Blocks are only collected in builds with profiler.
+ */
+
+#define PROFILER_STATS_SECTION_MAX 32
+#define PROFILER_STATS_NAME_MAX 32
+#define PROFILER_STATS_MEMORY_SIZE                                                                                     \
+  (IS_PROFILER_ENABLED ? sizeof(profiler_stats_section) * PROFILER_STATS_SECTION_MAX : 0)
+
+typedef struct {
+  char name[PROFILER_STATS_NAME_MAX]; // copy, names of blocks are gone when game library is reloaded
+  histogram ticks;
+} profiler_stats_section;
+
+typedef struct {
+  histogram frameTimes;               // unit: ns
+  profiler_stats_section *sections;   // PROFILER_STATS_SECTION_MAX, 0 without profiler
+  u32 sectionCount;                   // blocks with more names are not counted
+  u32 readIndex[PROFILER_THREAD_MAX]; // events of profiler thread that are already counted
+} profiler_stats;
+
+static void
+ProfilerStatsInit(profiler_stats *profilerStats, memory_arena *arena)
+{
+  HistogramReset(&profilerStats->frameTimes);
+  profilerStats->sections = 0;
+  if (PROFILER_STATS_MEMORY_SIZE > 0)
+    profilerStats->sections = MemoryArenaPush(arena, PROFILER_STATS_MEMORY_SIZE, 8);
+  profilerStats->sectionCount = 0;
+  for (u32 threadIndex = 0; threadIndex < PROFILER_THREAD_MAX; threadIndex++)
+    profilerStats->readIndex[threadIndex] = 0;
+}
+
+/* @return section of block name, 0 when there is no room for another one */
+static profiler_stats_section *
+ProfilerStatsGetSection(profiler_stats *profilerStats, const char *name)
+{
+  for (u32 sectionIndex = 0; sectionIndex < profilerStats->sectionCount; sectionIndex++) {
+    profiler_stats_section *section = profilerStats->sections + sectionIndex;
+    if (strncmp(section->name, name, PROFILER_STATS_NAME_MAX - 1) == 0)
+      return section;
+  }
+
+  if (profilerStats->sectionCount == PROFILER_STATS_SECTION_MAX)
+    return 0;
+
+  profiler_stats_section *section = profilerStats->sections + profilerStats->sectionCount++;
+  u32 nameLength = 0;
+  for (; nameLength < PROFILER_STATS_NAME_MAX - 1 && name[nameLength]; nameLength++)
+    section->name[nameLength] = name[nameLength];
+  section->name[nameLength] = 0;
+  HistogramReset(&section->ticks);
+  return section;
+}
+
+/*
+ * Records frame time and every timed block that finished since last call.
+ * Must be called between frames, when no timed block is running.
+ */
+static void
+ProfilerStatsRecord(profiler_stats *profilerStats, u64 frameTimeInNanoseconds, profiler *profiler)
+{
+  HistogramRecord(&profilerStats->frameTimes, frameTimeInNanoseconds);
+  if (!profiler || !profilerStats->sections)
+    return;
+
+  s32 threadCount = Minimum(SDL_GetAtomicInt(&profiler->threadCount), PROFILER_THREAD_MAX);
+  for (s32 threadIndex = 0; threadIndex < threadCount; threadIndex++) {
+    profiler_thread *thread = profiler->threads + threadIndex;
+    if (!thread->events)
+      continue;
+
+    u32 writeIndex = thread->writeIndex;
+    SDL_MemoryBarrierAcquire();
+    // ring was cleared or overwritten, start from oldest event it still has
+    u32 readIndex = profilerStats->readIndex[threadIndex];
+    if (writeIndex - readIndex > PROFILER_EVENT_COUNT)
+      readIndex = writeIndex - Minimum(writeIndex, PROFILER_EVENT_COUNT);
+    for (; readIndex != writeIndex; readIndex++) {
+      profiler_event *event = thread->events + (readIndex & (PROFILER_EVENT_COUNT - 1));
+      profiler_stats_section *section = ProfilerStatsGetSection(profilerStats, event->name);
+      if (section)
+        HistogramRecord(&section->ticks, event->endTick - event->beginTick);
+    }
+    profilerStats->readIndex[threadIndex] = writeIndex;
+  }
+}
+
+/* Appends value in microseconds, then spaces until column is width characters wide */
+static void
+ProfilerStatsAppendMicroseconds(string_builder *sb, u64 nanoseconds, u64 width)
+{
+  u64 startedAt = sb->length;
+  StringBuilderAppendF32(sb, (f32)nanoseconds * 1e-3f, 1);
+  while (sb->length < startedAt + width)
+    StringBuilderAppendString(sb, &STRING_FROM_ZERO_TERMINATED(" "));
+}
+
+static void
+ProfilerStatsAppendRow(string_builder *sb, const char *name, histogram *histogram, f64 nanosecondsPerTick)
+{
+  comptime u64 NAME_WIDTH = 24;
+  comptime u64 VALUE_WIDTH = 10;
+  comptime f64 PERCENTILES[] = {50.0, 90.0, 99.0, 99.9};
+
+  u64 startedAt = sb->length;
+  StringBuilderAppendZeroTerminated(sb, name, PROFILER_STATS_NAME_MAX);
+  do
+    StringBuilderAppendString(sb, &STRING_FROM_ZERO_TERMINATED(" "));
+  while (sb->length < startedAt + NAME_WIDTH);
+
+  startedAt = sb->length;
+  StringBuilderAppendU64(sb, histogram->totalCount);
+  while (sb->length < startedAt + VALUE_WIDTH)
+    StringBuilderAppendString(sb, &STRING_FROM_ZERO_TERMINATED(" "));
+
+  for (u32 percentileIndex = 0; percentileIndex < ARRAY_COUNT(PERCENTILES); percentileIndex++) {
+    u64 value = HistogramValueAtPercentile(histogram, PERCENTILES[percentileIndex]);
+    ProfilerStatsAppendMicroseconds(sb, (u64)((f64)value * nanosecondsPerTick), VALUE_WIDTH);
+  }
+  ProfilerStatsAppendMicroseconds(sb, (u64)((f64)histogram->max * nanosecondsPerTick), 0);
+  StringBuilderAppendString(sb, &STRING_FROM_ZERO_TERMINATED("\n"));
+}
+
+/*
+ * Writes percentiles of frame time and of every timed block as a table in
+ * microseconds. Blocks run per frame or per thread, so their counts differ
+ * from frame count.
+ * @return 0 when fd cannot be written
+ */
+static b8
+ProfilerStatsWriteSummary(profiler_stats *profilerStats, profiler *profiler, s32 fd)
+{
+  u8 outBufferBytes[4 * 1024];
+  string_builder sb = {
+      .outBuffer = &(struct string){.value = outBufferBytes, .length = sizeof(outBufferBytes)},
+  };
+  StringBuilderAttachFd(&sb, fd);
+
+  StringBuilderAppendString(&sb, &STRING_FROM_ZERO_TERMINATED("section                 count     p50       p90       "
+                                                               "p99       p99.9     max us\n"));
+  ProfilerStatsAppendRow(&sb, "frame", &profilerStats->frameTimes, 1.0);
+
+  f64 nanosecondsPerTick = profiler ? ProfilerNanosecondsPerTick(profiler) : 0.0;
+  for (u32 sectionIndex = 0; sectionIndex < profilerStats->sectionCount; sectionIndex++) {
+    profiler_stats_section *section = profilerStats->sections + sectionIndex;
+    ProfilerStatsAppendRow(&sb, section->name, &section->ticks, nanosecondsPerTick);
+  }
+
+  return StringBuilderFlushToSink(&sb);
+}
+
+/*
+ * Writes every bucket that has a count as CSV, frame time first, then every
+ * timed block. Bucket bounds are in nanoseconds.
+ *   section,lowest,highest,count
+ * @return 0 when file cannot be written
+ */
+static b8
+ProfilerStatsWriteCsv(profiler_stats *profilerStats, profiler *profiler, const char *path)
+{
+  s32 fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0)
+    return 0;
+
+  u8 outBufferBytes[16 * 1024];
+  string_builder sb = {
+      .outBuffer = &(struct string){.value = outBufferBytes, .length = sizeof(outBufferBytes)},
+  };
+  StringBuilderAttachFd(&sb, fd);
+
+  StringBuilderAppendString(&sb, &STRING_FROM_ZERO_TERMINATED("section,lowest,highest,count\n"));
+  f64 nanosecondsPerTick = profiler ? ProfilerNanosecondsPerTick(profiler) : 0.0;
+  for (u32 sectionIndex = 0; sectionIndex <= profilerStats->sectionCount; sectionIndex++) {
+    // frame time is first section
+    b8 isFrame = sectionIndex == 0;
+    const char *name = isFrame ? "frame" : profilerStats->sections[sectionIndex - 1].name;
+    histogram *histogram = isFrame ? &profilerStats->frameTimes : &profilerStats->sections[sectionIndex - 1].ticks;
+    f64 unitToNanoseconds = isFrame ? 1.0 : nanosecondsPerTick;
+
+    for (u32 index = 0; index < HISTOGRAM_BUCKET_COUNT; index++) {
+      if (histogram->counts[index] == 0)
+        continue;
+
+      StringBuilderAppendZeroTerminated(&sb, name, PROFILER_STATS_NAME_MAX);
+      StringBuilderAppendString(&sb, &STRING_FROM_ZERO_TERMINATED(","));
+      StringBuilderAppendU64(&sb, (u64)((f64)HistogramBucketLowestValue(index) * unitToNanoseconds));
+      StringBuilderAppendString(&sb, &STRING_FROM_ZERO_TERMINATED(","));
+      StringBuilderAppendU64(&sb, (u64)((f64)HistogramBucketHighestValue(index) * unitToNanoseconds));
+      StringBuilderAppendString(&sb, &STRING_FROM_ZERO_TERMINATED(","));
+      StringBuilderAppendU64(&sb, histogram->counts[index]);
+      StringBuilderAppendString(&sb, &STRING_FROM_ZERO_TERMINATED("\n"));
+    }
+  }
+
+  b8 isWritten = StringBuilderFlushToSink(&sb);
+  close(fd);
+  return isWritten;
+}
@@ -1,124 +1,209 @@
 #include "renderer.h"
 
-static inline v2
-ToScreenSpace(game_renderer *gameRenderer, v2 point)
+#if defined(__AVX__)
+#include <immintrin.h>
+#endif
+
+void
+RendererSetCamera(game_renderer *gameRenderer, render_camera camera)
 {
-  v2 xAxis = {1.0f, 0.0f};
-  v2 yAxis = v2_perp(xAxis);
-  v2 origin = gameRenderer->screenCenter;
+  debug_assert(camera.zoom > 0.0f);
+  f32 pixelsPerMeter = PIXELS_PER_METER * camera.zoom;
+
+  /*
+   * world to screen
+   *   1. move camera position to origin
+   *   2. rotate opposite of camera rotation
+   *   3. scale meters to pixels, flip y axis because screen y is pointing down
+   *   4. move origin to screen center
+   */
+  m2x3 view = m2x3_mul(m2x3_rotation(-camera.rotation), m2x3_translation(v2_neg(camera.position)));
+  m2x3 projection =
+      m2x3_mul(m2x3_translation(gameRenderer->screenCenter), m2x3_scale((v2){pixelsPerMeter, -pixelsPerMeter}));
+
+  gameRenderer->camera = camera;
+  gameRenderer->pixelsPerMeter = pixelsPerMeter;
+  gameRenderer->worldToScreen = m2x3_mul(projection, view);
+  gameRenderer->screenToWorld = m2x3_invert(gameRenderer->worldToScreen);
+}
 
-  v2 pointInScreenCoordinate = {
-      v2_dot((v2){point.x, 0.0f}, xAxis),
-      v2_dot((v2){0.0f, -point.y}, yAxis),
+v2
+ScreenToWorld(game_renderer *gameRenderer, v2 pointInScreenSpace)
+{
+  return m2x3_transform(gameRenderer->screenToWorld, pointInScreenSpace);
+}
+
+static inline u32
+ColorPackRGBA8(v4 color)
+{
+  u32 r = (u32)(Clamp(color.r, 0.0f, 1.0f) * 255.0f + 0.5f);
+  u32 g = (u32)(Clamp(color.g, 0.0f, 1.0f) * 255.0f + 0.5f);
+  u32 b = (u32)(Clamp(color.b, 0.0f, 1.0f) * 255.0f + 0.5f);
+  u32 a = (u32)(Clamp(color.a, 0.0f, 1.0f) * 255.0f + 0.5f);
+  return r | (g << 8) | (b << 16) | (a << 24);
+}
+
+static inline SDL_FColor
+ColorUnpackRGBA8(u32 color)
+{
+  const f32 inv255 = 1.0f / 255.0f;
+  return (SDL_FColor){
+      .r = (f32)((color >> 0) & 0xff) * inv255,
+      .g = (f32)((color >> 8) & 0xff) * inv255,
+      .b = (f32)((color >> 16) & 0xff) * inv255,
+      .a = (f32)((color >> 24) & 0xff) * inv255,
   };
-  return v2_add(origin, v2_scale(pointInScreenCoordinate, PIXELS_PER_METER));
+}
+
+static render_command *
+PushRenderCommand(game_renderer *gameRenderer, render_command_type type, v4 color)
+{
+  memory_arena *memory = &gameRenderer->memory;
+  if (memory->used + sizeof(render_command) > memory->total) {
+    debug_assert(0 && "renderer memory is full");
+    return 0;
+  }
+
+  // commands are pushed back to back, so they form an array
+  render_command *command = MemoryArenaPushUnaligned(memory, sizeof(*command));
+  if (gameRenderer->commandCount == 0)
+    gameRenderer->commands = command;
+  debug_assert(command == gameRenderer->commands + gameRenderer->commandCount && "renderer memory used while recording");
+  gameRenderer->commandCount++;
+
+  command->type = (u8)type;
+  command->layer = (u8)gameRenderer->layer;
+  command->color = ColorPackRGBA8(color);
+  return command;
 }
 
 void
-RenderFrame(game_renderer *gameRenderer)
+RendererSetLayer(game_renderer *gameRenderer, render_layer layer)
 {
-  SDL_RenderPresent(gameRenderer->renderer);
+  debug_assert(layer < RENDER_LAYER_COUNT);
+  gameRenderer->layer = layer;
 }
 
 void
 ClearScreen(game_renderer *gameRenderer, v4 color)
 {
-  SDL_Renderer *renderer = gameRenderer->renderer;
-  SDL_SetRenderDrawColorFloat(renderer, color.r, color.g, color.b, color.a);
-  SDL_RenderClear(renderer);
+  gameRenderer->clearColor = color;
 }
 
 void
 DrawLine(game_renderer *gameRenderer, v2 point1, v2 point2, v4 color, f32 width)
 {
-  SDL_Renderer *renderer = gameRenderer->renderer;
-  SDL_SetRenderDrawColorFloat(renderer, color.r, color.g, color.b, color.a);
+  render_command *command = PushRenderCommand(gameRenderer, RENDER_COMMAND_TYPE_LINE, color);
+  if (!command)
+    return;
+
+  command->line.from = point1;
+  command->line.to = point2;
+  command->line.width = width;
+}
 
-  v2 point1InScreenSpace = ToScreenSpace(gameRenderer, point1);
-  v2 point2InScreenSpace = ToScreenSpace(gameRenderer, point2);
-  f32 widthInPixel = width * PIXELS_PER_METER;
-  SDL_RenderLine(renderer, point1InScreenSpace.x, point1InScreenSpace.y, point2InScreenSpace.x, point2InScreenSpace.y);
+/*
+ * Offset from joint to outer corner of miter, in direction of normal of both
+ * segments.
+ *   t = normalize(n₀ + n₁)
+ *   length = w / (t · n₁)
+ * @return 0 if miter is longer than limit
+ */
+static b8
+PolylineMiter(v2 normal0, v2 normal1, f32 halfWidth, v2 *offset)
+{
+  v2 tangent = v2_normalize(v2_add(normal0, normal1));
+  f32 cosine = v2_dot(tangent, normal1);
+  if (cosine * RENDER_MITER_LIMIT < 1.0f)
+    return 0;
+
+  *offset = v2_scale(tangent, halfWidth / cosine);
+  return 1;
 }
 
 void
-DrawCircle(game_renderer *gameRenderer, v2 position, f32 radius, v4 color)
+DrawPolyline(game_renderer *gameRenderer, v2 *points, u32 pointCount, v4 color, f32 width, render_line_join join)
 {
-  __cleanup_memory_temp__ memory_temp memory = MemoryTempBegin(&gameRenderer->memory);
+  if (pointCount < 2)
+    return;
 
-  u32 pointMax = 1000; // TODO: find maxiumum points needed from radius
-  u32 pointCount = 0;
-  SDL_FPoint *points = MemoryArenaPush(memory.arena, sizeof(*points) * pointMax, 4);
-
-#if 0
-  // TODO: radius <= 0.2f causes artifacts
-  f32 radiusInPixels = radius * PIXELS_PER_METER;
-  v2 positionInScreenSpace = ToScreenSpace(gameRenderer, position);
-  v2 offset = {0.0f, radiusInPixels};
-  f32 d = (radius - 1) * PIXELS_PER_METER;
-
-  while (offset.y >= offset.x) {
-    SDL_FPoint p[] = {
-        {positionInScreenSpace.x - offset.y, positionInScreenSpace.y + offset.x},
-        {positionInScreenSpace.x + offset.y, positionInScreenSpace.y + offset.x},
-        {positionInScreenSpace.x - offset.x, positionInScreenSpace.y + offset.y},
-        {positionInScreenSpace.x + offset.x, positionInScreenSpace.y + offset.y},
-        {positionInScreenSpace.x - offset.x, positionInScreenSpace.y - offset.y},
-        {positionInScreenSpace.x + offset.x, positionInScreenSpace.y - offset.y},
-        {positionInScreenSpace.x - offset.y, positionInScreenSpace.y - offset.x},
-        {positionInScreenSpace.x + offset.y, positionInScreenSpace.y - offset.x},
-    };
-    memcpy(points + pointCount, p, ARRAY_COUNT(p) * sizeof(*p));
-    pointCount += ARRAY_COUNT(p);
-    debug_assert(pointCount <= pointMax);
-
-    if (d >= 2.0f * offset.x) {
-      d -= 2.0f * offset.x + 1.0f;
-      offset.x += 1;
-    } else if (d < 2.0f * (radiusInPixels - offset.y)) {
-      d += 2.0f * offset.y - 1.0f;
-      offset.y -= 1;
-    } else {
-      d += 2.0f * (offset.y - offset.x - 1.0f);
-      offset.y -= 1;
-      offset.x += 1;
+  // thin lines do not need joins
+  f32 pixelsPerUnit = gameRenderer->layer == RENDER_LAYER_SCREEN ? 1.0f : gameRenderer->pixelsPerMeter;
+  b8 isThin = width * pixelsPerUnit <= 1.0f;
+  if (isThin || join == RENDER_LINE_JOIN_ROUND) {
+    for (u32 pointIndex = 0; pointIndex + 1 < pointCount; pointIndex++) {
+      DrawLine(gameRenderer, points[pointIndex], points[pointIndex + 1], color, width);
+      if (!isThin && pointIndex > 0)
+        DrawFilledCircle(gameRenderer, points[pointIndex], width * 0.5f, color);
     }
+    return;
   }
-#else
-  f32 radiusInPixels = radius * PIXELS_PER_METER;
-  v2 positionInScreenSpace = ToScreenSpace(gameRenderer, position);
-
-  // see:
-  // - http://members.chello.at/~easyfilter/Bresenham.pdf
-  // - https://www.youtube.com/watch?v=CceepU1vIKo "NoBS Code - Bresenham's Line Algorithm - Demystified Step by Step"
-  // - https://www.youtube.com/watch?v=y_SPO_b-WXk "UofM Introduction to Computer Graphics - COMP 3490 - (Unit 3)
-  // Drawing Primitives 2: Bresenham's Line Algorithm"
-  // - https://www.youtube.com/watch?v=hpiILbMkF9w "NoBS Code - The Midpoint Circle Algorithm Explained Step by Step"
-
-  f32 x = -radiusInPixels, y = 0.0f, err = 2.0f - 2.0f * radiusInPixels; // bottom left to top right
-  do {
-    SDL_FPoint p[] = {
-        {positionInScreenSpace.x - x, positionInScreenSpace.y + y}, /*   I. Quadrant +x +y */
-        {positionInScreenSpace.x - y, positionInScreenSpace.y - x}, /*  II. Quadrant -x +y */
-        {positionInScreenSpace.x + x, positionInScreenSpace.y - y}, /* III. Quadrant -x -y */
-        {positionInScreenSpace.x + y, positionInScreenSpace.y + x}, /*  IV. Quadrant +x -y */
-    };
-    memcpy(points + pointCount, p, ARRAY_COUNT(p) * sizeof(*p));
-    pointCount += ARRAY_COUNT(p);
-    debug_assert(pointCount <= pointMax);
-
-    radiusInPixels = err;
-    if (radiusInPixels <= y)
-      err += ++y * 2.0f + 1.0f;        /* e_xy+e_y < 0 */
-    if (radiusInPixels > x || err > y) /* e_xy+e_x > 0 or no 2nd y-step */
-      err += ++x * 2.0f + 1.0f;        /* -> x-step now */
-    radiusInPixels = err;
-  } while (x < 0.0f);
-#endif
-  debug_assert(pointCount != 0);
 
-  SDL_Renderer *renderer = gameRenderer->renderer;
-  SDL_SetRenderDrawColorFloat(renderer, color.r, color.g, color.b, color.a);
-  SDL_RenderLines(renderer, points, (s32)pointCount);
+  /*
+   * Every segment is a quad. Segments share miter corners at joints, so
+   * there is no gap or overlap between them.
+   */
+  f32 halfWidth = width * 0.5f;
+  v2 normal = v2_normalize(v2_perp(v2_sub(points[1], points[0])));
+  debug_assert(normal.x != 0.0f || normal.y != 0.0f);
+  v2 startOffset = v2_scale(normal, halfWidth);
+
+  for (u32 pointIndex = 0; pointIndex + 1 < pointCount; pointIndex++) {
+    v2 from = points[pointIndex];
+    v2 to = points[pointIndex + 1];
+
+    v2 endOffset = v2_scale(normal, halfWidth);
+    v2 nextStartOffset = endOffset;
+    v2 nextNormal = normal;
+    b8 isLast = pointIndex + 2 == pointCount;
+    if (!isLast) {
+      nextNormal = v2_normalize(v2_perp(v2_sub(points[pointIndex + 2], to)));
+      debug_assert(nextNormal.x != 0.0f || nextNormal.y != 0.0f);
+
+      v2 miterOffset;
+      if (PolylineMiter(normal, nextNormal, halfWidth, &miterOffset)) {
+        endOffset = miterOffset;
+        nextStartOffset = miterOffset;
+      } else {
+        // too sharp, fill gap with round join
+        nextStartOffset = v2_scale(nextNormal, halfWidth);
+        DrawFilledCircle(gameRenderer, to, halfWidth, color);
+      }
+    }
+
+    render_command *command = PushRenderCommand(gameRenderer, RENDER_COMMAND_TYPE_QUAD, color);
+    if (!command)
+      return;
+    command->quad.corners[0] = v2_add(from, startOffset);
+    command->quad.corners[1] = v2_add(to, endOffset);
+    command->quad.corners[2] = v2_sub(to, endOffset);
+    command->quad.corners[3] = v2_sub(from, startOffset);
+
+    normal = nextNormal;
+    startOffset = nextStartOffset;
+  }
+}
+
+void
+DrawCircle(game_renderer *gameRenderer, v2 position, f32 radius, v4 color)
+{
+  render_command *command = PushRenderCommand(gameRenderer, RENDER_COMMAND_TYPE_CIRCLE, color);
+  if (!command)
+    return;
+
+  command->circle.center = position;
+  command->circle.radius = radius;
+}
+
+void
+DrawFilledCircle(game_renderer *gameRenderer, v2 position, f32 radius, v4 color)
+{
+  render_command *command = PushRenderCommand(gameRenderer, RENDER_COMMAND_TYPE_CIRCLE_FILLED, color);
+  if (!command)
+    return;
+
+  command->circle.center = position;
+  command->circle.radius = radius;
 }
 
 void
@@ -126,36 +211,54 @@ DrawRect(game_renderer *gameRenderer, rect rect, v4 color)
 {
   debug_assert(rect.min.x != rect.max.x && rect.min.y != rect.max.y && "invalid rect");
 
-  v2 leftBottom = ToScreenSpace(gameRenderer, rect.min);
-  v2 dim = v2_scale(RectGetDim(rect), PIXELS_PER_METER);
-  v2 leftTop = v2_add(leftBottom, (v2){0.0f, -dim.y});
-
-  SDL_FRect sdlRect = {
-      .x = leftTop.x,
-      .y = leftTop.y,
-      .w = dim.x,
-      .h = dim.y,
-  };
+  render_command *command = PushRenderCommand(gameRenderer, RENDER_COMMAND_TYPE_RECT, color);
+  if (!command)
+    return;
 
-  SDL_Renderer *renderer = gameRenderer->renderer;
-  SDL_SetRenderDrawColorFloat(renderer, color.r, color.g, color.b, color.a);
-  SDL_RenderFillRect(renderer, &sdlRect);
+  command->rect = rect;
 }
 
 void
 DrawCrosshair(game_renderer *gameRenderer, v2 position, f32 dim, v4 color)
 {
-  f32 dimInPixels = dim * 0.5f * PIXELS_PER_METER;
-  f32 radiusInPixels = dimInPixels * 0.5f;
-  v2 center = ToScreenSpace(gameRenderer, position);
+  render_command *command = PushRenderCommand(gameRenderer, RENDER_COMMAND_TYPE_CROSSHAIR, color);
+  if (!command)
+    return;
 
-  SDL_FRect rects[] = {
-      {.x = center.x - radiusInPixels, .w = dimInPixels, .y = center.y - 0.5f, .h = 1.0f},
-      {.x = center.x - 0.5f, .w = 1.0f, .y = center.y - radiusInPixels, .h = dimInPixels},
-  };
-  SDL_Renderer *renderer = gameRenderer->renderer;
-  SDL_SetRenderDrawColorFloat(renderer, color.r, color.g, color.b, color.a);
-  SDL_RenderFillRects(renderer, rects, ARRAY_COUNT(rects));
+  command->crosshair.center = position;
+  command->crosshair.dim = dim;
+}
+
+void
+DrawText(game_renderer *gameRenderer, struct string *text, v2 position, f32 scale, v4 color)
+{
+  render_layer layer = gameRenderer->layer;
+  gameRenderer->layer = RENDER_LAYER_SCREEN;
+
+  f32 advance = FONT_GLYPH_SIZE * scale;
+  v2 pen = position;
+  for (u64 index = 0; index < text->length; index++) {
+    u8 character = text->value[index];
+    if (character == '\n') {
+      pen = (v2){position.x, pen.y + advance};
+      continue;
+    }
+
+    if (character != ' ') {
+      if (character < FONT_GLYPH_FIRST || character > FONT_GLYPH_LAST)
+        character = '?';
+
+      render_command *command = PushRenderCommand(gameRenderer, RENDER_COMMAND_TYPE_GLYPH, color);
+      if (!command)
+        break;
+      command->glyph.min = pen;
+      command->glyph.scale = scale;
+      command->glyph.index = (u8)(character - FONT_GLYPH_FIRST);
+    }
+    pen.x += advance;
+  }
+
+  gameRenderer->layer = layer;
 }
 
 rect
@@ -167,3 +270,1009 @@ RendererGetSurfaceRect(game_renderer *renderer)
       .max = screenCenterInMeters,         // right top
   };
 }
+
+/*****************************************************************
+ * CULL
+ *****************************************************************/
+
+/* World space bounding box of what camera sees, camera can be rotated */
+static rect
+RendererGetViewRect(game_renderer *gameRenderer)
+{
+  v2 screenSize = v2_scale(gameRenderer->screenCenter, 2.0f);
+  v2 corners[4] = {
+      {0.0f, 0.0f},
+      {screenSize.x, 0.0f},
+      {0.0f, screenSize.y},
+      screenSize,
+  };
+  m2x3_transform_array(gameRenderer->screenToWorld, corners, corners, ARRAY_COUNT(corners));
+
+  rect view = {corners[0], corners[0]};
+  for (u32 cornerIndex = 1; cornerIndex < ARRAY_COUNT(corners); cornerIndex++) {
+    view.min = (v2){Minimum(view.min.x, corners[cornerIndex].x), Minimum(view.min.y, corners[cornerIndex].y)};
+    view.max = (v2){Maximum(view.max.x, corners[cornerIndex].x), Maximum(view.max.y, corners[cornerIndex].y)};
+  }
+
+  // primitives are at least 1 pixel big, and may be rounded to next pixel
+  f32 margin = 2.0f / gameRenderer->pixelsPerMeter;
+  view.min = v2_sub(view.min, (v2){margin, margin});
+  view.max = v2_add(view.max, (v2){margin, margin});
+  return view;
+}
+
+/*
+ * Writes indices of commands whose bounding box overlaps with view.
+ * Bounding boxes are computed into separate arrays, so overlap test can be
+ * done for 8 commands at once.
+ * @return number of visible commands
+ */
+static u32
+RenderCull(game_renderer *gameRenderer, u32 *visibleIndices)
+{
+  render_command *commands = gameRenderer->commands;
+  u32 commandCount = gameRenderer->commandCount;
+  __cleanup_memory_temp__ memory_temp memory = MemoryTempBegin(&gameRenderer->memory);
+
+  // round up to 8, padding is never visible
+  u32 paddedCount = (commandCount + 7) & ~7u;
+  f32 *minX = MemoryArenaPush(memory.arena, sizeof(f32) * paddedCount, 32);
+  f32 *minY = MemoryArenaPush(memory.arena, sizeof(f32) * paddedCount, 32);
+  f32 *maxX = MemoryArenaPush(memory.arena, sizeof(f32) * paddedCount, 32);
+  f32 *maxY = MemoryArenaPush(memory.arena, sizeof(f32) * paddedCount, 32);
+
+  for (u32 commandIndex = 0; commandIndex < commandCount; commandIndex++) {
+    render_command *command = commands + commandIndex;
+    rect box;
+    if (command->layer == RENDER_LAYER_SCREEN) {
+      // screen layer is not seen through camera, it is always visible
+      box = (rect){{F32_LOWEST, F32_LOWEST}, {F32_MAX, F32_MAX}};
+    } else {
+      switch (command->type) {
+      case RENDER_COMMAND_TYPE_RECT: {
+        box = command->rect;
+      } break;
+      case RENDER_COMMAND_TYPE_LINE: {
+        v2 from = command->line.from;
+        v2 to = command->line.to;
+        f32 halfWidth = command->line.width * 0.5f;
+        box.min = (v2){Minimum(from.x, to.x) - halfWidth, Minimum(from.y, to.y) - halfWidth};
+        box.max = (v2){Maximum(from.x, to.x) + halfWidth, Maximum(from.y, to.y) + halfWidth};
+      } break;
+      case RENDER_COMMAND_TYPE_QUAD: {
+        v2 *corners = command->quad.corners;
+        box = (rect){corners[0], corners[0]};
+        for (u32 cornerIndex = 1; cornerIndex < ARRAY_COUNT(command->quad.corners); cornerIndex++) {
+          box.min = (v2){Minimum(box.min.x, corners[cornerIndex].x), Minimum(box.min.y, corners[cornerIndex].y)};
+          box.max = (v2){Maximum(box.max.x, corners[cornerIndex].x), Maximum(box.max.y, corners[cornerIndex].y)};
+        }
+      } break;
+      case RENDER_COMMAND_TYPE_CIRCLE_FILLED:
+      case RENDER_COMMAND_TYPE_CIRCLE: {
+        v2 radius = {command->circle.radius, command->circle.radius};
+        box.min = v2_sub(command->circle.center, radius);
+        box.max = v2_add(command->circle.center, radius);
+      } break;
+      case RENDER_COMMAND_TYPE_CROSSHAIR: {
+        // crosshair is half of dim wide
+        f32 halfDim = command->crosshair.dim * 0.25f;
+        box.min = v2_sub(command->crosshair.center, (v2){halfDim, halfDim});
+        box.max = v2_add(command->crosshair.center, (v2){halfDim, halfDim});
+      } break;
+      default: {
+        debug_assert(0 && "unknown render command");
+        box = (rect){};
+      } break;
+      }
+    }
+
+    minX[commandIndex] = box.min.x;
+    minY[commandIndex] = box.min.y;
+    maxX[commandIndex] = box.max.x;
+    maxY[commandIndex] = box.max.y;
+  }
+
+  // empty box that is never visible
+  for (u32 commandIndex = commandCount; commandIndex < paddedCount; commandIndex++) {
+    minX[commandIndex] = minY[commandIndex] = F32_MAX;
+    maxX[commandIndex] = maxY[commandIndex] = F32_LOWEST;
+  }
+
+  rect view = RendererGetViewRect(gameRenderer);
+  u32 visibleCount = 0;
+
+#if defined(__AVX__)
+  __m256 viewMinX = _mm256_set1_ps(view.min.x);
+  __m256 viewMinY = _mm256_set1_ps(view.min.y);
+  __m256 viewMaxX = _mm256_set1_ps(view.max.x);
+  __m256 viewMaxY = _mm256_set1_ps(view.max.y);
+  for (u32 commandIndex = 0; commandIndex < paddedCount; commandIndex += 8) {
+    // overlaps when box.max >= view.min and box.min <= view.max on both axis
+    __m256 overlapX = _mm256_and_ps(_mm256_cmp_ps(_mm256_load_ps(maxX + commandIndex), viewMinX, _CMP_GE_OQ),
+                                    _mm256_cmp_ps(_mm256_load_ps(minX + commandIndex), viewMaxX, _CMP_LE_OQ));
+    __m256 overlapY = _mm256_and_ps(_mm256_cmp_ps(_mm256_load_ps(maxY + commandIndex), viewMinY, _CMP_GE_OQ),
+                                    _mm256_cmp_ps(_mm256_load_ps(minY + commandIndex), viewMaxY, _CMP_LE_OQ));
+    u32 mask = (u32)_mm256_movemask_ps(_mm256_and_ps(overlapX, overlapY));
+
+    while (mask) {
+      u32 lane = (u32)__builtin_ctz(mask);
+      visibleIndices[visibleCount++] = commandIndex + lane;
+      mask &= mask - 1;
+    }
+  }
+#else
+  for (u32 commandIndex = 0; commandIndex < commandCount; commandIndex++) {
+    b8 isVisible = maxX[commandIndex] >= view.min.x && minX[commandIndex] <= view.max.x &&
+                   maxY[commandIndex] >= view.min.y && minY[commandIndex] <= view.max.y;
+    if (isVisible)
+      visibleIndices[visibleCount++] = commandIndex;
+  }
+#endif
+
+  debug_assert(visibleCount <= commandCount);
+  return visibleCount;
+}
+
+/*****************************************************************
+ * SORT
+ *****************************************************************/
+
+typedef struct {
+  u64 key;
+  u32 index; // index of command
+} render_sort_entry;
+
+/* Layer and type share one byte, so they are sorted in one radix pass */
+#define RENDER_SORT_TYPE_BITS 4
+
+static inline u64
+RenderCommandSortKey(render_command *command)
+{
+  // | layer 4 bits | type 4 bits | color 32 bits |
+  u64 layerAndType = ((u64)command->layer << RENDER_SORT_TYPE_BITS) | (u64)command->type;
+  return (layerAndType << 32) | (u64)command->color;
+}
+
+/*
+ * Commands that have same batch key are submitted together.
+ * Filled circles and glyphs carry color in vertices, so every color of a layer
+ * is one batch.
+ */
+static inline u64
+RenderBatchKey(u64 sortKey)
+{
+  u64 layerAndType = sortKey >> 32;
+  u64 type = layerAndType & ((1 << RENDER_SORT_TYPE_BITS) - 1);
+  if (type == RENDER_COMMAND_TYPE_CIRCLE_FILLED || type == RENDER_COMMAND_TYPE_GLYPH)
+    return layerAndType << 32;
+  return sortKey;
+}
+
+/*
+ * Least significant digit radix sort, 8 bits at a time.
+ * Sort is stable, commands that have same key are drawn in order they are
+ * recorded.
+ * @param entries to be sorted
+ * @param temp must be able to hold count entries
+ * @param keyBits how many bits of key is used
+ */
+static void
+RenderSortEntries(render_sort_entry *entries, render_sort_entry *temp, u32 count, u32 keyBits)
+{
+  render_sort_entry *src = entries;
+  render_sort_entry *dest = temp;
+
+  for (u32 shift = 0; shift < keyBits; shift += 8) {
+    u32 offsets[256] = {};
+    for (u32 index = 0; index < count; index++) {
+      u32 digit = (u32)(src[index].key >> shift) & 0xff;
+      offsets[digit]++;
+    }
+
+    // skip pass when every entry has same digit
+    u32 firstDigit = count > 0 ? (u32)(src[0].key >> shift) & 0xff : 0;
+    if (offsets[firstDigit] == count)
+      continue;
+
+    // count to offset
+    u32 total = 0;
+    for (u32 digit = 0; digit < ARRAY_COUNT(offsets); digit++) {
+      u32 digitCount = offsets[digit];
+      offsets[digit] = total;
+      total += digitCount;
+    }
+
+    for (u32 index = 0; index < count; index++) {
+      u32 digit = (u32)(src[index].key >> shift) & 0xff;
+      dest[offsets[digit]++] = src[index];
+    }
+
+    render_sort_entry *swap = src;
+    src = dest;
+    dest = swap;
+  }
+
+  if (src != entries)
+    memcpy(entries, src, sizeof(*entries) * count);
+}
+
+/*****************************************************************
+ * SUBMIT
+ *****************************************************************/
+
+typedef struct {
+  game_renderer *gameRenderer;
+  render_command *commands;
+  render_sort_entry *entries; // sorted entries of one batch
+  u32 count;
+  SDL_FColor color;
+
+  // of batch's layer
+  m2x3 toScreen;
+  f32 pixelsPerUnit;
+} render_batch;
+
+static inline void
+RenderBatchSetColor(render_batch *batch)
+{
+  SDL_Renderer *renderer = batch->gameRenderer->renderer;
+  SDL_FColor color = batch->color;
+  SDL_SetRenderDrawColorFloat(renderer, color.r, color.g, color.b, color.a);
+}
+
+typedef struct {
+  SDL_Renderer *renderer;
+  SDL_Texture *texture;
+  render_stats *stats;
+
+  SDL_Vertex *vertices;
+  u32 vertexCount;
+  u32 vertexMax;
+
+  s32 *indices;
+  u32 indexCount;
+  u32 indexMax;
+} render_geometry;
+
+/*
+ * Reserves room for vertices and at most 3 indices for every vertex.
+ * Filled circle has n+1 vertices and 3n indices, quad has 4 vertices and 6 indices.
+ * @param size in bytes, 0 means all remaining memory in arena
+ */
+static render_geometry
+RenderGeometryBegin(game_renderer *gameRenderer, memory_arena *arena, SDL_Texture *texture, u64 size)
+{
+  render_geometry geometry = {
+      .renderer = gameRenderer->renderer,
+      .texture = texture,
+      .stats = &gameRenderer->stats,
+  };
+
+  u64 bytesPerVertex = sizeof(*geometry.vertices) + 3 * sizeof(*geometry.indices);
+  u64 remaining = arena->total - arena->used;
+  if (size == 0 || size > remaining)
+    size = remaining;
+  u32 vertexMax = (u32)(size > 8 ? (size - 8) / bytesPerVertex : 0);
+
+  geometry.vertices = MemoryArenaPush(arena, sizeof(*geometry.vertices) * vertexMax, 4);
+  geometry.vertexMax = vertexMax;
+  geometry.indices = MemoryArenaPush(arena, sizeof(*geometry.indices) * vertexMax * 3, 4);
+  geometry.indexMax = vertexMax * 3;
+  return geometry;
+}
+
+static void
+RenderGeometryFlush(render_geometry *geometry)
+{
+  if (geometry->indexCount == 0)
+    return;
+
+  SDL_RenderGeometry(geometry->renderer, geometry->texture, geometry->vertices, (s32)geometry->vertexCount, geometry->indices,
+                     (s32)geometry->indexCount);
+  geometry->stats->drawCallCount++;
+  geometry->vertexCount = 0;
+  geometry->indexCount = 0;
+}
+
+/*
+ * Makes sure there is enough room for vertices and indices, flushes when it
+ * is full.
+ * @return index of first vertex, or -1 if it can never fit
+ */
+static s32
+RenderGeometryReserve(render_geometry *geometry, u32 vertexCount, u32 indexCount)
+{
+  if (vertexCount > geometry->vertexMax || indexCount > geometry->indexMax) {
+    debug_assert(0 && "geometry is too big for renderer memory");
+    return -1;
+  }
+
+  if (geometry->vertexCount + vertexCount > geometry->vertexMax ||
+      geometry->indexCount + indexCount > geometry->indexMax)
+    RenderGeometryFlush(geometry);
+
+  return (s32)geometry->vertexCount;
+}
+
+typedef struct {
+  SDL_Renderer *renderer;
+  render_stats *stats;
+
+  SDL_FPoint *points;
+  u32 count;
+  u32 max;
+} render_points;
+
+/* Draw color must be set before points are flushed */
+static render_points
+RenderPointsBegin(game_renderer *gameRenderer, memory_arena *arena, u32 max)
+{
+  return (render_points){
+      .renderer = gameRenderer->renderer,
+      .stats = &gameRenderer->stats,
+      .points = MemoryArenaPush(arena, sizeof(SDL_FPoint) * max, 4),
+      .max = max,
+  };
+}
+
+static void
+RenderPointsFlush(render_points *points)
+{
+  if (points->count == 0)
+    return;
+
+  SDL_RenderPoints(points->renderer, points->points, (s32)points->count);
+  points->stats->drawCallCount++;
+  points->count = 0;
+}
+
+static inline SDL_FPoint *
+RenderPointsReserve(render_points *points, u32 count)
+{
+  debug_assert(count <= points->max);
+  if (points->count + count > points->max)
+    RenderPointsFlush(points);
+
+  SDL_FPoint *result = points->points + points->count;
+  points->count += count;
+  return result;
+}
+
+/* Writes quad as 2 triangles, corners must be in order around quad */
+static void
+RenderGeometryPushQuad(render_geometry *geometry, v2 corners[4], SDL_FColor color)
+{
+  s32 first = RenderGeometryReserve(geometry, 4, 6);
+  if (first < 0)
+    return;
+
+  SDL_Vertex *vertex = geometry->vertices + geometry->vertexCount;
+  for (u32 cornerIndex = 0; cornerIndex < 4; cornerIndex++)
+    vertex[cornerIndex] = (SDL_Vertex){.position = {corners[cornerIndex].x, corners[cornerIndex].y}, .color = color};
+
+  s32 *index = geometry->indices + geometry->indexCount;
+  index[0] = first + 0;
+  index[1] = first + 1;
+  index[2] = first + 2;
+  index[3] = first + 0;
+  index[4] = first + 2;
+  index[5] = first + 3;
+
+  geometry->vertexCount += 4;
+  geometry->indexCount += 6;
+}
+
+/* Draws rects and quads, camera can be rotated so rects are quads too */
+static void
+RenderQuads(render_batch *batch)
+{
+  game_renderer *gameRenderer = batch->gameRenderer;
+  __cleanup_memory_temp__ memory_temp memory = MemoryTempBegin(&gameRenderer->memory);
+
+  u32 cornerCount = batch->count * 4;
+  v2 *corners = MemoryArenaPush(memory.arena, sizeof(*corners) * cornerCount, 4);
+  for (u32 entryIndex = 0; entryIndex < batch->count; entryIndex++) {
+    render_command *command = batch->commands + batch->entries[entryIndex].index;
+    v2 *corner = corners + entryIndex * 4;
+    if (command->type == RENDER_COMMAND_TYPE_RECT) {
+      rect rect = command->rect;
+      corner[0] = rect.min;                     // left bottom
+      corner[1] = (v2){rect.max.x, rect.min.y}; // right bottom
+      corner[2] = rect.max;                     // right top
+      corner[3] = (v2){rect.min.x, rect.max.y}; // left top
+    } else {
+      debug_assert(command->type == RENDER_COMMAND_TYPE_QUAD);
+      memcpy(corner, command->quad.corners, sizeof(command->quad.corners));
+    }
+  }
+  m2x3_transform_array(batch->toScreen, corners, corners, cornerCount);
+
+  render_geometry geometry = RenderGeometryBegin(gameRenderer, memory.arena, 0, 0);
+  for (u32 quadIndex = 0; quadIndex < batch->count; quadIndex++)
+    RenderGeometryPushQuad(&geometry, corners + quadIndex * 4, batch->color);
+  RenderGeometryFlush(&geometry);
+}
+
+/*
+ * Lines are expanded into quads in screen space, so they are at least 1 pixel
+ * wide at every zoom level.
+ */
+static void
+RenderLines(render_batch *batch)
+{
+  game_renderer *gameRenderer = batch->gameRenderer;
+  __cleanup_memory_temp__ memory_temp memory = MemoryTempBegin(&gameRenderer->memory);
+
+  u32 pointCount = batch->count * 2;
+  v2 *points = MemoryArenaPush(memory.arena, sizeof(*points) * pointCount, 4);
+  for (u32 entryIndex = 0; entryIndex < batch->count; entryIndex++) {
+    render_command *command = batch->commands + batch->entries[entryIndex].index;
+    points[entryIndex * 2 + 0] = command->line.from;
+    points[entryIndex * 2 + 1] = command->line.to;
+  }
+  m2x3_transform_array(batch->toScreen, points, points, pointCount);
+
+  render_geometry geometry = RenderGeometryBegin(gameRenderer, memory.arena, 0, 0);
+  for (u32 lineIndex = 0; lineIndex < batch->count; lineIndex++) {
+    render_command *command = batch->commands + batch->entries[lineIndex].index;
+    v2 from = points[lineIndex * 2 + 0];
+    v2 to = points[lineIndex * 2 + 1];
+
+    f32 widthInPixels = command->line.width * batch->pixelsPerUnit;
+    if (widthInPixels < 1.0f)
+      widthInPixels = 1.0f;
+
+    v2 direction = v2_sub(to, from);
+    f32 length = v2_length(direction);
+    if (length == 0.0f)
+      continue;
+
+    v2 normal = v2_scale(v2_perp(direction), widthInPixels * 0.5f / length);
+    v2 corners[4] = {
+        v2_add(from, normal),
+        v2_add(to, normal),
+        v2_sub(to, normal),
+        v2_sub(from, normal),
+    };
+    RenderGeometryPushQuad(&geometry, corners, batch->color);
+  }
+  RenderGeometryFlush(&geometry);
+}
+
+static void
+CircleLodTableInit(circle_lod_table *table)
+{
+  v2 *point = table->points;
+  for (u32 lod = 0; lod < CIRCLE_LOD_COUNT; lod++) {
+    u32 segmentCount = CIRCLE_SEGMENT_MIN << lod;
+    f32 step = 2.0f * PI / (f32)segmentCount;
+
+    table->rings[lod] = point;
+    for (u32 segmentIndex = 0; segmentIndex < segmentCount; segmentIndex++) {
+      f32 radians = step * (f32)segmentIndex;
+      *point++ = (v2){Cos(radians), Sin(radians)};
+    }
+  }
+  debug_assert(point == table->points + ARRAY_COUNT(table->points));
+
+  table->isInitialized = 1;
+}
+
+/*
+ * Picks LOD from radius in pixels.
+ * Distance between polygon edge and circle is r (1 - cos(π / n)). Every LOD
+ * doubles segments, that divides error by ~4, so it can cover 4 times bigger
+ * radius.
+ */
+static inline u32
+CircleLodFromRadius(f32 radiusInPixels)
+{
+  u32 lod = 0;
+  f32 radiusMax = 4.0f;
+  while (lod < CIRCLE_LOD_COUNT - 1 && radiusInPixels >= radiusMax) {
+    lod++;
+    radiusMax *= 4.0f;
+  }
+  return lod;
+}
+
+static void
+CircleAtlasInit(game_renderer *gameRenderer, circle_atlas *atlas)
+{
+  // radius grows by ~1.5x, a circle is never scaled up more than 1.5x
+  comptime u32 SPRITE_RADII[CIRCLE_SPRITE_COUNT] = {2, 3, 4, 6, 8, 12, 16, 24, 32, 48, 64};
+  // transparent pixel around every sprite, so linear filtering does not bleed
+  comptime u32 PADDING = 1;
+
+  atlas->isInitialized = 1;
+
+  // sprites are placed side by side in one row
+  u32 width = 0;
+  u32 height = 0;
+  for (u32 spriteIndex = 0; spriteIndex < CIRCLE_SPRITE_COUNT; spriteIndex++) {
+    u32 size = 2 * (SPRITE_RADII[spriteIndex] + PADDING);
+    width += size;
+    if (height < size)
+      height = size;
+  }
+
+  __cleanup_memory_temp__ memory_temp memory = MemoryTempBegin(&gameRenderer->memory);
+  u32 *pixels = MemoryArenaPush(memory.arena, sizeof(*pixels) * width * height, 4);
+  memset(pixels, 0, sizeof(*pixels) * width * height);
+
+  u32 x = 0;
+  for (u32 spriteIndex = 0; spriteIndex < CIRCLE_SPRITE_COUNT; spriteIndex++) {
+    u32 radius = SPRITE_RADII[spriteIndex];
+    u32 size = 2 * (radius + PADDING);
+    f32 halfSize = (f32)size * 0.5f;
+
+    for (u32 pixelY = 0; pixelY < size; pixelY++) {
+      for (u32 pixelX = 0; pixelX < size; pixelX++) {
+        // coverage ≈ how much of pixel is inside, r + ½ - distance of pixel center
+        v2 offset = {(f32)pixelX + 0.5f - halfSize, (f32)pixelY + 0.5f - halfSize};
+        f32 coverage = Clamp((f32)radius + 0.5f - v2_length(offset), 0.0f, 1.0f);
+        u32 alpha = (u32)(coverage * 255.0f + 0.5f);
+        pixels[pixelY * width + x + pixelX] = 0x00ffffff | (alpha << 24);
+      }
+    }
+
+    atlas->sprites[spriteIndex] = (circle_sprite){
+        .radius = (f32)radius,
+        .halfSize = halfSize,
+        .uvMin = {(f32)x / (f32)width, 0.0f},
+        .uvMax = {(f32)(x + size) / (f32)width, (f32)size / (f32)height},
+    };
+    x += size;
+  }
+
+  SDL_Renderer *renderer = gameRenderer->renderer;
+  SDL_Texture *texture =
+      SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA32, SDL_TEXTUREACCESS_STATIC, (s32)width, (s32)height);
+  if (!texture)
+    return;
+
+  if (!SDL_UpdateTexture(texture, 0, pixels, (s32)(width * sizeof(*pixels))) ||
+      !SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND) ||
+      !SDL_SetTextureScaleMode(texture, SDL_SCALEMODE_LINEAR)) {
+    SDL_DestroyTexture(texture);
+    return;
+  }
+
+  atlas->texture = texture;
+}
+
+/* @return sprite that can draw circle, 0 if circle is bigger than every sprite */
+static inline circle_sprite *
+CircleAtlasFindSprite(circle_atlas *atlas, f32 radiusInPixels)
+{
+  for (u32 spriteIndex = 0; spriteIndex < CIRCLE_SPRITE_COUNT; spriteIndex++) {
+    circle_sprite *sprite = atlas->sprites + spriteIndex;
+    if (radiusInPixels <= sprite->radius)
+      return sprite;
+  }
+  return 0;
+}
+
+/* Writes triangle fan of circle, vertex 0 is center, 1..n are on ring */
+static void
+RenderGeometryPushCircleFan(render_geometry *geometry, v2 center, f32 radiusInPixels, v2 *ring, u32 segmentCount,
+                            SDL_FColor color)
+{
+  s32 first = RenderGeometryReserve(geometry, 1 + segmentCount, 3 * segmentCount);
+  if (first < 0)
+    return;
+
+  SDL_Vertex *vertex = geometry->vertices + geometry->vertexCount;
+  vertex[0] = (SDL_Vertex){.position = {center.x, center.y}, .color = color};
+  for (u32 segmentIndex = 0; segmentIndex < segmentCount; segmentIndex++) {
+    v2 point = v2_add(center, v2_scale(ring[segmentIndex], radiusInPixels));
+    vertex[1 + segmentIndex] = (SDL_Vertex){.position = {point.x, point.y}, .color = color};
+  }
+
+  // triangle i is (0, i+1, i+2)
+  s32 *index = geometry->indices + geometry->indexCount;
+  for (u32 segmentIndex = 0; segmentIndex < segmentCount; segmentIndex++) {
+    u32 nextIndex = segmentIndex + 1 == segmentCount ? 0 : segmentIndex + 1;
+    index[0] = first;
+    index[1] = first + 1 + (s32)segmentIndex;
+    index[2] = first + 1 + (s32)nextIndex;
+    index += 3;
+  }
+
+  geometry->vertexCount += 1 + segmentCount;
+  geometry->indexCount += 3 * segmentCount;
+}
+
+/*
+ * Filled circles of every color are one batch.
+ *   tiny circles: points, one SDL_RenderPoints() for every color
+ *   others:       textured quads from atlas, one SDL_RenderGeometry() for all
+ *   huge circles: triangle fans
+ */
+static void
+RenderFilledCircles(render_batch *batch)
+{
+  game_renderer *gameRenderer = batch->gameRenderer;
+  circle_lod_table *lods = &gameRenderer->circleLods;
+  if (!lods->isInitialized)
+    CircleLodTableInit(lods);
+  circle_atlas *atlas = &gameRenderer->circleAtlas;
+  if (!atlas->isInitialized)
+    CircleAtlasInit(gameRenderer, atlas);
+
+  __cleanup_memory_temp__ memory_temp memory = MemoryTempBegin(&gameRenderer->memory);
+
+  v2 *centers = MemoryArenaPush(memory.arena, sizeof(*centers) * batch->count, 4);
+  for (u32 entryIndex = 0; entryIndex < batch->count; entryIndex++) {
+    render_command *command = batch->commands + batch->entries[entryIndex].index;
+    centers[entryIndex] = command->circle.center;
+  }
+  m2x3_transform_array(batch->toScreen, centers, centers, batch->count);
+
+  u32 pointMax = batch->count < 1 << 16 ? batch->count : 1 << 16;
+  render_points points = RenderPointsBegin(gameRenderer, memory.arena, pointMax);
+  u64 fanSize = (memory.arena->total - memory.arena->used) / 4;
+  render_geometry fans = RenderGeometryBegin(gameRenderer, memory.arena, 0, fanSize);
+  render_geometry quads = RenderGeometryBegin(gameRenderer, memory.arena, atlas->texture, 0);
+
+  u32 pointColor = 0;
+  for (u32 entryIndex = 0; entryIndex < batch->count; entryIndex++) {
+    render_command *command = batch->commands + batch->entries[entryIndex].index;
+    f32 radiusInPixels = command->circle.radius * batch->pixelsPerUnit;
+    v2 center = centers[entryIndex];
+    SDL_FColor color = ColorUnpackRGBA8(command->color);
+
+    if (radiusInPixels < CIRCLE_POINT_RADIUS_MAX) {
+      // entries are sorted by color, so points change color only few times
+      if (points.count == 0 || pointColor != command->color) {
+        RenderPointsFlush(&points);
+        pointColor = command->color;
+        SDL_SetRenderDrawColorFloat(gameRenderer->renderer, color.r, color.g, color.b, color.a);
+      }
+      SDL_FPoint *point = RenderPointsReserve(&points, 1);
+      *point = (SDL_FPoint){center.x, center.y};
+      continue;
+    }
+
+    circle_sprite *sprite = atlas->texture ? CircleAtlasFindSprite(atlas, radiusInPixels) : 0;
+    if (sprite) {
+      s32 first = RenderGeometryReserve(&quads, 4, 6);
+      if (first < 0)
+        continue;
+
+      // sprite is scaled down to radius
+      f32 halfSize = sprite->halfSize * radiusInPixels / sprite->radius;
+      v2 min = v2_sub(center, (v2){halfSize, halfSize});
+      v2 max = v2_add(center, (v2){halfSize, halfSize});
+      SDL_Vertex *vertex = quads.vertices + quads.vertexCount;
+      vertex[0] = (SDL_Vertex){{min.x, min.y}, color, {sprite->uvMin.x, sprite->uvMin.y}};
+      vertex[1] = (SDL_Vertex){{max.x, min.y}, color, {sprite->uvMax.x, sprite->uvMin.y}};
+      vertex[2] = (SDL_Vertex){{max.x, max.y}, color, {sprite->uvMax.x, sprite->uvMax.y}};
+      vertex[3] = (SDL_Vertex){{min.x, max.y}, color, {sprite->uvMin.x, sprite->uvMax.y}};
+
+      s32 *index = quads.indices + quads.indexCount;
+      index[0] = first + 0;
+      index[1] = first + 1;
+      index[2] = first + 2;
+      index[3] = first + 0;
+      index[4] = first + 2;
+      index[5] = first + 3;
+
+      quads.vertexCount += 4;
+      quads.indexCount += 6;
+      continue;
+    }
+
+    u32 lod = CircleLodFromRadius(radiusInPixels);
+    RenderGeometryPushCircleFan(&fans, center, radiusInPixels, lods->rings[lod], CIRCLE_SEGMENT_MIN << lod, color);
+  }
+
+  RenderPointsFlush(&points);
+  RenderGeometryFlush(&fans);
+  RenderGeometryFlush(&quads);
+}
+
+/* Draws 1 pixel wide rings of quads */
+static void
+RenderCircleOutlines(render_batch *batch)
+{
+  game_renderer *gameRenderer = batch->gameRenderer;
+  circle_lod_table *lods = &gameRenderer->circleLods;
+  if (!lods->isInitialized)
+    CircleLodTableInit(lods);
+
+  __cleanup_memory_temp__ memory_temp memory = MemoryTempBegin(&gameRenderer->memory);
+
+  v2 *centers = MemoryArenaPush(memory.arena, sizeof(*centers) * batch->count, 4);
+  for (u32 entryIndex = 0; entryIndex < batch->count; entryIndex++) {
+    render_command *command = batch->commands + batch->entries[entryIndex].index;
+    centers[entryIndex] = command->circle.center;
+  }
+  m2x3_transform_array(batch->toScreen, centers, centers, batch->count);
+
+  // circles in batch are submitted together, early only when buffer is full
+  RenderBatchSetColor(batch);
+  render_points points = RenderPointsBegin(gameRenderer, memory.arena, batch->count);
+  render_geometry geometry = RenderGeometryBegin(gameRenderer, memory.arena, 0, 0);
+  SDL_FColor color = batch->color;
+
+  for (u32 entryIndex = 0; entryIndex < batch->count; entryIndex++) {
+    render_command *command = batch->commands + batch->entries[entryIndex].index;
+    f32 radiusInPixels = command->circle.radius * batch->pixelsPerUnit;
+    v2 center = centers[entryIndex];
+
+    if (radiusInPixels < CIRCLE_POINT_RADIUS_MAX) {
+      SDL_FPoint *point = RenderPointsReserve(&points, 1);
+      *point = (SDL_FPoint){center.x, center.y};
+      continue;
+    }
+
+    u32 lod = CircleLodFromRadius(radiusInPixels);
+    u32 segmentCount = CIRCLE_SEGMENT_MIN << lod;
+    v2 *ring = lods->rings[lod];
+
+    // vertex 2i is on outer ring, 2i+1 is on inner ring
+    s32 first = RenderGeometryReserve(&geometry, 2 * segmentCount, 6 * segmentCount);
+    if (first < 0)
+      continue;
+
+    f32 innerRadiusInPixels = radiusInPixels - 1.0f;
+    SDL_Vertex *vertex = geometry.vertices + geometry.vertexCount;
+    for (u32 segmentIndex = 0; segmentIndex < segmentCount; segmentIndex++) {
+      v2 outer = v2_add(center, v2_scale(ring[segmentIndex], radiusInPixels));
+      v2 inner = v2_add(center, v2_scale(ring[segmentIndex], innerRadiusInPixels));
+      vertex[2 * segmentIndex + 0] = (SDL_Vertex){.position = {outer.x, outer.y}, .color = color};
+      vertex[2 * segmentIndex + 1] = (SDL_Vertex){.position = {inner.x, inner.y}, .color = color};
+    }
+
+    s32 *index = geometry.indices + geometry.indexCount;
+    for (u32 segmentIndex = 0; segmentIndex < segmentCount; segmentIndex++) {
+      u32 nextIndex = segmentIndex + 1 == segmentCount ? 0 : segmentIndex + 1;
+      s32 outer = first + 2 * (s32)segmentIndex;
+      s32 inner = outer + 1;
+      s32 nextOuter = first + 2 * (s32)nextIndex;
+      s32 nextInner = nextOuter + 1;
+      index[0] = outer;
+      index[1] = nextOuter;
+      index[2] = nextInner;
+      index[3] = outer;
+      index[4] = nextInner;
+      index[5] = inner;
+      index += 6;
+    }
+
+    geometry.vertexCount += 2 * segmentCount;
+    geometry.indexCount += 6 * segmentCount;
+  }
+
+  RenderPointsFlush(&points);
+  RenderGeometryFlush(&geometry);
+}
+
+static void
+RenderCrosshairs(render_batch *batch)
+{
+  game_renderer *gameRenderer = batch->gameRenderer;
+  __cleanup_memory_temp__ memory_temp memory = MemoryTempBegin(&gameRenderer->memory);
+
+  v2 *centers = MemoryArenaPush(memory.arena, sizeof(*centers) * batch->count, 4);
+  for (u32 entryIndex = 0; entryIndex < batch->count; entryIndex++) {
+    render_command *command = batch->commands + batch->entries[entryIndex].index;
+    centers[entryIndex] = command->crosshair.center;
+  }
+  m2x3_transform_array(batch->toScreen, centers, centers, batch->count);
+
+  u32 rectCount = batch->count * 2;
+  SDL_FRect *rects = MemoryArenaPush(memory.arena, sizeof(*rects) * rectCount, 4);
+  for (u32 entryIndex = 0; entryIndex < batch->count; entryIndex++) {
+    render_command *command = batch->commands + batch->entries[entryIndex].index;
+    f32 dimInPixels = command->crosshair.dim * 0.5f * batch->pixelsPerUnit;
+    f32 radiusInPixels = dimInPixels * 0.5f;
+    v2 center = centers[entryIndex];
+
+    rects[entryIndex * 2 + 0] =
+        (SDL_FRect){.x = center.x - radiusInPixels, .w = dimInPixels, .y = center.y - 0.5f, .h = 1.0f};
+    rects[entryIndex * 2 + 1] =
+        (SDL_FRect){.x = center.x - 0.5f, .w = 1.0f, .y = center.y - radiusInPixels, .h = dimInPixels};
+  }
+
+  RenderBatchSetColor(batch);
+  SDL_RenderFillRects(gameRenderer->renderer, rects, (s32)rectCount);
+  gameRenderer->stats.drawCallCount++;
+}
+
+static void
+GlyphAtlasInit(game_renderer *gameRenderer, glyph_atlas *atlas)
+{
+  atlas->isInitialized = 1;
+
+  u32 width = GLYPH_ATLAS_COLUMN_COUNT * FONT_GLYPH_SIZE;
+  u32 height = GLYPH_ATLAS_ROW_COUNT * FONT_GLYPH_SIZE;
+  __cleanup_memory_temp__ memory_temp memory = MemoryTempBegin(&gameRenderer->memory);
+  u32 *pixels = MemoryArenaPush(memory.arena, sizeof(*pixels) * width * height, 4);
+  memset(pixels, 0, sizeof(*pixels) * width * height);
+
+  for (u32 glyphIndex = 0; glyphIndex < FONT_GLYPH_COUNT; glyphIndex++) {
+    u32 x = (glyphIndex % GLYPH_ATLAS_COLUMN_COUNT) * FONT_GLYPH_SIZE;
+    u32 y = (glyphIndex / GLYPH_ATLAS_COLUMN_COUNT) * FONT_GLYPH_SIZE;
+    const u8 *rows = FONT_GLYPHS[glyphIndex];
+    for (u32 pixelY = 0; pixelY < FONT_GLYPH_SIZE; pixelY++) {
+      for (u32 pixelX = 0; pixelX < FONT_GLYPH_SIZE; pixelX++) {
+        if ((rows[pixelY] >> pixelX) & 1)
+          pixels[(y + pixelY) * width + x + pixelX] = 0xffffffff;
+      }
+    }
+  }
+
+  SDL_Renderer *renderer = gameRenderer->renderer;
+  SDL_Texture *texture =
+      SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA32, SDL_TEXTUREACCESS_STATIC, (s32)width, (s32)height);
+  if (!texture)
+    return;
+
+  if (!SDL_UpdateTexture(texture, 0, pixels, (s32)(width * sizeof(*pixels))) ||
+      !SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND) ||
+      !SDL_SetTextureScaleMode(texture, SDL_SCALEMODE_NEAREST)) {
+    SDL_DestroyTexture(texture);
+    return;
+  }
+
+  atlas->texture = texture;
+}
+
+/* Glyphs of every color are one batch, one SDL_RenderGeometry() draws them all */
+static void
+RenderGlyphs(render_batch *batch)
+{
+  game_renderer *gameRenderer = batch->gameRenderer;
+  glyph_atlas *atlas = &gameRenderer->glyphAtlas;
+  if (!atlas->isInitialized)
+    GlyphAtlasInit(gameRenderer, atlas);
+  if (!atlas->texture)
+    return;
+
+  __cleanup_memory_temp__ memory_temp memory = MemoryTempBegin(&gameRenderer->memory);
+  render_geometry geometry = RenderGeometryBegin(gameRenderer, memory.arena, atlas->texture, 0);
+
+  const f32 glyphU = 1.0f / GLYPH_ATLAS_COLUMN_COUNT;
+  const f32 glyphV = 1.0f / GLYPH_ATLAS_ROW_COUNT;
+  for (u32 entryIndex = 0; entryIndex < batch->count; entryIndex++) {
+    render_command *command = batch->commands + batch->entries[entryIndex].index;
+    s32 first = RenderGeometryReserve(&geometry, 4, 6);
+    if (first < 0)
+      continue;
+
+    u32 glyphIndex = command->glyph.index;
+    v2 uvMin = {(f32)(glyphIndex % GLYPH_ATLAS_COLUMN_COUNT) * glyphU,
+                (f32)(glyphIndex / GLYPH_ATLAS_COLUMN_COUNT) * glyphV};
+    v2 uvMax = {uvMin.x + glyphU, uvMin.y + glyphV};
+    v2 min = m2x3_transform(batch->toScreen, command->glyph.min);
+    v2 max = v2_add(min, (v2){FONT_GLYPH_SIZE * command->glyph.scale, FONT_GLYPH_SIZE * command->glyph.scale});
+    SDL_FColor color = ColorUnpackRGBA8(command->color);
+
+    SDL_Vertex *vertex = geometry.vertices + geometry.vertexCount;
+    vertex[0] = (SDL_Vertex){{min.x, min.y}, color, {uvMin.x, uvMin.y}};
+    vertex[1] = (SDL_Vertex){{max.x, min.y}, color, {uvMax.x, uvMin.y}};
+    vertex[2] = (SDL_Vertex){{max.x, max.y}, color, {uvMax.x, uvMax.y}};
+    vertex[3] = (SDL_Vertex){{min.x, max.y}, color, {uvMin.x, uvMax.y}};
+
+    s32 *index = geometry.indices + geometry.indexCount;
+    index[0] = first + 0;
+    index[1] = first + 1;
+    index[2] = first + 2;
+    index[3] = first + 0;
+    index[4] = first + 2;
+    index[5] = first + 3;
+
+    geometry.vertexCount += 4;
+    geometry.indexCount += 6;
+  }
+  RenderGeometryFlush(&geometry);
+}
+
+#include "renderer_software.c"
+
+void
+RenderFrame(game_renderer *gameRenderer)
+{
+  memory_arena *memory = &gameRenderer->memory;
+  render_command *commands = gameRenderer->commands;
+  u32 commandCount = gameRenderer->commandCount;
+
+  gameRenderer->stats = (render_stats){
+      .commandCount = commandCount,
+  };
+
+  if (gameRenderer->backend == RENDER_BACKEND_NULL)
+    commandCount = 0;
+
+  // cull
+  PROFILE_BEGIN(RenderCull);
+  u32 *visibleIndices = MemoryArenaPush(memory, sizeof(*visibleIndices) * commandCount, 4);
+  u32 visibleCount = commandCount > 0 ? RenderCull(gameRenderer, visibleIndices) : 0;
+  gameRenderer->stats.culledCount = commandCount - visibleCount;
+  commandCount = visibleCount;
+  PROFILE_END(RenderCull);
+
+  // sort
+  PROFILE_BEGIN(RenderSort);
+  render_sort_entry *entries = MemoryArenaPush(memory, sizeof(*entries) * commandCount, 8);
+  render_sort_entry *temp = MemoryArenaPush(memory, sizeof(*temp) * commandCount, 8);
+  for (u32 visibleIndex = 0; visibleIndex < commandCount; visibleIndex++) {
+    u32 commandIndex = visibleIndices[visibleIndex];
+    entries[visibleIndex] = (render_sort_entry){
+        .key = RenderCommandSortKey(commands + commandIndex),
+        .index = commandIndex,
+    };
+  }
+  RenderSortEntries(entries, temp, commandCount, 40);
+  PROFILE_END(RenderSort);
+
+  if (gameRenderer->backend == RENDER_BACKEND_SOFTWARE) {
+    // visible indices in draw order
+    for (u32 entryIndex = 0; entryIndex < commandCount; entryIndex++)
+      visibleIndices[entryIndex] = entries[entryIndex].index;
+    SoftwareRenderFrame(gameRenderer, visibleIndices, commandCount);
+  } else if (gameRenderer->backend == RENDER_BACKEND_SDL) {
+    SDL_Renderer *renderer = gameRenderer->renderer;
+    v4 clearColor = gameRenderer->clearColor;
+    SDL_SetRenderDrawColorFloat(renderer, clearColor.r, clearColor.g, clearColor.b, clearColor.a);
+    SDL_RenderClear(renderer);
+
+    // submit runs of same key as one batch
+    for (u32 batchStart = 0; batchStart < commandCount;) {
+      u64 batchKey = RenderBatchKey(entries[batchStart].key);
+      u32 batchEnd = batchStart + 1;
+      while (batchEnd < commandCount && RenderBatchKey(entries[batchEnd].key) == batchKey)
+        batchEnd++;
+
+      render_command *first = commands + entries[batchStart].index;
+      b8 isScreenLayer = first->layer == RENDER_LAYER_SCREEN;
+      render_batch batch = {
+          .gameRenderer = gameRenderer,
+          .commands = commands,
+          .entries = entries + batchStart,
+          .count = batchEnd - batchStart,
+          .color = ColorUnpackRGBA8(first->color),
+          .toScreen = isScreenLayer ? m2x3_identity() : gameRenderer->worldToScreen,
+          .pixelsPerUnit = isScreenLayer ? 1.0f : gameRenderer->pixelsPerMeter,
+      };
+
+      switch (first->type) {
+      case RENDER_COMMAND_TYPE_RECT:
+      case RENDER_COMMAND_TYPE_QUAD: {
+        RenderQuads(&batch);
+      } break;
+      case RENDER_COMMAND_TYPE_LINE: {
+        RenderLines(&batch);
+      } break;
+      case RENDER_COMMAND_TYPE_CIRCLE_FILLED: {
+        RenderFilledCircles(&batch);
+      } break;
+      case RENDER_COMMAND_TYPE_CIRCLE: {
+        RenderCircleOutlines(&batch);
+      } break;
+      case RENDER_COMMAND_TYPE_CROSSHAIR: {
+        RenderCrosshairs(&batch);
+      } break;
+      case RENDER_COMMAND_TYPE_GLYPH: {
+        RenderGlyphs(&batch);
+      } break;
+      default: {
+        debug_assert(0 && "unknown render command");
+      } break;
+      }
+
+      gameRenderer->stats.batchCount++;
+      batchStart = batchEnd;
+    }
+
+    SDL_RenderPresent(renderer);
+  }
+
+  // start next frame with empty memory
+  memory->used = 0;
+  gameRenderer->layer = RENDER_LAYER_WORLD;
+  gameRenderer->commands = 0;
+  gameRenderer->commandCount = 0;
+}
@@ -1,35 +1,260 @@
 #pragma once
 
+#include "font.h"
 #include "math.h"
 #include "memory.h"
+#include "platform.h"
+#include "text.h"
 #include <SDL3/SDL.h>
 
 typedef struct {
-  SDL_Renderer *renderer;
+  v2 position;  // unit: m, world point that is at the center of screen
+  f32 zoom;     // 1 means PIXELS_PER_METER
+  f32 rotation; // unit: radians, counter-clockwise
+} render_camera;
+
+/*
+ * Draw calls do not draw right away, they record commands.
+ * RenderFrame() sorts commands by layer, type then color, and submits each
+ * run of same layer, type and color as one batch.
+ *
+ * Order of layers and types is also the order they are drawn.
+ */
+typedef enum {
+  RENDER_LAYER_WORLD,  // unit: m, y up, seen through camera
+  RENDER_LAYER_SCREEN, // unit: px, y down, origin at top left, drawn over world
+  RENDER_LAYER_COUNT,
+} render_layer;
+
+typedef enum {
+  RENDER_COMMAND_TYPE_RECT,
+  RENDER_COMMAND_TYPE_LINE,
+  RENDER_COMMAND_TYPE_QUAD,
+  RENDER_COMMAND_TYPE_CIRCLE_FILLED,
+  RENDER_COMMAND_TYPE_CIRCLE,
+  RENDER_COMMAND_TYPE_CROSSHAIR,
+  RENDER_COMMAND_TYPE_GLYPH,
+  RENDER_COMMAND_TYPE_COUNT,
+} render_command_type;
+
+typedef struct {
+  u8 type;   // render_command_type
+  u8 layer;  // render_layer
+  u32 color; // RGBA8, r is least significant byte
+  union {
+    struct {
+      v2 from;
+      v2 to;
+      f32 width; // unit: m, 0 means 1 pixel
+    } line;
+    struct {
+      v2 corners[4]; // in order around quad
+    } quad;
+    struct {
+      v2 center;
+      f32 radius;
+    } circle;
+    struct rect rect;
+    struct {
+      v2 center;
+      f32 dim;
+    } crosshair;
+    struct {
+      v2 min;    // top left
+      f32 scale; // glyph is FONT_GLYPH_SIZE * scale pixels
+      u8 index;  // into FONT_GLYPHS
+    } glyph;
+  };
+} render_command;
+
+/*
+ * Software backend counts tiles as batches, and every primitive that is
+ * rasterized in a tile as a draw call.
+ */
+typedef struct {
+  u32 commandCount;
+  u32 culledCount; // commands that are outside of view
+  u32 batchCount;
+  u32 drawCallCount;
+} render_stats;
+
+/*
+ * Circles are drawn as polygons. Number of segments is picked from radius in
+ * pixels, so that polygon is at most ~0.3 pixels away from true circle.
+ *   LOD 0:   8 segments, radius <   4px
+ *   LOD 1:  16 segments, radius <  16px
+ *   LOD 2:  32 segments, radius <  64px
+ *   LOD 3:  64 segments, radius < 256px
+ *   LOD 4: 128 segments
+ */
+#define CIRCLE_LOD_COUNT 5
+#define CIRCLE_SEGMENT_MIN 8
+#define CIRCLE_SEGMENT_MAX (CIRCLE_SEGMENT_MIN << (CIRCLE_LOD_COUNT - 1))
+
+/* Circles that are smaller than this radius are drawn as 1 point */
+#define CIRCLE_POINT_RADIUS_MAX 1.5f
+
+typedef struct {
+  b8 isInitialized;
+  // points on unit circle, counter-clockwise, rings of every LOD back to back
+  v2 *rings[CIRCLE_LOD_COUNT];
+  v2 points[CIRCLE_SEGMENT_MIN * ((1 << CIRCLE_LOD_COUNT) - 1)];
+} circle_lod_table;
+
+/*
+ * Texture of white anti-aliased filled circles at fixed radii. Filled circles
+ * are drawn as textured quads using closest sprite that is not smaller, color
+ * comes from vertices. Circles bigger than biggest sprite use circle_lod_table.
+ */
+#define CIRCLE_SPRITE_COUNT 11
+
+typedef struct {
+  f32 radius;   // unit: px
+  f32 halfSize; // unit: px, of quad that contains circle and padding
+  v2 uvMin;
+  v2 uvMax;
+} circle_sprite;
+
+typedef struct {
+  b8 isInitialized;
+  SDL_Texture *texture; // 0 when it could not be created
+  circle_sprite sprites[CIRCLE_SPRITE_COUNT];
+} circle_atlas;
+
+/*
+ * Texture of every glyph of FONT_GLYPHS in a grid, white where glyph is set.
+ * Glyphs are scaled by whole numbers and sampled with nearest filtering, so
+ * they stay sharp.
+ */
+#define GLYPH_ATLAS_COLUMN_COUNT 16
+#define GLYPH_ATLAS_ROW_COUNT ((FONT_GLYPH_COUNT + GLYPH_ATLAS_COLUMN_COUNT - 1) / GLYPH_ATLAS_COLUMN_COUNT)
+
+typedef struct {
+  b8 isInitialized;
+  SDL_Texture *texture; // 0 when it could not be created
+} glyph_atlas;
+
+typedef enum {
+  RENDER_BACKEND_SDL,      // submits to SDL_Renderer
+  RENDER_BACKEND_SOFTWARE, // rasterizes into framebuffer, does not call SDL
+  RENDER_BACKEND_NULL,     // game records no commands, for measuring simulation alone
+} render_backend;
+
+typedef struct {
+  u32 *pixels; // RGBA8, r is least significant byte
+  u32 width;
+  u32 height;
+  u32 pitch; // unit: pixels
+} render_framebuffer;
+
+typedef struct {
+  render_backend backend;
+  SDL_Renderer *renderer;         // used by RENDER_BACKEND_SDL
+  render_framebuffer framebuffer; // used by RENDER_BACKEND_SOFTWARE, platform presents it
+
+  // optional, when there is no queue software backend uses only calling thread
+  platform_work_queue *workQueue;
+  pfnPlatformAddWorkEntry PlatformAddWorkEntry;
+  pfnPlatformCompleteAllWork PlatformCompleteAllWork;
+
+  /*
+   * Recorded commands are at the beginning of memory, rest is used as scratch
+   * while rendering. Whole memory is reset every frame.
+   */
   memory_arena memory;
   v2 screenCenter;
+
+  v4 clearColor;
+  render_layer layer; // of commands that are recorded, RenderFrame() resets it to world
+  render_command *commands;
+  u32 commandCount;
+  render_stats stats; // of last rendered frame
+
+  // computed from camera by RendererSetCamera()
+  render_camera camera;
+  m2x3 worldToScreen;
+  m2x3 screenToWorld;
+  f32 pixelsPerMeter;
+
+  circle_lod_table circleLods;
+  circle_atlas circleAtlas;
+  glyph_atlas glyphAtlas;
 } game_renderer;
 
 #define PIXELS_PER_METER 60
 #define METERS_PER_PIXEL (1.0f / PIXELS_PER_METER)
 
+/*
+ * Sets camera that is going to be used while drawing.
+ * Precomputes world to screen transform, call it once per frame before drawing.
+ */
+void
+RendererSetCamera(game_renderer *renderer, render_camera camera);
+
+/*
+ * Commands that are recorded after this are in layer's units.
+ *   RendererSetLayer(renderer, RENDER_LAYER_SCREEN);
+ *   DrawRect(renderer, (rect){{8, 8}, {108, 40}}, COLOR_ZINC_950); // pixels
+ */
+void
+RendererSetLayer(game_renderer *renderer, render_layer layer);
+
+/* Converts point in screen space (pixels, y down) to world space (meters, y up) */
+v2
+ScreenToWorld(game_renderer *renderer, v2 pointInScreenSpace);
+
+/*
+ * Submits recorded commands, then presents.
+ * Software backend only draws into framebuffer, platform presents it.
+ */
 void
 RenderFrame(game_renderer *renderer);
 
 void
 ClearScreen(game_renderer *renderer, v4 color);
 
+/* @param width unit: m, lines are at least 1 pixel wide, 0 draws 1 pixel wide line */
 void
 DrawLine(game_renderer *renderer, v2 from, v2 to, v4 color, f32 width);
 
+typedef enum {
+  RENDER_LINE_JOIN_MITER,
+  RENDER_LINE_JOIN_ROUND,
+} render_line_join;
+
+/*
+ * Draws connected lines through points.
+ * Miter joins that are longer than RENDER_MITER_LIMIT times half width are
+ * drawn as round joins.
+ * @param points consecutive points must be different
+ */
+void
+DrawPolyline(game_renderer *renderer, v2 *points, u32 pointCount, v4 color, f32 width, render_line_join join);
+
+#define RENDER_MITER_LIMIT 4.0f
+
+/* Draws 1 pixel wide outline of circle */
 void
 DrawCircle(game_renderer *renderer, v2 position, f32 radius, v4 color);
 
+void
+DrawFilledCircle(game_renderer *renderer, v2 position, f32 radius, v4 color);
+
 void
 DrawRect(game_renderer *renderer, rect rect, v4 color);
 
 void
 DrawCrosshair(game_renderer *renderer, v2 position, f32 dim, v4 color);
 
+/*
+ * Draws text with bitmap font in screen layer, whatever the current layer is.
+ * Every glyph is one command, glyphs of every color are submitted together.
+ * '\n' starts a new line, characters that font does not have are drawn as '?'.
+ * @param position unit: px, top left of first glyph
+ * @param scale glyphs are FONT_GLYPH_SIZE * scale pixels, whole numbers stay sharp
+ */
+void
+DrawText(game_renderer *renderer, struct string *text, v2 position, f32 scale, v4 color);
+
 rect
 RendererGetSurfaceRect(game_renderer *renderer);
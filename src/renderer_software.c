@@ -0,0 +1,542 @@
+#include "renderer.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+/*
+ * Software backend
+ *   1. Commands are converted into screen space primitives.
+ *        quad:   rects, lines, quads and crosshairs, inside of 4 edge functions
+ *        circle: filled and outlined circles, signed distance
+ *        glyph:  bit of font row that pixel falls into
+ *   2. Primitives are binned into tiles of SOFTWARE_TILE_SIZE pixels.
+ *   3. Every tile is cleared and rasterized on its own, in parallel when
+ *      there is a work queue. Tiles do not share pixels, so there is no
+ *      locking.
+ *
+ * Order of primitives in a tile is the order of commands, so overlapping
+ * primitives blend as if they were drawn one after another.
+ */
+
+#define SOFTWARE_TILE_SIZE 64
+
+typedef enum {
+  SOFTWARE_PRIMITIVE_QUAD,
+  SOFTWARE_PRIMITIVE_CIRCLE,
+  SOFTWARE_PRIMITIVE_GLYPH,
+} software_primitive_type;
+
+typedef struct {
+  u8 type; // software_primitive_type
+  u32 color;
+  // unit: px, min inclusive, max exclusive, inside of framebuffer
+  s32 minX;
+  s32 minY;
+  s32 maxX;
+  s32 maxY;
+  union {
+    // pixel is inside when a x + b y + c >= 0 for every edge
+    struct {
+      f32 a[4];
+      f32 b[4];
+      f32 c[4];
+    } quad;
+    // coverage = clamp(outer + ½ - d) clamp(d - inner + ½)
+    struct {
+      v2 center;
+      f32 outerRadius;
+      f32 innerRadius; // negative when filled
+    } circle;
+    // glyph pixel of screen pixel is (p - min) / scale
+    struct {
+      v2 min;
+      f32 invScale;
+      const u8 *rows; // of FONT_GLYPHS
+    } glyph;
+  };
+} software_primitive;
+
+typedef struct {
+  render_framebuffer *framebuffer;
+  software_primitive *primitives;
+  u32 *primitiveIndices; // of primitives in this tile, in draw order
+  u32 primitiveCount;
+  u32 clearColor;
+  s32 minX;
+  s32 minY;
+  s32 maxX;
+  s32 maxY;
+} software_tile;
+
+static inline void
+SoftwarePrimitiveClip(software_primitive *primitive, v2 min, v2 max, render_framebuffer *framebuffer)
+{
+  f32 width = (f32)framebuffer->width;
+  f32 height = (f32)framebuffer->height;
+  primitive->minX = (s32)Clamp(min.x, 0.0f, width);
+  primitive->minY = (s32)Clamp(min.y, 0.0f, height);
+  primitive->maxX = (s32)Clamp(max.x + 1.0f, 0.0f, width);
+  primitive->maxY = (s32)Clamp(max.y + 1.0f, 0.0f, height);
+}
+
+/* @return 0 if quad has no area or it is outside of framebuffer */
+static b8
+SoftwarePrimitiveQuad(software_primitive *primitive, v2 corners[4], u32 color, render_framebuffer *framebuffer)
+{
+  f32 doubleArea = 0.0f;
+  v2 min = corners[0];
+  v2 max = corners[0];
+  for (u32 cornerIndex = 0; cornerIndex < 4; cornerIndex++) {
+    v2 from = corners[cornerIndex];
+    v2 to = corners[(cornerIndex + 1) % 4];
+    doubleArea += from.x * to.y - to.x * from.y;
+    min = (v2){Minimum(min.x, from.x), Minimum(min.y, from.y)};
+    max = (v2){Maximum(max.x, from.x), Maximum(max.y, from.y)};
+  }
+  if (doubleArea == 0.0f)
+    return 0;
+
+  *primitive = (software_primitive){
+      .type = SOFTWARE_PRIMITIVE_QUAD,
+      .color = color,
+  };
+  SoftwarePrimitiveClip(primitive, min, max, framebuffer);
+  if (primitive->minX >= primitive->maxX || primitive->minY >= primitive->maxY)
+    return 0;
+
+  // make inside positive for both windings
+  f32 sign = doubleArea > 0.0f ? 1.0f : -1.0f;
+  for (u32 edgeIndex = 0; edgeIndex < 4; edgeIndex++) {
+    v2 from = corners[edgeIndex];
+    v2 to = corners[(edgeIndex + 1) % 4];
+    v2 edge = v2_sub(to, from);
+    // cross(edge, p - from)
+    primitive->quad.a[edgeIndex] = -edge.y * sign;
+    primitive->quad.b[edgeIndex] = edge.x * sign;
+    primitive->quad.c[edgeIndex] = (edge.y * from.x - edge.x * from.y) * sign;
+  }
+
+  return 1;
+}
+
+/* @return 0 if circle is outside of framebuffer */
+static b8
+SoftwarePrimitiveCircle(software_primitive *primitive, v2 center, f32 radius, b8 isFilled, u32 color,
+                        render_framebuffer *framebuffer)
+{
+  *primitive = (software_primitive){
+      .type = SOFTWARE_PRIMITIVE_CIRCLE,
+      .color = color,
+      .circle =
+          {
+              .center = center,
+              .outerRadius = radius,
+              .innerRadius = isFilled ? -1.0f : radius - 1.0f,
+          },
+  };
+
+  v2 extent = {radius + 1.0f, radius + 1.0f};
+  SoftwarePrimitiveClip(primitive, v2_sub(center, extent), v2_add(center, extent), framebuffer);
+  return primitive->minX < primitive->maxX && primitive->minY < primitive->maxY;
+}
+
+/* @return 0 if glyph is outside of framebuffer */
+static b8
+SoftwarePrimitiveGlyph(software_primitive *primitive, v2 min, f32 scale, u8 glyphIndex, u32 color,
+                       render_framebuffer *framebuffer)
+{
+  debug_assert(glyphIndex < FONT_GLYPH_COUNT && scale > 0.0f);
+  *primitive = (software_primitive){
+      .type = SOFTWARE_PRIMITIVE_GLYPH,
+      .color = color,
+      .glyph =
+          {
+              .min = min,
+              .invScale = 1.0f / scale,
+              .rows = FONT_GLYPHS[glyphIndex],
+          },
+  };
+
+  // last pixel that is covered, clip adds 1 to max
+  f32 size = FONT_GLYPH_SIZE * scale;
+  SoftwarePrimitiveClip(primitive, min, v2_add(min, (v2){size - 1.0f, size - 1.0f}), framebuffer);
+  return primitive->minX < primitive->maxX && primitive->minY < primitive->maxY;
+}
+
+/*
+ * Converts commands into screen space primitives.
+ * @param primitives must be able to hold 2 primitives for every command
+ * @return number of primitives
+ */
+static u32
+SoftwareBuildPrimitives(game_renderer *gameRenderer, u32 *commandIndices, u32 commandCount,
+                        software_primitive *primitives)
+{
+  render_framebuffer *framebuffer = &gameRenderer->framebuffer;
+  m2x3 layerToScreen[RENDER_LAYER_COUNT] = {
+      [RENDER_LAYER_WORLD] = gameRenderer->worldToScreen,
+      [RENDER_LAYER_SCREEN] = m2x3_identity(),
+  };
+  f32 layerPixelsPerUnit[RENDER_LAYER_COUNT] = {
+      [RENDER_LAYER_WORLD] = gameRenderer->pixelsPerMeter,
+      [RENDER_LAYER_SCREEN] = 1.0f,
+  };
+  u32 primitiveCount = 0;
+
+  for (u32 orderIndex = 0; orderIndex < commandCount; orderIndex++) {
+    render_command *command = gameRenderer->commands + commandIndices[orderIndex];
+    u32 color = command->color;
+    software_primitive *primitive = primitives + primitiveCount;
+    m2x3 worldToScreen = layerToScreen[command->layer];
+    f32 pixelsPerMeter = layerPixelsPerUnit[command->layer];
+
+    switch (command->type) {
+    case RENDER_COMMAND_TYPE_RECT: {
+      rect rect = command->rect;
+      v2 corners[4] = {
+          rect.min,
+          {rect.max.x, rect.min.y},
+          rect.max,
+          {rect.min.x, rect.max.y},
+      };
+      m2x3_transform_array(worldToScreen, corners, corners, ARRAY_COUNT(corners));
+      primitiveCount += SoftwarePrimitiveQuad(primitive, corners, color, framebuffer);
+    } break;
+
+    case RENDER_COMMAND_TYPE_QUAD: {
+      v2 corners[4];
+      m2x3_transform_array(worldToScreen, command->quad.corners, corners, ARRAY_COUNT(corners));
+      primitiveCount += SoftwarePrimitiveQuad(primitive, corners, color, framebuffer);
+    } break;
+
+    case RENDER_COMMAND_TYPE_LINE: {
+      v2 from = m2x3_transform(worldToScreen, command->line.from);
+      v2 to = m2x3_transform(worldToScreen, command->line.to);
+      f32 widthInPixels = Maximum(command->line.width * pixelsPerMeter, 1.0f);
+
+      v2 direction = v2_sub(to, from);
+      f32 length = v2_length(direction);
+      if (length == 0.0f)
+        break;
+
+      v2 normal = v2_scale(v2_perp(direction), widthInPixels * 0.5f / length);
+      v2 corners[4] = {
+          v2_add(from, normal),
+          v2_add(to, normal),
+          v2_sub(to, normal),
+          v2_sub(from, normal),
+      };
+      primitiveCount += SoftwarePrimitiveQuad(primitive, corners, color, framebuffer);
+    } break;
+
+    case RENDER_COMMAND_TYPE_CIRCLE_FILLED:
+    case RENDER_COMMAND_TYPE_CIRCLE: {
+      v2 center = m2x3_transform(worldToScreen, command->circle.center);
+      f32 radiusInPixels = command->circle.radius * pixelsPerMeter;
+      b8 isFilled = command->type == RENDER_COMMAND_TYPE_CIRCLE_FILLED;
+      primitiveCount += SoftwarePrimitiveCircle(primitive, center, radiusInPixels, isFilled, color, framebuffer);
+    } break;
+
+    case RENDER_COMMAND_TYPE_CROSSHAIR: {
+      // same as SDL backend, 1 pixel wide horizontal and vertical rect
+      v2 center = m2x3_transform(worldToScreen, command->crosshair.center);
+      f32 radiusInPixels = command->crosshair.dim * 0.25f * pixelsPerMeter;
+      v2 extents[2] = {
+          {radiusInPixels, 0.5f},
+          {0.5f, radiusInPixels},
+      };
+      for (u32 extentIndex = 0; extentIndex < ARRAY_COUNT(extents); extentIndex++) {
+        v2 min = v2_sub(center, extents[extentIndex]);
+        v2 max = v2_add(center, extents[extentIndex]);
+        v2 corners[4] = {
+            min,
+            {max.x, min.y},
+            max,
+            {min.x, max.y},
+        };
+        primitiveCount += SoftwarePrimitiveQuad(primitives + primitiveCount, corners, color, framebuffer);
+      }
+    } break;
+
+    case RENDER_COMMAND_TYPE_GLYPH: {
+      v2 min = m2x3_transform(worldToScreen, command->glyph.min);
+      primitiveCount +=
+          SoftwarePrimitiveGlyph(primitive, min, command->glyph.scale, command->glyph.index, color, framebuffer);
+    } break;
+
+    default: {
+      debug_assert(0 && "unknown render command");
+    } break;
+    }
+  }
+
+  return primitiveCount;
+}
+
+/*****************************************************************
+ * RASTERIZE
+ *****************************************************************/
+
+#if defined(__AVX2__)
+
+/*
+ * Blends color over 8 pixels.
+ *   out = dst + (src - dst) a
+ * @param alpha [0, 1] of every pixel, pixels that have 0 are not written
+ * @param tailMask lanes that are inside of span
+ */
+static inline void
+SoftwareBlend8(u32 *pixels, __m256 alpha, __m256i tailMask, __m256 srcR, __m256 srcG, __m256 srcB)
+{
+  __m256i writeMask = _mm256_and_si256(tailMask, _mm256_castps_si256(_mm256_cmp_ps(alpha, _mm256_setzero_ps(), _CMP_GT_OQ)));
+  if (_mm256_testz_si256(writeMask, writeMask))
+    return;
+
+  __m256i byteMask = _mm256_set1_epi32(0xff);
+  __m256i dst = _mm256_maskload_epi32((const int *)pixels, writeMask);
+  __m256 dstR = _mm256_cvtepi32_ps(_mm256_and_si256(dst, byteMask));
+  __m256 dstG = _mm256_cvtepi32_ps(_mm256_and_si256(_mm256_srli_epi32(dst, 8), byteMask));
+  __m256 dstB = _mm256_cvtepi32_ps(_mm256_and_si256(_mm256_srli_epi32(dst, 16), byteMask));
+
+  __m256i outR = _mm256_cvtps_epi32(_mm256_fmadd_ps(_mm256_sub_ps(srcR, dstR), alpha, dstR));
+  __m256i outG = _mm256_cvtps_epi32(_mm256_fmadd_ps(_mm256_sub_ps(srcG, dstG), alpha, dstG));
+  __m256i outB = _mm256_cvtps_epi32(_mm256_fmadd_ps(_mm256_sub_ps(srcB, dstB), alpha, dstB));
+
+  // framebuffer is opaque
+  __m256i out = _mm256_or_si256(_mm256_set1_epi32((s32)0xff000000), outR);
+  out = _mm256_or_si256(out, _mm256_slli_epi32(outG, 8));
+  out = _mm256_or_si256(out, _mm256_slli_epi32(outB, 16));
+  _mm256_maskstore_epi32((int *)pixels, writeMask, out);
+}
+
+static void
+SoftwareRasterize(render_framebuffer *framebuffer, software_primitive *primitive, s32 minX, s32 minY, s32 maxX,
+                  s32 maxY)
+{
+  u32 color = primitive->color;
+  __m256 srcR = _mm256_set1_ps((f32)((color >> 0) & 0xff));
+  __m256 srcG = _mm256_set1_ps((f32)((color >> 8) & 0xff));
+  __m256 srcB = _mm256_set1_ps((f32)((color >> 16) & 0xff));
+  __m256 srcA = _mm256_set1_ps((f32)((color >> 24) & 0xff) * (1.0f / 255.0f));
+
+  __m256 zero = _mm256_setzero_ps();
+  __m256 one = _mm256_set1_ps(1.0f);
+  __m256 half = _mm256_set1_ps(0.5f);
+  __m256i laneIndex = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+  __m256 laneOffset = _mm256_add_ps(_mm256_cvtepi32_ps(laneIndex), half);
+
+  for (s32 y = minY; y < maxY; y++) {
+    u32 *row = framebuffer->pixels + (u32)y * framebuffer->pitch;
+    __m256 pixelY = _mm256_set1_ps((f32)y + 0.5f);
+
+    for (s32 x = minX; x < maxX; x += 8) {
+      __m256 pixelX = _mm256_add_ps(_mm256_set1_ps((f32)x), laneOffset);
+      __m256i tailMask = _mm256_cmpgt_epi32(_mm256_set1_epi32(maxX - x), laneIndex);
+
+      __m256 coverage;
+      if (primitive->type == SOFTWARE_PRIMITIVE_QUAD) {
+        __m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+        for (u32 edgeIndex = 0; edgeIndex < 4; edgeIndex++) {
+          __m256 edge = _mm256_fmadd_ps(_mm256_set1_ps(primitive->quad.a[edgeIndex]), pixelX,
+                                        _mm256_fmadd_ps(_mm256_set1_ps(primitive->quad.b[edgeIndex]), pixelY,
+                                                        _mm256_set1_ps(primitive->quad.c[edgeIndex])));
+          inside = _mm256_and_ps(inside, _mm256_cmp_ps(edge, zero, _CMP_GE_OQ));
+        }
+        coverage = _mm256_and_ps(inside, one);
+      } else if (primitive->type == SOFTWARE_PRIMITIVE_GLYPH) {
+        // pixels of span are on same glyph row, clip keeps them inside glyph
+        __m256 invScale = _mm256_set1_ps(primitive->glyph.invScale);
+        s32 glyphY = (s32)(((f32)y + 0.5f - primitive->glyph.min.y) * primitive->glyph.invScale);
+        __m256i row = _mm256_set1_epi32(primitive->glyph.rows[glyphY]);
+        __m256i glyphX = _mm256_cvttps_epi32(
+            _mm256_mul_ps(_mm256_sub_ps(pixelX, _mm256_set1_ps(primitive->glyph.min.x)), invScale));
+        __m256i bit = _mm256_and_si256(_mm256_srlv_epi32(row, glyphX), _mm256_set1_epi32(1));
+        coverage = _mm256_cvtepi32_ps(bit);
+      } else {
+        __m256 dx = _mm256_sub_ps(pixelX, _mm256_set1_ps(primitive->circle.center.x));
+        __m256 dy = _mm256_sub_ps(pixelY, _mm256_set1_ps(primitive->circle.center.y));
+        __m256 distance = _mm256_sqrt_ps(_mm256_fmadd_ps(dx, dx, _mm256_mul_ps(dy, dy)));
+        __m256 outer =
+            _mm256_sub_ps(_mm256_add_ps(_mm256_set1_ps(primitive->circle.outerRadius), half), distance);
+        __m256 inner =
+            _mm256_add_ps(_mm256_sub_ps(distance, _mm256_set1_ps(primitive->circle.innerRadius)), half);
+        outer = _mm256_min_ps(_mm256_max_ps(outer, zero), one);
+        inner = _mm256_min_ps(_mm256_max_ps(inner, zero), one);
+        coverage = _mm256_mul_ps(outer, inner);
+      }
+
+      SoftwareBlend8(row + x, _mm256_mul_ps(coverage, srcA), tailMask, srcR, srcG, srcB);
+    }
+  }
+}
+
+#else
+
+static void
+SoftwareRasterize(render_framebuffer *framebuffer, software_primitive *primitive, s32 minX, s32 minY, s32 maxX,
+                  s32 maxY)
+{
+  u32 color = primitive->color;
+  f32 srcR = (f32)((color >> 0) & 0xff);
+  f32 srcG = (f32)((color >> 8) & 0xff);
+  f32 srcB = (f32)((color >> 16) & 0xff);
+  f32 srcA = (f32)((color >> 24) & 0xff) * (1.0f / 255.0f);
+
+  for (s32 y = minY; y < maxY; y++) {
+    u32 *row = framebuffer->pixels + (u32)y * framebuffer->pitch;
+    f32 pixelY = (f32)y + 0.5f;
+
+    for (s32 x = minX; x < maxX; x++) {
+      f32 pixelX = (f32)x + 0.5f;
+
+      f32 coverage;
+      if (primitive->type == SOFTWARE_PRIMITIVE_QUAD) {
+        coverage = 1.0f;
+        for (u32 edgeIndex = 0; edgeIndex < 4; edgeIndex++) {
+          f32 edge = primitive->quad.a[edgeIndex] * pixelX + primitive->quad.b[edgeIndex] * pixelY +
+                     primitive->quad.c[edgeIndex];
+          if (edge < 0.0f)
+            coverage = 0.0f;
+        }
+      } else if (primitive->type == SOFTWARE_PRIMITIVE_GLYPH) {
+        // clip keeps pixel inside glyph
+        s32 glyphX = (s32)((pixelX - primitive->glyph.min.x) * primitive->glyph.invScale);
+        s32 glyphY = (s32)((pixelY - primitive->glyph.min.y) * primitive->glyph.invScale);
+        coverage = (f32)((primitive->glyph.rows[glyphY] >> glyphX) & 1);
+      } else {
+        v2 offset = {pixelX - primitive->circle.center.x, pixelY - primitive->circle.center.y};
+        f32 distance = v2_length(offset);
+        f32 outer = Clamp(primitive->circle.outerRadius + 0.5f - distance, 0.0f, 1.0f);
+        f32 inner = Clamp(distance - primitive->circle.innerRadius + 0.5f, 0.0f, 1.0f);
+        coverage = outer * inner;
+      }
+
+      f32 alpha = coverage * srcA;
+      if (alpha <= 0.0f)
+        continue;
+
+      u32 dst = row[x];
+      f32 dstR = (f32)((dst >> 0) & 0xff);
+      f32 dstG = (f32)((dst >> 8) & 0xff);
+      f32 dstB = (f32)((dst >> 16) & 0xff);
+      u32 outR = (u32)RoundF32ToS32(dstR + (srcR - dstR) * alpha);
+      u32 outG = (u32)RoundF32ToS32(dstG + (srcG - dstG) * alpha);
+      u32 outB = (u32)RoundF32ToS32(dstB + (srcB - dstB) * alpha);
+      row[x] = outR | (outG << 8) | (outB << 16) | 0xff000000;
+    }
+  }
+}
+
+#endif
+
+static void
+SoftwareRenderTile(platform_work_queue *queue, void *data)
+{
+  PROFILE_BEGIN(SoftwareRenderTile);
+  software_tile *tile = data;
+  render_framebuffer *framebuffer = tile->framebuffer;
+
+  for (s32 y = tile->minY; y < tile->maxY; y++) {
+    u32 *row = framebuffer->pixels + (u32)y * framebuffer->pitch;
+    for (s32 x = tile->minX; x < tile->maxX; x++)
+      row[x] = tile->clearColor;
+  }
+
+  for (u32 index = 0; index < tile->primitiveCount; index++) {
+    software_primitive *primitive = tile->primitives + tile->primitiveIndices[index];
+    s32 minX = Maximum(primitive->minX, tile->minX);
+    s32 minY = Maximum(primitive->minY, tile->minY);
+    s32 maxX = Minimum(primitive->maxX, tile->maxX);
+    s32 maxY = Minimum(primitive->maxY, tile->maxY);
+    SoftwareRasterize(framebuffer, primitive, minX, minY, maxX, maxY);
+  }
+  PROFILE_END(SoftwareRenderTile);
+}
+
+/*
+ * Draws commands into framebuffer.
+ * @param commandIndices commands in draw order
+ */
+static void
+SoftwareRenderFrame(game_renderer *gameRenderer, u32 *commandIndices, u32 commandCount)
+{
+  render_framebuffer *framebuffer = &gameRenderer->framebuffer;
+  debug_assert(framebuffer->pixels && framebuffer->pitch >= framebuffer->width);
+  __cleanup_memory_temp__ memory_temp memory = MemoryTempBegin(&gameRenderer->memory);
+  memory_arena *arena = memory.arena;
+
+  // primitives
+  software_primitive *primitives = MemoryArenaPush(arena, sizeof(*primitives) * commandCount * 2, 4);
+  u32 primitiveCount = SoftwareBuildPrimitives(gameRenderer, commandIndices, commandCount, primitives);
+
+  // bin
+  u32 tileCountX = (framebuffer->width + SOFTWARE_TILE_SIZE - 1) / SOFTWARE_TILE_SIZE;
+  u32 tileCountY = (framebuffer->height + SOFTWARE_TILE_SIZE - 1) / SOFTWARE_TILE_SIZE;
+  u32 tileCount = tileCountX * tileCountY;
+  software_tile *tiles = MemoryArenaPush(arena, sizeof(*tiles) * tileCount, 4);
+  memset(tiles, 0, sizeof(*tiles) * tileCount);
+
+  // count, then write indices so every tile is contiguous
+  u32 binnedCount = 0;
+  for (u32 primitiveIndex = 0; primitiveIndex < primitiveCount; primitiveIndex++) {
+    software_primitive *primitive = primitives + primitiveIndex;
+    u32 tileMinX = (u32)primitive->minX / SOFTWARE_TILE_SIZE;
+    u32 tileMinY = (u32)primitive->minY / SOFTWARE_TILE_SIZE;
+    u32 tileMaxX = (u32)(primitive->maxX - 1) / SOFTWARE_TILE_SIZE;
+    u32 tileMaxY = (u32)(primitive->maxY - 1) / SOFTWARE_TILE_SIZE;
+    for (u32 tileY = tileMinY; tileY <= tileMaxY; tileY++) {
+      for (u32 tileX = tileMinX; tileX <= tileMaxX; tileX++)
+        tiles[tileY * tileCountX + tileX].primitiveCount++;
+    }
+    binnedCount += (tileMaxX - tileMinX + 1) * (tileMaxY - tileMinY + 1);
+  }
+
+  u32 *primitiveIndices = MemoryArenaPush(arena, sizeof(*primitiveIndices) * binnedCount, 4);
+  u32 clearColor = ColorPackRGBA8(gameRenderer->clearColor) | 0xff000000;
+  u32 offset = 0;
+  for (u32 tileY = 0; tileY < tileCountY; tileY++) {
+    for (u32 tileX = 0; tileX < tileCountX; tileX++) {
+      software_tile *tile = tiles + tileY * tileCountX + tileX;
+      tile->framebuffer = framebuffer;
+      tile->primitives = primitives;
+      tile->primitiveIndices = primitiveIndices + offset;
+      offset += tile->primitiveCount;
+      tile->primitiveCount = 0; // used as write position below
+      tile->clearColor = clearColor;
+      tile->minX = (s32)(tileX * SOFTWARE_TILE_SIZE);
+      tile->minY = (s32)(tileY * SOFTWARE_TILE_SIZE);
+      tile->maxX = (s32)Minimum((tileX + 1) * SOFTWARE_TILE_SIZE, framebuffer->width);
+      tile->maxY = (s32)Minimum((tileY + 1) * SOFTWARE_TILE_SIZE, framebuffer->height);
+    }
+  }
+
+  for (u32 primitiveIndex = 0; primitiveIndex < primitiveCount; primitiveIndex++) {
+    software_primitive *primitive = primitives + primitiveIndex;
+    u32 tileMinX = (u32)primitive->minX / SOFTWARE_TILE_SIZE;
+    u32 tileMinY = (u32)primitive->minY / SOFTWARE_TILE_SIZE;
+    u32 tileMaxX = (u32)(primitive->maxX - 1) / SOFTWARE_TILE_SIZE;
+    u32 tileMaxY = (u32)(primitive->maxY - 1) / SOFTWARE_TILE_SIZE;
+    for (u32 tileY = tileMinY; tileY <= tileMaxY; tileY++) {
+      for (u32 tileX = tileMinX; tileX <= tileMaxX; tileX++) {
+        software_tile *tile = tiles + tileY * tileCountX + tileX;
+        tile->primitiveIndices[tile->primitiveCount++] = primitiveIndex;
+      }
+    }
+  }
+
+  // rasterize
+  platform_work_queue *queue = gameRenderer->workQueue;
+  for (u32 tileIndex = 0; tileIndex < tileCount; tileIndex++) {
+    software_tile *tile = tiles + tileIndex;
+    if (queue)
+      gameRenderer->PlatformAddWorkEntry(queue, SoftwareRenderTile, tile);
+    else
+      SoftwareRenderTile(0, tile);
+  }
+  if (queue)
+    gameRenderer->PlatformCompleteAllWork(queue);
+
+  gameRenderer->stats.batchCount = tileCount;
+  gameRenderer->stats.drawCallCount = binnedCount;
+}
@@ -0,0 +1,423 @@
+#include "rewind.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+static inline u64
+RewindPaddedSize(u64 size)
+{
+  return (size + (REWIND_BLOCK_SIZE - 1)) & ~(u64)(REWIND_BLOCK_SIZE - 1);
+}
+
+/*
+ * Copies stream into keyframe. Keyframes are written once and rarely read,
+ * so they bypass cache instead of evicting world state the next step reads.
+ */
+static void
+RewindCopyKeyframe(u8 *keyframe, u8 *data, u64 size)
+{
+#if defined(__AVX2__)
+  if (((u64)keyframe & (REWIND_BLOCK_SIZE - 1)) == 0) {
+    u64 blockCount = size / REWIND_BLOCK_SIZE;
+    for (u64 blockIndex = 0; blockIndex < blockCount; blockIndex++) {
+      __m256i value = _mm256_loadu_si256((__m256i *)(data + blockIndex * REWIND_BLOCK_SIZE));
+      _mm256_stream_si256((__m256i *)(keyframe + blockIndex * REWIND_BLOCK_SIZE), value);
+    }
+    _mm_sfence();
+    u64 copiedSize = blockCount * REWIND_BLOCK_SIZE;
+    keyframe += copiedSize;
+    data += copiedSize;
+    size -= copiedSize;
+  }
+#endif
+  memcpy(keyframe, data, size);
+}
+
+u64
+RewindStateSize(rewind_stream *streams, u32 streamCount)
+{
+  u64 stateSize = 0;
+  for (u32 streamIndex = 0; streamIndex < streamCount; streamIndex++)
+    stateSize += RewindPaddedSize(streams[streamIndex].size);
+  return stateSize;
+}
+
+void
+RewindBufferInit(rewind_buffer *buffer, memory_arena *arena, u64 memorySize, u32 frameMax, u32 keyframeInterval,
+                 rewind_stream *streams, u32 streamCount)
+{
+  debug_assert(streamCount <= REWIND_STREAM_MAX);
+  debug_assert(keyframeInterval > 0);
+  *buffer = (rewind_buffer){};
+
+  u64 stateSize = RewindStateSize(streams, streamCount);
+
+  // - index tables
+  // - reference and scratch
+  // - frame table
+  // - ring, must at least fit one keyframe
+  u64 tableSize = 2 * 256 * sizeof(*buffer->compressIndices);
+  u64 fixedSize = tableSize + 2 * stateSize + sizeof(*buffer->frames) * frameMax + 4 * REWIND_BLOCK_SIZE;
+  if (memorySize > arena->total - arena->used)
+    memorySize = arena->total - arena->used;
+  if (memorySize < fixedSize + stateSize + REWIND_BLOCK_SIZE)
+    return;
+
+  memory_arena memory = MemoryArenaSub(arena, memorySize);
+  buffer->compressIndices = MemoryArenaPush(&memory, 256 * sizeof(*buffer->compressIndices), REWIND_BLOCK_SIZE);
+  buffer->expandIndices = MemoryArenaPush(&memory, 256 * sizeof(*buffer->expandIndices), REWIND_BLOCK_SIZE);
+  buffer->reference = MemoryArenaPush(&memory, stateSize, REWIND_BLOCK_SIZE);
+  buffer->scratch = MemoryArenaPush(&memory, stateSize, REWIND_BLOCK_SIZE);
+  buffer->frames = MemoryArenaPush(&memory, sizeof(*buffer->frames) * frameMax, 8);
+  buffer->frameMax = frameMax;
+  buffer->keyframeInterval = keyframeInterval;
+  buffer->stateSize = stateSize;
+  bzero(buffer->reference, stateSize);
+
+  // decoder reads whole block past last packed word
+  MemoryArenaPush(&memory, 0, REWIND_BLOCK_SIZE);
+  buffer->dataSize = memory.total - memory.used - REWIND_BLOCK_SIZE;
+  buffer->data = MemoryArenaPush(&memory, buffer->dataSize, 1);
+
+  // mask 0b1010 packs words 1 and 3 to front: compress {1, 3, ...}, expand {_, 0, _, 1, ...}
+  for (u32 mask = 0; mask < 256; mask++) {
+    u32 packedIndex = 0;
+    for (u32 wordIndex = 0; wordIndex < 8; wordIndex++) {
+      buffer->compressIndices[mask][wordIndex] = 0;
+      buffer->expandIndices[mask][wordIndex] = 0;
+    }
+    for (u32 wordIndex = 0; wordIndex < 8; wordIndex++) {
+      if (mask & (1u << wordIndex)) {
+        buffer->compressIndices[mask][packedIndex] = wordIndex;
+        buffer->expandIndices[mask][wordIndex] = packedIndex;
+        packedIndex++;
+      }
+    }
+  }
+}
+
+void
+RewindBufferReset(rewind_buffer *buffer)
+{
+  buffer->writeOffset = 0;
+  buffer->frameFirst = 0;
+  buffer->frameCount = 0;
+  buffer->framesSinceKeyframe = 0;
+}
+
+typedef struct {
+  u8 *out;
+  u32 zeroBlockCount; // pending run of blocks that did not change
+  u32 (*compressIndices)[8];
+} rewind_encoder;
+
+static inline u8 *
+RewindEncodeZeroBlocks(u8 *out, u32 zeroBlockCount)
+{
+  out[0] = 0;
+  out[1] = (u8)zeroBlockCount;
+  return out + 2;
+}
+
+/*
+ * Encodes current ^ reference, then copies current into reference.
+ * Writes at most 33 bytes per block, plus REWIND_BLOCK_SIZE bytes of slack
+ * after the end.
+ */
+static void
+RewindEncodeBlocks(rewind_encoder *encoder, u8 *current, u8 *reference, u64 blockCount)
+{
+  // in locals, stores through out could alias encoder and force a reload every block
+  u8 *out = encoder->out;
+  u32 zeroBlockCount = encoder->zeroBlockCount;
+#if defined(__AVX2__)
+  u32(*compressIndices)[8] = encoder->compressIndices;
+  __m256i zero = _mm256_setzero_si256();
+  for (u64 blockIndex = 0; blockIndex < blockCount; blockIndex++) {
+    __m256i *currentBlock = (__m256i *)(current + blockIndex * REWIND_BLOCK_SIZE);
+    __m256i *referenceBlock = (__m256i *)(reference + blockIndex * REWIND_BLOCK_SIZE);
+    __m256i value = _mm256_loadu_si256(currentBlock);
+    __m256i delta = _mm256_xor_si256(value, _mm256_load_si256(referenceBlock));
+    _mm256_store_si256(referenceBlock, value);
+
+    u32 mask = (u32)_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(delta, zero))) ^ 0xff;
+    if (mask == 0) {
+      zeroBlockCount++;
+      if (zeroBlockCount == U8_MAX) {
+        out = RewindEncodeZeroBlocks(out, zeroBlockCount);
+        zeroBlockCount = 0;
+      }
+      continue;
+    }
+
+    if (zeroBlockCount > 0) {
+      out = RewindEncodeZeroBlocks(out, zeroBlockCount);
+      zeroBlockCount = 0;
+    }
+    out[0] = (u8)mask;
+    // stores whole block, only words that are not 0 are kept
+    __m256i indices = _mm256_load_si256((__m256i *)compressIndices[mask]);
+    _mm256_storeu_si256((__m256i *)(out + 1), _mm256_permutevar8x32_epi32(delta, indices));
+    out += 1 + (u32)__builtin_popcount(mask) * sizeof(u32);
+  }
+#else
+  for (u64 blockIndex = 0; blockIndex < blockCount; blockIndex++) {
+    u32 *currentBlock = (u32 *)(current + blockIndex * REWIND_BLOCK_SIZE);
+    u32 *referenceBlock = (u32 *)(reference + blockIndex * REWIND_BLOCK_SIZE);
+    u32 delta[8];
+    u32 mask = 0;
+    for (u32 wordIndex = 0; wordIndex < 8; wordIndex++) {
+      delta[wordIndex] = currentBlock[wordIndex] ^ referenceBlock[wordIndex];
+      referenceBlock[wordIndex] = currentBlock[wordIndex];
+      if (delta[wordIndex] != 0)
+        mask |= 1u << wordIndex;
+    }
+
+    if (mask == 0) {
+      zeroBlockCount++;
+      if (zeroBlockCount == U8_MAX) {
+        out = RewindEncodeZeroBlocks(out, zeroBlockCount);
+        zeroBlockCount = 0;
+      }
+      continue;
+    }
+
+    if (zeroBlockCount > 0) {
+      out = RewindEncodeZeroBlocks(out, zeroBlockCount);
+      zeroBlockCount = 0;
+    }
+    out[0] = (u8)mask;
+    out++;
+    for (u32 wordIndex = 0; wordIndex < 8; wordIndex++) {
+      if (delta[wordIndex] != 0) {
+        memcpy(out, delta + wordIndex, sizeof(u32));
+        out += sizeof(u32);
+      }
+    }
+  }
+#endif
+  encoder->out = out;
+  encoder->zeroBlockCount = zeroBlockCount;
+}
+
+static inline void
+RewindEncoderFlushZeroBlocks(rewind_encoder *encoder)
+{
+  if (encoder->zeroBlockCount == 0)
+    return;
+  encoder->out = RewindEncodeZeroBlocks(encoder->out, encoder->zeroBlockCount);
+  encoder->zeroBlockCount = 0;
+}
+
+/* xors encoded delta into target, returns end of encoded delta */
+static u8 *
+RewindDecodeBlocks(rewind_buffer *buffer, u8 *in, u8 *target, u64 blockCount)
+{
+  u64 blockIndex = 0;
+  while (blockIndex < blockCount) {
+    u32 mask = in[0];
+    if (mask == 0) {
+      blockIndex += in[1];
+      in += 2;
+      continue;
+    }
+
+    u8 *block = target + blockIndex * REWIND_BLOCK_SIZE;
+#if defined(__AVX2__)
+    // reads whole block, words after packed ones are masked out
+    __m256i packed = _mm256_loadu_si256((__m256i *)(in + 1));
+    __m256i indices = _mm256_load_si256((__m256i *)buffer->expandIndices[mask]);
+    __m256i bits = _mm256_setr_epi32(1 << 0, 1 << 1, 1 << 2, 1 << 3, 1 << 4, 1 << 5, 1 << 6, 1 << 7);
+    __m256i keep = _mm256_cmpeq_epi32(_mm256_and_si256(_mm256_set1_epi32((s32)mask), bits), bits);
+    __m256i delta = _mm256_and_si256(_mm256_permutevar8x32_epi32(packed, indices), keep);
+    _mm256_store_si256((__m256i *)block, _mm256_xor_si256(_mm256_load_si256((__m256i *)block), delta));
+#else
+    u8 *packed = in + 1;
+    for (u32 wordIndex = 0; wordIndex < 8; wordIndex++) {
+      if (mask & (1u << wordIndex)) {
+        u32 delta;
+        memcpy(&delta, packed, sizeof(delta));
+        ((u32 *)block)[wordIndex] ^= delta;
+        packed += sizeof(u32);
+      }
+    }
+#endif
+    in += 1 + (u32)__builtin_popcount(mask) * sizeof(u32);
+    blockIndex++;
+  }
+
+  debug_assert(blockIndex == blockCount);
+  return in;
+}
+
+static inline rewind_frame *
+RewindBufferGetFrame(rewind_buffer *buffer, u32 index)
+{
+  debug_assert(index < buffer->frameCount);
+  return buffer->frames + (buffer->frameFirst + index) % buffer->frameMax;
+}
+
+/* Drops oldest keyframe together with its deltas. */
+static void
+RewindBufferDropOldestKeyframe(rewind_buffer *buffer)
+{
+  do {
+    buffer->frameFirst = (buffer->frameFirst + 1) % buffer->frameMax;
+    buffer->frameCount--;
+  } while (buffer->frameCount > 0 && !RewindBufferGetFrame(buffer, 0)->isKeyframe);
+}
+
+static inline b8
+RewindFrameIsOverlapping(rewind_frame *frame, u64 offset, u64 size)
+{
+  return frame->offset < offset + size && offset < frame->offset + frame->size;
+}
+
+void
+RewindBufferCapture(rewind_buffer *buffer, rewind_stream *streams, u32 streamCount)
+{
+  if (!buffer->data)
+    return;
+
+  b8 isKeyframe = buffer->frameCount == 0 || buffer->framesSinceKeyframe + 1 >= buffer->keyframeInterval;
+  u64 blockCount = buffer->stateSize / REWIND_BLOCK_SIZE;
+  u64 maxSize = isKeyframe ? buffer->stateSize : blockCount * (1 + REWIND_BLOCK_SIZE) + REWIND_BLOCK_SIZE;
+  if (maxSize > buffer->dataSize) {
+    // delta can be bigger than keyframe when every word changes
+    isKeyframe = 1;
+    maxSize = buffer->stateSize;
+  }
+
+  // make room, records are never split at end of ring
+  if (buffer->writeOffset + maxSize > buffer->dataSize) {
+    // frames after write offset are the oldest ones, they would be out of order
+    while (buffer->frameCount > 0 && RewindBufferGetFrame(buffer, 0)->offset >= buffer->writeOffset)
+      RewindBufferDropOldestKeyframe(buffer);
+    buffer->writeOffset = 0;
+  }
+  if (buffer->frameCount == buffer->frameMax)
+    RewindBufferDropOldestKeyframe(buffer);
+  while (buffer->frameCount > 0 &&
+         RewindFrameIsOverlapping(RewindBufferGetFrame(buffer, 0), buffer->writeOffset, maxSize))
+    RewindBufferDropOldestKeyframe(buffer);
+  // deltas cannot be decoded without keyframe before them
+  if (buffer->frameCount == 0 && !isKeyframe) {
+    isKeyframe = 1;
+    maxSize = buffer->stateSize;
+  }
+
+  u8 *out = buffer->data + buffer->writeOffset;
+  u64 size;
+  if (isKeyframe) {
+    u8 *keyframe = out;
+    for (u32 streamIndex = 0; streamIndex < streamCount; streamIndex++) {
+      rewind_stream *stream = streams + streamIndex;
+      u64 paddedSize = RewindPaddedSize(stream->size);
+      RewindCopyKeyframe(keyframe, stream->data, stream->size);
+      bzero(keyframe + stream->size, paddedSize - stream->size);
+      keyframe += paddedSize;
+    }
+    // when every frame is a keyframe, reference is never read
+    if (buffer->keyframeInterval > 1)
+      memcpy(buffer->reference, out, buffer->stateSize);
+    size = buffer->stateSize;
+    buffer->framesSinceKeyframe = 0;
+  } else {
+    rewind_encoder encoder = {
+        .out = out,
+        .compressIndices = buffer->compressIndices,
+    };
+    u8 *reference = buffer->reference;
+    for (u32 streamIndex = 0; streamIndex < streamCount; streamIndex++) {
+      rewind_stream *stream = streams + streamIndex;
+      u64 fullBlockCount = stream->size / REWIND_BLOCK_SIZE;
+      RewindEncodeBlocks(&encoder, stream->data, reference, fullBlockCount);
+      reference += fullBlockCount * REWIND_BLOCK_SIZE;
+
+      u64 tailSize = stream->size - fullBlockCount * REWIND_BLOCK_SIZE;
+      if (tailSize > 0) {
+        u8 tail[REWIND_BLOCK_SIZE] = {};
+        memcpy(tail, (u8 *)stream->data + fullBlockCount * REWIND_BLOCK_SIZE, tailSize);
+        RewindEncodeBlocks(&encoder, tail, reference, 1);
+        reference += REWIND_BLOCK_SIZE;
+      }
+    }
+    RewindEncoderFlushZeroBlocks(&encoder);
+    size = (u64)(encoder.out - out);
+    buffer->framesSinceKeyframe++;
+  }
+  debug_assert(size <= maxSize);
+
+  *(buffer->frames + (buffer->frameFirst + buffer->frameCount) % buffer->frameMax) = (rewind_frame){
+      .offset = buffer->writeOffset,
+      .size = size,
+      .isKeyframe = isKeyframe,
+  };
+  buffer->frameCount++;
+  buffer->writeOffset += size;
+}
+
+/* Decodes frame into target. */
+static void
+RewindBufferDecode(rewind_buffer *buffer, u32 frameIndex, u8 *target)
+{
+  u32 keyframeIndex = frameIndex;
+  while (!RewindBufferGetFrame(buffer, keyframeIndex)->isKeyframe) {
+    debug_assert(keyframeIndex > 0 && "oldest frame must be keyframe");
+    keyframeIndex--;
+  }
+
+  rewind_frame *keyframe = RewindBufferGetFrame(buffer, keyframeIndex);
+  memcpy(target, buffer->data + keyframe->offset, buffer->stateSize);
+
+  u64 blockCount = buffer->stateSize / REWIND_BLOCK_SIZE;
+  for (u32 deltaIndex = keyframeIndex + 1; deltaIndex <= frameIndex; deltaIndex++) {
+    rewind_frame *delta = RewindBufferGetFrame(buffer, deltaIndex);
+    u8 *end = RewindDecodeBlocks(buffer, buffer->data + delta->offset, target, blockCount);
+    debug_assert(end == buffer->data + delta->offset + delta->size);
+    (void)end;
+  }
+}
+
+static void
+RewindCopyToStreams(u8 *state, rewind_stream *streams, u32 streamCount)
+{
+  for (u32 streamIndex = 0; streamIndex < streamCount; streamIndex++) {
+    rewind_stream *stream = streams + streamIndex;
+    memcpy(stream->data, state, stream->size);
+    state += RewindPaddedSize(stream->size);
+  }
+}
+
+b8
+RewindBufferRestore(rewind_buffer *buffer, rewind_stream *streams, u32 streamCount, u32 framesAgo)
+{
+  if (!buffer->data || framesAgo >= buffer->frameCount)
+    return 0;
+
+  RewindBufferDecode(buffer, buffer->frameCount - 1 - framesAgo, buffer->scratch);
+  RewindCopyToStreams(buffer->scratch, streams, streamCount);
+  return 1;
+}
+
+b8
+RewindBufferTruncate(rewind_buffer *buffer, rewind_stream *streams, u32 streamCount, u32 framesAgo)
+{
+  if (!buffer->data || framesAgo >= buffer->frameCount)
+    return 0;
+
+  u32 frameIndex = buffer->frameCount - 1 - framesAgo;
+  RewindBufferDecode(buffer, frameIndex, buffer->reference);
+  RewindCopyToStreams(buffer->reference, streams, streamCount);
+
+  buffer->frameCount = frameIndex + 1;
+  rewind_frame *newest = RewindBufferGetFrame(buffer, frameIndex);
+  buffer->writeOffset = newest->offset + newest->size;
+
+  buffer->framesSinceKeyframe = 0;
+  while (!RewindBufferGetFrame(buffer, frameIndex - buffer->framesSinceKeyframe)->isKeyframe)
+    buffer->framesSinceKeyframe++;
+
+  return 1;
+}
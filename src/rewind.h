@@ -0,0 +1,99 @@
+#pragma once
+
+#include "memory.h"
+#include "type.h"
+
+/*
+ * Rewind buffer keeps last frames of world state in a fixed size ring.
+ *
+ * World state is a list of streams (game_state, particles, ...). Each frame
+ * is either a keyframe, which is a plain copy of every stream, or a delta
+ * that only stores what changed since previous frame:
+ *
+ *   streams are cut into 32 byte blocks
+ *   block = current ^ previous, 8 words
+ *     mask  = u8, bit i is set when word i is not 0
+ *     mask != 0: mask, followed by words that are not 0
+ *     mask == 0: 0, followed by u8 count of blocks that are all 0
+ *
+ * A frame is decoded by copying the keyframe before it, then xoring deltas
+ * until the frame. Keyframe is stored every keyframeInterval frames, so
+ * decoding any frame costs at most one copy and keyframeInterval - 1 deltas.
+ *
+ * When ring is full, oldest keyframe and its deltas are dropped together, so
+ * oldest frame in ring is always a keyframe.
+ */
+
+#define REWIND_STREAM_MAX 4
+#define REWIND_BLOCK_SIZE 32
+
+typedef struct {
+  void *data;
+  u64 size;
+} rewind_stream;
+
+typedef struct {
+  u64 offset; // into data
+  u64 size;
+  b8 isKeyframe;
+} rewind_frame;
+
+typedef struct {
+  u8 *data; // ring of encoded frames, 0 when rewind is disabled
+  u64 dataSize;
+  u64 writeOffset;
+
+  rewind_frame *frames; // ring, oldest is frames[frameFirst]
+  u32 frameMax;
+  u32 frameFirst;
+  u32 frameCount;
+
+  u32 keyframeInterval;
+  u32 framesSinceKeyframe;
+
+  // streams laid out one after another, each padded to REWIND_BLOCK_SIZE
+  u64 stateSize;
+  u8 *reference; // state of newest frame, deltas are taken against it
+  u8 *scratch;   // decoded frame
+
+  u32 (*compressIndices)[8]; // for mask, which words to pack to front
+  u32 (*expandIndices)[8];   // for mask, where packed words go back to
+} rewind_buffer;
+
+/* @return size of one keyframe of streams */
+u64
+RewindStateSize(rewind_stream *streams, u32 streamCount);
+
+/*
+ * Takes memory from arena. When arena cannot fit the buffer, rewind is
+ * disabled and every call is a no-op.
+ * streams are only used for their sizes, which must not change later.
+ */
+void
+RewindBufferInit(rewind_buffer *buffer, memory_arena *arena, u64 memorySize, u32 frameMax, u32 keyframeInterval,
+                 rewind_stream *streams, u32 streamCount);
+
+/* Drops every frame, next capture is a keyframe. */
+void
+RewindBufferReset(rewind_buffer *buffer);
+
+/* Appends current state of streams as newest frame. */
+void
+RewindBufferCapture(rewind_buffer *buffer, rewind_stream *streams, u32 streamCount);
+
+/*
+ * Writes state of frame that is framesAgo before newest into streams.
+ * Does not change the ring, so it can be called with any framesAgo while
+ * scrubbing.
+ * @return 0 when frame is not in ring
+ */
+b8
+RewindBufferRestore(rewind_buffer *buffer, rewind_stream *streams, u32 streamCount, u32 framesAgo);
+
+/*
+ * Restores frame that is framesAgo before newest, and drops frames after it.
+ * Next capture continues from that frame.
+ * @return 0 when frame is not in ring
+ */
+b8
+RewindBufferTruncate(rewind_buffer *buffer, rewind_stream *streams, u32 streamCount, u32 framesAgo);
@@ -0,0 +1,112 @@
+#include "platform.h"
+#include <SDL3/SDL.h>
+
+/*
+ * Work queue that is run by SDL threads.
+ * Only one thread adds entries, every thread can take them.
+ */
+
+typedef struct {
+  pfnPlatformWorkQueueCallback callback;
+  void *data;
+} platform_work_queue_entry;
+
+#define WORK_QUEUE_ENTRY_COUNT 256
+
+struct platform_work_queue {
+  SDL_AtomicInt completionGoal;
+  SDL_AtomicInt completionCount;
+
+  SDL_AtomicInt nextEntryToWrite;
+  SDL_AtomicInt nextEntryToRead;
+  SDL_Semaphore *semaphore;
+
+  platform_work_queue_entry entries[WORK_QUEUE_ENTRY_COUNT];
+};
+
+/* @return 1 if there was an entry to run */
+static b8
+WorkQueueDoNextEntry(platform_work_queue *queue)
+{
+  s32 originalNextEntryToRead = SDL_GetAtomicInt(&queue->nextEntryToRead);
+  if (originalNextEntryToRead == SDL_GetAtomicInt(&queue->nextEntryToWrite))
+    return 0;
+
+  SDL_MemoryBarrierAcquire();
+  // copy before taking it, after that writer is free to reuse the slot
+  platform_work_queue_entry entry = queue->entries[originalNextEntryToRead];
+
+  s32 newNextEntryToRead = (originalNextEntryToRead + 1) % WORK_QUEUE_ENTRY_COUNT;
+  if (SDL_CompareAndSwapAtomicInt(&queue->nextEntryToRead, originalNextEntryToRead, newNextEntryToRead)) {
+    entry.callback(queue, entry.data);
+    SDL_AddAtomicInt(&queue->completionCount, 1);
+  }
+
+  return 1;
+}
+
+static void
+WorkQueueAddEntry(platform_work_queue *queue, pfnPlatformWorkQueueCallback callback, void *data)
+{
+  s32 nextEntryToWrite = SDL_GetAtomicInt(&queue->nextEntryToWrite);
+  s32 newNextEntryToWrite = (nextEntryToWrite + 1) % WORK_QUEUE_ENTRY_COUNT;
+  // when queue is full, help workers until there is room
+  while (newNextEntryToWrite == SDL_GetAtomicInt(&queue->nextEntryToRead))
+    WorkQueueDoNextEntry(queue);
+
+  queue->entries[nextEntryToWrite] = (platform_work_queue_entry){
+      .callback = callback,
+      .data = data,
+  };
+  SDL_AddAtomicInt(&queue->completionGoal, 1);
+
+  // entry must be visible before it is published
+  SDL_MemoryBarrierRelease();
+  SDL_SetAtomicInt(&queue->nextEntryToWrite, newNextEntryToWrite);
+  SDL_SignalSemaphore(queue->semaphore);
+}
+
+static void
+WorkQueueCompleteAllWork(platform_work_queue *queue)
+{
+  while (SDL_GetAtomicInt(&queue->completionGoal) != SDL_GetAtomicInt(&queue->completionCount))
+    WorkQueueDoNextEntry(queue);
+
+  SDL_SetAtomicInt(&queue->completionGoal, 0);
+  SDL_SetAtomicInt(&queue->completionCount, 0);
+}
+
+static s32
+WorkQueueThreadProc(void *data)
+{
+  platform_work_queue *queue = data;
+  for (;;) {
+    if (!WorkQueueDoNextEntry(queue))
+      SDL_WaitSemaphore(queue->semaphore);
+  }
+  return 0;
+}
+
+/*
+ * Starts worker threads that live until process exits.
+ * @return 0 when threads could not be created, work is then done by caller
+ *         of WorkQueueCompleteAllWork()
+ */
+static b8
+WorkQueueInit(platform_work_queue *queue, u32 threadCount)
+{
+  memset(queue, 0, sizeof(*queue));
+
+  queue->semaphore = SDL_CreateSemaphore(0);
+  if (!queue->semaphore)
+    return 0;
+
+  for (u32 threadIndex = 0; threadIndex < threadCount; threadIndex++) {
+    SDL_Thread *thread = SDL_CreateThread(WorkQueueThreadProc, "worker", queue);
+    if (!thread)
+      return 0;
+    SDL_DetachThread(thread);
+  }
+
+  return 1;
+}
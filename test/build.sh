@@ -63,3 +63,35 @@ output="$outputDir/$(BasenameWithoutExtension "$src")"
 lib="$LIB_M"
 "$cc" $cflags $ldflags $inc -o "$output" $src $lib
 RunTest "$output" "TEST teju failed."
+
+### fixed_test
+inc="-I$ProjectRoot/include"
+src="$pwd/fixed_test.c"
+output="$outputDir/$(BasenameWithoutExtension "$src")"
+lib="$LIB_M"
+"$cc" $cflags $ldflags $inc -o "$output" $src $lib
+RunTest "$output" "TEST fixed failed."
+
+### hash_test
+inc="-I$ProjectRoot/include"
+src="$pwd/hash_test.c"
+output="$outputDir/$(BasenameWithoutExtension "$src")"
+lib="$LIB_M"
+"$cc" $cflags $ldflags $inc -o "$output" $src $lib
+RunTest "$output" "TEST hash failed."
+
+### histogram_test
+inc="-I$ProjectRoot/include"
+src="$pwd/histogram_test.c"
+output="$outputDir/$(BasenameWithoutExtension "$src")"
+lib="$LIB_M"
+"$cc" $cflags $ldflags $inc -o "$output" $src $lib
+RunTest "$output" "TEST histogram failed."
+
+### rewind_test
+inc="-I$ProjectRoot/include -I$ProjectRoot/src"
+src="$pwd/rewind_test.c"
+output="$outputDir/$(BasenameWithoutExtension "$src")"
+lib="$LIB_M"
+"$cc" $cflags $ldflags $inc -o "$output" $src $lib
+RunTest "$output" "TEST rewind failed."
@@ -0,0 +1,258 @@
+#include "fixed.h"
+
+// TODO: Show error pretty error message when a test fails
+enum fixed_test_error {
+  FIXED_TEST_ERROR_NONE = 0,
+  FIXED_TEST_ERROR_Q16_CONSTANT,
+  FIXED_TEST_ERROR_Q16_FROM_F32,
+  FIXED_TEST_ERROR_Q16_FROM_F32_NEGATIVE,
+  FIXED_TEST_ERROR_Q16_TO_F32,
+  FIXED_TEST_ERROR_Q16_MUL,
+  FIXED_TEST_ERROR_Q16_MUL_NEGATIVE,
+  FIXED_TEST_ERROR_Q16_DIV,
+  FIXED_TEST_ERROR_Q16_DIV_NEGATIVE,
+  FIXED_TEST_ERROR_SQUARE_ROOT_U64,
+  FIXED_TEST_ERROR_SQUARE_ROOT_U64_MAX,
+  FIXED_TEST_ERROR_Q16_SQRT,
+  FIXED_TEST_ERROR_Q16_SIN,
+  FIXED_TEST_ERROR_Q16_COS,
+  FIXED_TEST_ERROR_V2Q_ADD,
+  FIXED_TEST_ERROR_V2Q_SUB,
+  FIXED_TEST_ERROR_V2Q_SCALE,
+  FIXED_TEST_ERROR_V2Q_DOT,
+  FIXED_TEST_ERROR_V2Q_LENGTH,
+  FIXED_TEST_ERROR_V2Q_NORMALIZE,
+  FIXED_TEST_ERROR_V2Q_NORMALIZE_ZERO,
+  FIXED_TEST_ERROR_V2Q_ROTATE,
+
+  // src: https://mesonbuild.com/Unit-tests.html#skipped-tests-and-hard-errors
+  // For the default exitcode testing protocol, the GNU standard approach in
+  // this case is to exit the program with error code 77. Meson will detect this
+  // and report these tests as skipped rather than failed. This behavior was
+  // added in version 0.37.0.
+  MESON_TEST_SKIP = 77,
+  // In addition, sometimes a test fails set up so that it should fail even if
+  // it is marked as an expected failure. The GNU standard approach in this case
+  // is to exit the program with error code 99. Again, Meson will detect this
+  // and report these tests as ERROR, ignoring the setting of should_fail. This
+  // behavior was added in version 0.50.0.
+  MESON_TEST_FAILED_TO_SET_UP = 99,
+};
+
+int
+main(void)
+{
+  enum fixed_test_error errorCode = FIXED_TEST_ERROR_NONE;
+
+  // Q16(value)
+  {
+    q16 value = Q16(1.5);
+    q16 expected = 0x00018000;
+    if (value != expected) {
+      errorCode = FIXED_TEST_ERROR_Q16_CONSTANT;
+      goto end;
+    }
+  }
+
+  // q16_from_f32(f32 value)
+  {
+    q16 value, expected;
+
+    value = q16_from_f32(2.25f);
+    expected = 0x00024000;
+    if (value != expected) {
+      errorCode = FIXED_TEST_ERROR_Q16_FROM_F32;
+      goto end;
+    }
+
+    value = q16_from_f32(-2.25f);
+    expected = -0x00024000;
+    if (value != expected) {
+      errorCode = FIXED_TEST_ERROR_Q16_FROM_F32_NEGATIVE;
+      goto end;
+    }
+  }
+
+  // q16_to_f32(q16 value)
+  {
+    f32 value = q16_to_f32(Q16(-3.75));
+    f32 expected = -3.75f;
+    if (value != expected) {
+      errorCode = FIXED_TEST_ERROR_Q16_TO_F32;
+      goto end;
+    }
+  }
+
+  // q16_mul(q16 a, q16 b)
+  {
+    q16 value, expected;
+
+    value = q16_mul(Q16(1.5), Q16(2.5));
+    expected = Q16(3.75);
+    if (value != expected) {
+      errorCode = FIXED_TEST_ERROR_Q16_MUL;
+      goto end;
+    }
+
+    value = q16_mul(Q16(-1.5), Q16(2.5));
+    expected = Q16(-3.75);
+    if (value != expected) {
+      errorCode = FIXED_TEST_ERROR_Q16_MUL_NEGATIVE;
+      goto end;
+    }
+  }
+
+  // q16_div(q16 a, q16 b)
+  {
+    q16 value, expected;
+
+    value = q16_div(Q16(7.5), Q16(2.5));
+    expected = Q16(3.0);
+    if (value != expected) {
+      errorCode = FIXED_TEST_ERROR_Q16_DIV;
+      goto end;
+    }
+
+    value = q16_div(Q16(1.0), Q16(-4.0));
+    expected = Q16(-0.25);
+    if (value != expected) {
+      errorCode = FIXED_TEST_ERROR_Q16_DIV_NEGATIVE;
+      goto end;
+    }
+  }
+
+  // SquareRootU64(u64 value)
+  {
+    for (u64 root = 0; root < 100000; root++) {
+      u64 square = root * root;
+      if (SquareRootU64(square) != root || (root > 0 && SquareRootU64(square - 1) != root - 1)) {
+        errorCode = FIXED_TEST_ERROR_SQUARE_ROOT_U64;
+        goto end;
+      }
+    }
+
+    if (SquareRootU64(U64_MAX) != U32_MAX) {
+      errorCode = FIXED_TEST_ERROR_SQUARE_ROOT_U64_MAX;
+      goto end;
+    }
+  }
+
+  // q16_sqrt(q16 value)
+  {
+    q16 value = q16_sqrt(Q16(2.25));
+    q16 expected = Q16(1.5);
+    if (value != expected) {
+      errorCode = FIXED_TEST_ERROR_Q16_SQRT;
+      goto end;
+    }
+  }
+
+  // q16_sin(q16 angle)
+  {
+    // every 1/16 rad in [-8π, 8π], so every reduction branch is taken
+    for (s32 step = -402; step <= 402; step++) {
+      f64 radians = (f64)step / 16.0;
+      q16 value = q16_sin(Q16(radians));
+      q16 expected = Q16(__builtin_sin(radians));
+      if (q16_abs(value - expected) > Q16(0.0002)) {
+        errorCode = FIXED_TEST_ERROR_Q16_SIN;
+        goto end;
+      }
+    }
+  }
+
+  // q16_cos(q16 angle)
+  {
+    for (s32 step = -402; step <= 402; step++) {
+      f64 radians = (f64)step / 16.0;
+      q16 value = q16_cos(Q16(radians));
+      q16 expected = Q16(__builtin_cos(radians));
+      if (q16_abs(value - expected) > Q16(0.0002)) {
+        errorCode = FIXED_TEST_ERROR_Q16_COS;
+        goto end;
+      }
+    }
+  }
+
+  // v2q_add(v2q a, v2q b)
+  {
+    v2q value = v2q_add((v2q){Q16(3.0), Q16(4.0)}, (v2q){Q16(9.0), Q16(-12.0)});
+    v2q expected = {Q16(12.0), Q16(-8.0)};
+    if (value.x != expected.x || value.y != expected.y) {
+      errorCode = FIXED_TEST_ERROR_V2Q_ADD;
+      goto end;
+    }
+  }
+
+  // v2q_sub(v2q a, v2q b)
+  {
+    v2q value = v2q_sub((v2q){Q16(9.0), Q16(12.0)}, (v2q){Q16(3.0), Q16(4.0)});
+    v2q expected = {Q16(6.0), Q16(8.0)};
+    if (value.x != expected.x || value.y != expected.y) {
+      errorCode = FIXED_TEST_ERROR_V2Q_SUB;
+      goto end;
+    }
+  }
+
+  // v2q_scale(v2q a, q16 scaler)
+  {
+    v2q value = v2q_scale((v2q){Q16(3.0), Q16(-4.0)}, Q16(0.5));
+    v2q expected = {Q16(1.5), Q16(-2.0)};
+    if (value.x != expected.x || value.y != expected.y) {
+      errorCode = FIXED_TEST_ERROR_V2Q_SCALE;
+      goto end;
+    }
+  }
+
+  // v2q_dot(v2q a, v2q b)
+  {
+    q16 value = v2q_dot((v2q){Q16(3.0), Q16(4.0)}, (v2q){Q16(9.0), Q16(12.0)});
+    q16 expected = Q16(3.0 * 9.0 + 4.0 * 12.0);
+    if (value != expected) {
+      errorCode = FIXED_TEST_ERROR_V2Q_DOT;
+      goto end;
+    }
+  }
+
+  // v2q_length(v2q a)
+  {
+    q16 value = v2q_length((v2q){Q16(-3.0), Q16(4.0)});
+    q16 expected = Q16(5.0);
+    if (value != expected) {
+      errorCode = FIXED_TEST_ERROR_V2Q_LENGTH;
+      goto end;
+    }
+  }
+
+  // v2q_normalize(v2q a)
+  {
+    v2q value, expected;
+
+    value = v2q_normalize((v2q){Q16(3.0), Q16(4.0)});
+    expected = (v2q){Q16(3.0 / 5.0), Q16(4.0 / 5.0)};
+    // rounds toward negative infinity, at most 1 unit difference
+    if (q16_abs(value.x - expected.x) > 1 || q16_abs(value.y - expected.y) > 1) {
+      errorCode = FIXED_TEST_ERROR_V2Q_NORMALIZE;
+      goto end;
+    }
+
+    value = v2q_normalize((v2q){0, 0});
+    if (value.x != 0 || value.y != 0) {
+      errorCode = FIXED_TEST_ERROR_V2Q_NORMALIZE_ZERO;
+      goto end;
+    }
+  }
+
+  // v2q_rotate(v2q a, q16 radians)
+  {
+    v2q value = v2q_rotate((v2q){Q16(2.0), Q16(0.0)}, Q16_PI / 2);
+    v2q expected = {Q16(0.0), Q16(2.0)};
+    if (q16_abs(value.x - expected.x) > Q16(0.0005) || q16_abs(value.y - expected.y) > Q16(0.0005)) {
+      errorCode = FIXED_TEST_ERROR_V2Q_ROTATE;
+      goto end;
+    }
+  }
+
+end:
+  return (int)errorCode;
+}
@@ -0,0 +1,106 @@
+#include "hash.h"
+
+// TODO: Show error pretty error message when a test fails
+enum hash_test_error {
+  HASH_TEST_ERROR_NONE = 0,
+  HASH_TEST_ERROR_HASH64_EXPECTED_KNOWN_VALUE,
+  HASH_TEST_ERROR_HASH64_EXPECTED_SAME_HASH_WHEN_UNALIGNED,
+  HASH_TEST_ERROR_HASH64_EXPECTED_DIFFERENT_HASH_WHEN_BIT_FLIPPED,
+  HASH_TEST_ERROR_HASH64_EXPECTED_DIFFERENT_HASH_WHEN_ZERO_APPENDED,
+  HASH_TEST_ERROR_HASH64_EXPECTED_DIFFERENT_HASH_WHEN_SEED_CHANGED,
+
+  // src: https://mesonbuild.com/Unit-tests.html#skipped-tests-and-hard-errors
+  // For the default exitcode testing protocol, the GNU standard approach in
+  // this case is to exit the program with error code 77. Meson will detect this
+  // and report these tests as skipped rather than failed. This behavior was
+  // added in version 0.37.0.
+  MESON_TEST_SKIP = 77,
+  // In addition, sometimes a test fails set up so that it should fail even if
+  // it is marked as an expected failure. The GNU standard approach in this case
+  // is to exit the program with error code 99. Again, Meson will detect this
+  // and report these tests as ERROR, ignoring the setting of should_fail. This
+  // behavior was added in version 0.50.0.
+  MESON_TEST_FAILED_TO_SET_UP = 99,
+};
+
+int
+main(void)
+{
+  enum hash_test_error errorCode = HASH_TEST_ERROR_NONE;
+
+  u8 bytes[3000 + 1];
+  for (u32 index = 0; index < ARRAY_COUNT(bytes); index++)
+    bytes[index] = (u8)(index * 7 + 3);
+
+  // u64 Hash64(void *data, u64 size, u64 seed)
+  // values must not change between builds and machines, recordings depend on them
+  {
+    struct {
+      u64 size;
+      u64 expected;
+    } testCases[] = {
+        {0, 0xd91b00b4f881d774ull},    {1, 0x798a6fef460f5c76ull},    {3, 0x318694d6ca5c70c2ull},
+        {8, 0xe2357e227979b303ull},    {63, 0x421a827a5c0f6554ull},   {64, 0x944f8c83ac16c4c2ull},
+        {65, 0xf30452d0cbb9e85cull},   {127, 0x1ba0a088faa5b65full},  {128, 0x083249dac26cbe9aull},
+        {1024, 0xcbee56301d8dd490ull}, {1025, 0x57375c4c42a7a46dull}, {2047, 0x06f8d80405bc1c45ull},
+        {3000, 0x0b255bf90ceca196ull},
+    };
+    for (u32 testCaseIndex = 0; testCaseIndex < ARRAY_COUNT(testCases); testCaseIndex++) {
+      u64 value = Hash64(bytes, testCases[testCaseIndex].size, 0);
+      if (value != testCases[testCaseIndex].expected) {
+        errorCode = HASH_TEST_ERROR_HASH64_EXPECTED_KNOWN_VALUE;
+        goto end;
+      }
+    }
+
+    if (Hash64(bytes, 100, 42) != 0x3e726da2a7535e95ull) {
+      errorCode = HASH_TEST_ERROR_HASH64_EXPECTED_KNOWN_VALUE;
+      goto end;
+    }
+  }
+
+  {
+    u8 unaligned[3000 + 1];
+    memcpy(unaligned + 1, bytes, 3000);
+    if (Hash64(unaligned + 1, 3000, 0) != Hash64(bytes, 3000, 0)) {
+      errorCode = HASH_TEST_ERROR_HASH64_EXPECTED_SAME_HASH_WHEN_UNALIGNED;
+      goto end;
+    }
+  }
+
+  {
+    u64 sizes[] = {1, 63, 64, 65, 1500, 3000};
+    for (u32 sizeIndex = 0; sizeIndex < ARRAY_COUNT(sizes); sizeIndex++) {
+      u64 size = sizes[sizeIndex];
+      u64 expected = Hash64(bytes, size, 0);
+      // first, middle and last byte
+      u64 flipIndices[] = {0, size / 2, size - 1};
+      for (u32 flipIndex = 0; flipIndex < ARRAY_COUNT(flipIndices); flipIndex++) {
+        u8 *flipped = bytes + flipIndices[flipIndex];
+        *flipped ^= 0x10;
+        u64 value = Hash64(bytes, size, 0);
+        *flipped ^= 0x10;
+        if (value == expected) {
+          errorCode = HASH_TEST_ERROR_HASH64_EXPECTED_DIFFERENT_HASH_WHEN_BIT_FLIPPED;
+          goto end;
+        }
+      }
+    }
+  }
+
+  {
+    u8 zeros[65] = {};
+    if (Hash64(zeros, 0, 0) == Hash64(zeros, 1, 0) || Hash64(zeros, 64, 0) == Hash64(zeros, 65, 0)) {
+      errorCode = HASH_TEST_ERROR_HASH64_EXPECTED_DIFFERENT_HASH_WHEN_ZERO_APPENDED;
+      goto end;
+    }
+  }
+
+  if (Hash64(bytes, 3000, 0) == Hash64(bytes, 3000, 1)) {
+    errorCode = HASH_TEST_ERROR_HASH64_EXPECTED_DIFFERENT_HASH_WHEN_SEED_CHANGED;
+    goto end;
+  }
+
+end:
+  return (int)errorCode;
+}
@@ -0,0 +1,123 @@
+#include "histogram.h"
+
+// TODO: Show error pretty error message when a test fails
+enum histogram_test_error {
+  HISTOGRAM_TEST_ERROR_NONE = 0,
+  HISTOGRAM_TEST_ERROR_BUCKET_EXPECTED_TO_CONTAIN_VALUE,
+  HISTOGRAM_TEST_ERROR_BUCKET_EXPECTED_PRECISION,
+  HISTOGRAM_TEST_ERROR_BUCKET_EXPECTED_NEIGHBOURS,
+  HISTOGRAM_TEST_ERROR_RECORD_EXPECTED_MIN_MAX,
+  HISTOGRAM_TEST_ERROR_RECORD_EXPECTED_CLAMPED,
+  HISTOGRAM_TEST_ERROR_PERCENTILE_EXPECTED_ZERO_WHEN_EMPTY,
+  HISTOGRAM_TEST_ERROR_PERCENTILE_EXPECTED_VALUE,
+
+  // src: https://mesonbuild.com/Unit-tests.html#skipped-tests-and-hard-errors
+  // For the default exitcode testing protocol, the GNU standard approach in
+  // this case is to exit the program with error code 77. Meson will detect this
+  // and report these tests as skipped rather than failed. This behavior was
+  // added in version 0.37.0.
+  MESON_TEST_SKIP = 77,
+  // In addition, sometimes a test fails set up so that it should fail even if
+  // it is marked as an expected failure. The GNU standard approach in this case
+  // is to exit the program with error code 99. Again, Meson will detect this
+  // and report these tests as ERROR, ignoring the setting of should_fail. This
+  // behavior was added in version 0.50.0.
+  MESON_TEST_FAILED_TO_SET_UP = 99,
+};
+
+// too large for stack
+static histogram globalHistogram;
+
+int
+main(void)
+{
+  enum histogram_test_error errorCode = HISTOGRAM_TEST_ERROR_NONE;
+
+  // u32 HistogramBucketIndex(u64 value)
+  {
+    u64 values[] = {0, 1, 127, 128, 129, 255, 256, 1000, 16666666, 1ull << 39, HISTOGRAM_VALUE_MAX};
+    for (u32 valueIndex = 0; valueIndex < ARRAY_COUNT(values); valueIndex++) {
+      u64 value = values[valueIndex];
+      u32 index = HistogramBucketIndex(value);
+      u64 lowest = HistogramBucketLowestValue(index);
+      u64 highest = HistogramBucketHighestValue(index);
+      if (index >= HISTOGRAM_BUCKET_COUNT || value < lowest || value > highest) {
+        errorCode = HISTOGRAM_TEST_ERROR_BUCKET_EXPECTED_TO_CONTAIN_VALUE;
+        goto end;
+      }
+      // width of bucket is at most 1/64 of its values
+      if ((highest - lowest + 1) * HISTOGRAM_SUB_BUCKET_HALF_COUNT > (lowest > 64 ? lowest : 64)) {
+        errorCode = HISTOGRAM_TEST_ERROR_BUCKET_EXPECTED_PRECISION;
+        goto end;
+      }
+    }
+  }
+
+  // buckets cover every value without gaps
+  for (u32 index = 0; index + 1 < HISTOGRAM_BUCKET_COUNT; index++) {
+    if (HistogramBucketHighestValue(index) + 1 != HistogramBucketLowestValue(index + 1)) {
+      errorCode = HISTOGRAM_TEST_ERROR_BUCKET_EXPECTED_NEIGHBOURS;
+      goto end;
+    }
+  }
+  if (HistogramBucketHighestValue(HISTOGRAM_BUCKET_COUNT - 1) != HISTOGRAM_VALUE_MAX) {
+    errorCode = HISTOGRAM_TEST_ERROR_BUCKET_EXPECTED_NEIGHBOURS;
+    goto end;
+  }
+
+  // void HistogramRecord(histogram *histogram, u64 value)
+  {
+    histogram *histogram = &globalHistogram;
+    HistogramReset(histogram);
+    if (HistogramValueAtPercentile(histogram, 50.0) != 0) {
+      errorCode = HISTOGRAM_TEST_ERROR_PERCENTILE_EXPECTED_ZERO_WHEN_EMPTY;
+      goto end;
+    }
+
+    HistogramRecord(histogram, 300);
+    HistogramRecord(histogram, 7);
+    HistogramRecord(histogram, 12345);
+    if (histogram->totalCount != 3 || histogram->min != 7 || histogram->max != 12345) {
+      errorCode = HISTOGRAM_TEST_ERROR_RECORD_EXPECTED_MIN_MAX;
+      goto end;
+    }
+
+    HistogramRecord(histogram, U64_MAX);
+    if (histogram->max != HISTOGRAM_VALUE_MAX || histogram->counts[HISTOGRAM_BUCKET_COUNT - 1] != 1) {
+      errorCode = HISTOGRAM_TEST_ERROR_RECORD_EXPECTED_CLAMPED;
+      goto end;
+    }
+  }
+
+  // u64 HistogramValueAtPercentile(histogram *histogram, f64 percentile)
+  {
+    histogram *histogram = &globalHistogram;
+    HistogramReset(histogram);
+    // 1..1000 microseconds in nanoseconds
+    for (u64 value = 1; value <= 1000; value++)
+      HistogramRecord(histogram, value * 1000);
+
+    struct {
+      f64 percentile;
+      u64 expected;
+    } testCases[] = {
+        {0.0, 1000}, {50.0, 500000}, {90.0, 900000}, {99.0, 990000}, {99.9, 999000}, {100.0, 1000000},
+    };
+    for (u32 testCaseIndex = 0; testCaseIndex < ARRAY_COUNT(testCases); testCaseIndex++) {
+      u64 expected = testCases[testCaseIndex].expected;
+      u64 value = HistogramValueAtPercentile(histogram, testCases[testCaseIndex].percentile);
+      // reported value is highest of its bucket, so at most 1/64 above
+      if (value < expected || value > expected + expected / HISTOGRAM_SUB_BUCKET_HALF_COUNT) {
+        errorCode = HISTOGRAM_TEST_ERROR_PERCENTILE_EXPECTED_VALUE;
+        goto end;
+      }
+    }
+    if (HistogramValueAtPercentile(histogram, 100.0) != 1000000) {
+      errorCode = HISTOGRAM_TEST_ERROR_PERCENTILE_EXPECTED_VALUE;
+      goto end;
+    }
+  }
+
+end:
+  return (int)errorCode;
+}
@@ -20,6 +20,13 @@ enum math_test_error {
   MATH_TEST_ERROR_V2_NEG,
   MATH_TEST_ERROR_IS_POINT_INSIDE_RECT_EXPECTED_TRUE,
   MATH_TEST_ERROR_IS_POINT_INSIDE_RECT_EXPECTED_FALSE,
+  MATH_TEST_ERROR_M2X3_IDENTITY,
+  MATH_TEST_ERROR_M2X3_TRANSFORM,
+  MATH_TEST_ERROR_M2X3_TRANSFORM_VECTOR,
+  MATH_TEST_ERROR_M2X3_ROTATION,
+  MATH_TEST_ERROR_M2X3_MUL,
+  MATH_TEST_ERROR_M2X3_INVERT,
+  MATH_TEST_ERROR_M2X3_TRANSFORM_ARRAY,
 
   // src: https://mesonbuild.com/Unit-tests.html#skipped-tests-and-hard-errors
   // For the default exitcode testing protocol, the GNU standard approach in
@@ -254,6 +261,104 @@ main(void)
     }
   }
 
+  // m2x3_identity(void)
+  {
+    m2x3 m = m2x3_identity();
+    struct v2 point = {3.0f, -4.0f};
+    struct v2 value = m2x3_transform(m, point);
+    if (value.x != point.x || value.y != point.y) {
+      errorCode = MATH_TEST_ERROR_M2X3_IDENTITY;
+      goto end;
+    }
+  }
+
+  // m2x3_transform(m2x3 m, v2 p)
+  {
+    m2x3 m = {
+        .x = {2.0f, 0.0f},
+        .y = {0.0f, -3.0f},
+        .origin = {10.0f, 20.0f},
+    };
+    struct v2 point = {1.0f, 2.0f};
+    struct v2 expected = {12.0f, 14.0f};
+    struct v2 value = m2x3_transform(m, point);
+    if (value.x != expected.x || value.y != expected.y) {
+      errorCode = MATH_TEST_ERROR_M2X3_TRANSFORM;
+      goto end;
+    }
+  }
+
+  // m2x3_transform_vector(m2x3 m, v2 v)
+  {
+    m2x3 m = m2x3_translation((v2){10.0f, 20.0f});
+    struct v2 vector = {1.0f, 2.0f};
+    struct v2 value = m2x3_transform_vector(m, vector);
+    if (value.x != vector.x || value.y != vector.y) {
+      errorCode = MATH_TEST_ERROR_M2X3_TRANSFORM_VECTOR;
+      goto end;
+    }
+  }
+
+  // m2x3_rotation(f32 radians)
+  {
+    // quarter turn counter-clockwise
+    m2x3 m = m2x3_rotation(1.5707963267948966f);
+    struct v2 point = {1.0f, 0.0f};
+    struct v2 expected = {0.0f, 1.0f};
+    struct v2 value = m2x3_transform(m, point);
+    f32 epsilon = 1e-6f;
+    if (v2_length(v2_sub(value, expected)) > epsilon) {
+      errorCode = MATH_TEST_ERROR_M2X3_ROTATION;
+      goto end;
+    }
+  }
+
+  // m2x3_mul(m2x3 a, m2x3 b)
+  {
+    // scale first, then translate
+    m2x3 m = m2x3_mul(m2x3_translation((v2){1.0f, 2.0f}), m2x3_scale((v2){2.0f, 3.0f}));
+    struct v2 point = {5.0f, 7.0f};
+    struct v2 expected = {11.0f, 23.0f};
+    struct v2 value = m2x3_transform(m, point);
+    if (value.x != expected.x || value.y != expected.y) {
+      errorCode = MATH_TEST_ERROR_M2X3_MUL;
+      goto end;
+    }
+  }
+
+  // m2x3_invert(m2x3 m)
+  {
+    m2x3 m = m2x3_mul(m2x3_translation((v2){640.0f, 360.0f}), m2x3_scale((v2){60.0f, -60.0f}));
+    m2x3 inverse = m2x3_invert(m);
+    struct v2 point = {-3.0f, 2.5f};
+    struct v2 value = m2x3_transform(inverse, m2x3_transform(m, point));
+    f32 epsilon = 1e-5f;
+    if (v2_length(v2_sub(value, point)) > epsilon) {
+      errorCode = MATH_TEST_ERROR_M2X3_INVERT;
+      goto end;
+    }
+  }
+
+  // m2x3_transform_array(m2x3 m, v2 *src, v2 *dest, u64 count)
+  {
+    m2x3 m = m2x3_mul(m2x3_translation((v2){640.0f, 360.0f}), m2x3_rotation(0.5f));
+    struct v2 points[17];
+    struct v2 transformed[ARRAY_COUNT(points)];
+    for (u32 index = 0; index < ARRAY_COUNT(points); index++)
+      points[index] = (v2){(f32)index, -(f32)index * 0.5f};
+
+    m2x3_transform_array(m, points, transformed, ARRAY_COUNT(points));
+    for (u32 index = 0; index < ARRAY_COUNT(points); index++) {
+      struct v2 expected = m2x3_transform(m, points[index]);
+      struct v2 value = transformed[index];
+      f32 epsilon = 1e-3f;
+      if (v2_length(v2_sub(value, expected)) > epsilon) {
+        errorCode = MATH_TEST_ERROR_M2X3_TRANSFORM_ARRAY;
+        goto end;
+      }
+    }
+  }
+
 end:
   return (int)errorCode;
 }
@@ -0,0 +1,321 @@
+#include "rewind.c"
+
+// TODO: Show error pretty error message when a test fails
+enum rewind_test_error {
+  REWIND_TEST_ERROR_NONE = 0,
+  REWIND_TEST_ERROR_INIT_EXPECTED_DISABLED,
+  REWIND_TEST_ERROR_INIT_EXPECTED_ENABLED,
+  REWIND_TEST_ERROR_DISABLED_EXPECTED_NO_FRAME,
+  REWIND_TEST_ERROR_CAPTURE_EXPECTED_FRAME_COUNT,
+  REWIND_TEST_ERROR_RESTORE_EXPECTED_SUCCESS,
+  REWIND_TEST_ERROR_RESTORE_EXPECTED_STATE,
+  REWIND_TEST_ERROR_RESTORE_EXPECTED_FAILURE_OUTSIDE_RING,
+  REWIND_TEST_ERROR_EVICTION_EXPECTED_FRAME_COUNT,
+  REWIND_TEST_ERROR_EVICTION_EXPECTED_OLDEST_KEYFRAME,
+  REWIND_TEST_ERROR_TRUNCATE_EXPECTED_SUCCESS,
+  REWIND_TEST_ERROR_TRUNCATE_EXPECTED_FRAME_COUNT,
+  REWIND_TEST_ERROR_TRUNCATE_EXPECTED_FAILURE_OUTSIDE_RING,
+  REWIND_TEST_ERROR_RESET_EXPECTED_EMPTY,
+
+  // src: https://mesonbuild.com/Unit-tests.html#skipped-tests-and-hard-errors
+  // For the default exitcode testing protocol, the GNU standard approach in
+  // this case is to exit the program with error code 77. Meson will detect this
+  // and report these tests as skipped rather than failed. This behavior was
+  // added in version 0.37.0.
+  MESON_TEST_SKIP = 77,
+  // In addition, sometimes a test fails set up so that it should fail even if
+  // it is marked as an expected failure. The GNU standard approach in this case
+  // is to exit the program with error code 99. Again, Meson will detect this
+  // and report these tests as ERROR, ignoring the setting of should_fail. This
+  // behavior was added in version 0.50.0.
+  MESON_TEST_FAILED_TO_SET_UP = 99,
+};
+
+// size is not multiple of REWIND_BLOCK_SIZE, so its tail block is padded
+typedef struct {
+  u32 frame;
+  u32 seed;
+  f32 time;
+  u32 unchanged[2];
+} test_header;
+
+#define TEST_PARTICLE_COUNT 1000
+
+static test_header globalHeader;
+static u32 globalParticles[TEST_PARTICLE_COUNT];
+static u8 globalMemory[1 << 20];
+
+/* Writes state of frame into streams, only some particles change every frame. */
+static void
+FillFrame(u32 frame)
+{
+  globalHeader = (test_header){
+      .frame = frame,
+      .seed = frame * 2654435761u,
+      .time = (f32)frame / 60.0f,
+      .unchanged = {7, 11},
+  };
+  for (u32 particleIndex = 0; particleIndex < TEST_PARTICLE_COUNT; particleIndex++) {
+    u32 changedAt = frame - frame % (particleIndex % 5 + 1);
+    globalParticles[particleIndex] = particleIndex * 31 + changedAt * 1000003u;
+  }
+}
+
+/* @return 1 when streams hold state of frame */
+static b8
+IsFrame(u32 frame)
+{
+  test_header header = globalHeader;
+  u32 particles[TEST_PARTICLE_COUNT];
+  for (u32 particleIndex = 0; particleIndex < TEST_PARTICLE_COUNT; particleIndex++)
+    particles[particleIndex] = globalParticles[particleIndex];
+
+  FillFrame(frame);
+  b8 isEqual = header.frame == globalHeader.frame && header.seed == globalHeader.seed &&
+               header.time == globalHeader.time && header.unchanged[0] == globalHeader.unchanged[0] &&
+               header.unchanged[1] == globalHeader.unchanged[1];
+  for (u32 particleIndex = 0; particleIndex < TEST_PARTICLE_COUNT; particleIndex++) {
+    if (particles[particleIndex] != globalParticles[particleIndex])
+      isEqual = 0;
+  }
+  return isEqual;
+}
+
+static memory_arena
+TestArena(u64 size)
+{
+  debug_assert(size <= sizeof(globalMemory));
+  return (memory_arena){
+      .block = globalMemory,
+      .total = size,
+  };
+}
+
+int
+main(void)
+{
+  enum rewind_test_error errorCode = REWIND_TEST_ERROR_NONE;
+
+  rewind_stream streams[] = {
+      {&globalHeader, sizeof(globalHeader)},
+      {globalParticles, sizeof(globalParticles)},
+  };
+  u64 stateSize = RewindStateSize(streams, ARRAY_COUNT(streams));
+  rewind_buffer buffer;
+
+  // buffer is disabled when arena cannot fit one keyframe
+  {
+    memory_arena arena = TestArena(stateSize);
+    RewindBufferInit(&buffer, &arena, stateSize, 64, 8, streams, ARRAY_COUNT(streams));
+    if (buffer.data != 0 || arena.used != 0) {
+      errorCode = REWIND_TEST_ERROR_INIT_EXPECTED_DISABLED;
+      goto end;
+    }
+
+    FillFrame(0);
+    RewindBufferCapture(&buffer, streams, ARRAY_COUNT(streams));
+    if (buffer.frameCount != 0 || RewindBufferRestore(&buffer, streams, ARRAY_COUNT(streams), 0) ||
+        RewindBufferTruncate(&buffer, streams, ARRAY_COUNT(streams), 0)) {
+      errorCode = REWIND_TEST_ERROR_DISABLED_EXPECTED_NO_FRAME;
+      goto end;
+    }
+  }
+
+  // every captured frame is restored as it was captured
+  {
+    memory_arena arena = TestArena(sizeof(globalMemory));
+    RewindBufferInit(&buffer, &arena, arena.total, 64, 8, streams, ARRAY_COUNT(streams));
+    if (buffer.data == 0) {
+      errorCode = REWIND_TEST_ERROR_INIT_EXPECTED_ENABLED;
+      goto end;
+    }
+
+    u32 frameCount = 30;
+    for (u32 frame = 0; frame < frameCount; frame++) {
+      FillFrame(frame);
+      RewindBufferCapture(&buffer, streams, ARRAY_COUNT(streams));
+    }
+    if (buffer.frameCount != frameCount) {
+      errorCode = REWIND_TEST_ERROR_CAPTURE_EXPECTED_FRAME_COUNT;
+      goto end;
+    }
+
+    // newest to oldest, then back, restore does not depend on previous one
+    for (u32 framesAgo = 0; framesAgo < frameCount; framesAgo++) {
+      if (!RewindBufferRestore(&buffer, streams, ARRAY_COUNT(streams), framesAgo)) {
+        errorCode = REWIND_TEST_ERROR_RESTORE_EXPECTED_SUCCESS;
+        goto end;
+      }
+      if (!IsFrame(frameCount - 1 - framesAgo)) {
+        errorCode = REWIND_TEST_ERROR_RESTORE_EXPECTED_STATE;
+        goto end;
+      }
+    }
+    for (u32 framesAgo = frameCount; framesAgo > 0; framesAgo--) {
+      RewindBufferRestore(&buffer, streams, ARRAY_COUNT(streams), framesAgo - 1);
+      if (!IsFrame(frameCount - framesAgo)) {
+        errorCode = REWIND_TEST_ERROR_RESTORE_EXPECTED_STATE;
+        goto end;
+      }
+    }
+
+    if (RewindBufferRestore(&buffer, streams, ARRAY_COUNT(streams), frameCount)) {
+      errorCode = REWIND_TEST_ERROR_RESTORE_EXPECTED_FAILURE_OUTSIDE_RING;
+      goto end;
+    }
+  }
+
+  // when frame table is full, oldest keyframe goes with its deltas
+  {
+    memory_arena arena = TestArena(sizeof(globalMemory));
+    u32 frameMax = 20;
+    u32 keyframeInterval = 8;
+    RewindBufferInit(&buffer, &arena, arena.total, frameMax, keyframeInterval, streams, ARRAY_COUNT(streams));
+
+    u32 frameCount = 100;
+    for (u32 frame = 0; frame < frameCount; frame++) {
+      FillFrame(frame);
+      RewindBufferCapture(&buffer, streams, ARRAY_COUNT(streams));
+      if (buffer.frameCount > frameMax) {
+        errorCode = REWIND_TEST_ERROR_EVICTION_EXPECTED_FRAME_COUNT;
+        goto end;
+      }
+      if (!RewindBufferGetFrame(&buffer, 0)->isKeyframe) {
+        errorCode = REWIND_TEST_ERROR_EVICTION_EXPECTED_OLDEST_KEYFRAME;
+        goto end;
+      }
+    }
+    if (buffer.frameCount <= frameMax - keyframeInterval) {
+      errorCode = REWIND_TEST_ERROR_EVICTION_EXPECTED_FRAME_COUNT;
+      goto end;
+    }
+
+    for (u32 framesAgo = 0; framesAgo < buffer.frameCount; framesAgo++) {
+      RewindBufferRestore(&buffer, streams, ARRAY_COUNT(streams), framesAgo);
+      if (!IsFrame(frameCount - 1 - framesAgo)) {
+        errorCode = REWIND_TEST_ERROR_RESTORE_EXPECTED_STATE;
+        goto end;
+      }
+    }
+  }
+
+  // when ring wraps around, frames that are written over are dropped
+  {
+    // index tables, reference, scratch, frame table and slack, then ring of about 3 keyframes
+    u32 frameMax = 600;
+    u64 fixedSize = 2 * 256 * 8 * sizeof(u32) + 2 * stateSize + sizeof(rewind_frame) * frameMax + 4 * REWIND_BLOCK_SIZE;
+    memory_arena arena = TestArena(sizeof(globalMemory));
+    RewindBufferInit(&buffer, &arena, fixedSize + 3 * stateSize, frameMax, 4, streams, ARRAY_COUNT(streams));
+    if (buffer.data == 0) {
+      errorCode = REWIND_TEST_ERROR_INIT_EXPECTED_ENABLED;
+      goto end;
+    }
+
+    u32 frameCount = 200;
+    for (u32 frame = 0; frame < frameCount; frame++) {
+      FillFrame(frame);
+      RewindBufferCapture(&buffer, streams, ARRAY_COUNT(streams));
+      if (buffer.frameCount == 0 || !RewindBufferGetFrame(&buffer, 0)->isKeyframe) {
+        errorCode = REWIND_TEST_ERROR_EVICTION_EXPECTED_OLDEST_KEYFRAME;
+        goto end;
+      }
+    }
+    if (buffer.frameCount >= frameCount) {
+      errorCode = REWIND_TEST_ERROR_EVICTION_EXPECTED_FRAME_COUNT;
+      goto end;
+    }
+
+    for (u32 framesAgo = 0; framesAgo < buffer.frameCount; framesAgo++) {
+      RewindBufferRestore(&buffer, streams, ARRAY_COUNT(streams), framesAgo);
+      if (!IsFrame(frameCount - 1 - framesAgo)) {
+        errorCode = REWIND_TEST_ERROR_RESTORE_EXPECTED_STATE;
+        goto end;
+      }
+    }
+  }
+
+  // b8 RewindBufferTruncate(rewind_buffer *buffer, rewind_stream *streams, u32 streamCount, u32 framesAgo)
+  {
+    memory_arena arena = TestArena(sizeof(globalMemory));
+    RewindBufferInit(&buffer, &arena, arena.total, 64, 8, streams, ARRAY_COUNT(streams));
+
+    u32 frameCount = 20;
+    for (u32 frame = 0; frame < frameCount; frame++) {
+      FillFrame(frame);
+      RewindBufferCapture(&buffer, streams, ARRAY_COUNT(streams));
+    }
+
+    if (RewindBufferTruncate(&buffer, streams, ARRAY_COUNT(streams), frameCount)) {
+      errorCode = REWIND_TEST_ERROR_TRUNCATE_EXPECTED_FAILURE_OUTSIDE_RING;
+      goto end;
+    }
+
+    // frame 13 is a delta, 8 is keyframe before it
+    if (!RewindBufferTruncate(&buffer, streams, ARRAY_COUNT(streams), 6)) {
+      errorCode = REWIND_TEST_ERROR_TRUNCATE_EXPECTED_SUCCESS;
+      goto end;
+    }
+    if (!IsFrame(13)) {
+      errorCode = REWIND_TEST_ERROR_RESTORE_EXPECTED_STATE;
+      goto end;
+    }
+    if (buffer.frameCount != 14) {
+      errorCode = REWIND_TEST_ERROR_TRUNCATE_EXPECTED_FRAME_COUNT;
+      goto end;
+    }
+
+    // captures continue from truncated frame, deltas are against it
+    u32 newFrames[] = {500, 501, 502, 503};
+    for (u32 newIndex = 0; newIndex < ARRAY_COUNT(newFrames); newIndex++) {
+      FillFrame(newFrames[newIndex]);
+      RewindBufferCapture(&buffer, streams, ARRAY_COUNT(streams));
+    }
+    if (buffer.frameCount != 14 + ARRAY_COUNT(newFrames)) {
+      errorCode = REWIND_TEST_ERROR_TRUNCATE_EXPECTED_FRAME_COUNT;
+      goto end;
+    }
+    for (u32 framesAgo = 0; framesAgo < buffer.frameCount; framesAgo++) {
+      RewindBufferRestore(&buffer, streams, ARRAY_COUNT(streams), framesAgo);
+      u32 expected = framesAgo < ARRAY_COUNT(newFrames) ? newFrames[ARRAY_COUNT(newFrames) - 1 - framesAgo]
+                                                        : 13 - (framesAgo - ARRAY_COUNT(newFrames));
+      if (!IsFrame(expected)) {
+        errorCode = REWIND_TEST_ERROR_RESTORE_EXPECTED_STATE;
+        goto end;
+      }
+    }
+  }
+
+  // void RewindBufferReset(rewind_buffer *buffer)
+  {
+    memory_arena arena = TestArena(sizeof(globalMemory));
+    RewindBufferInit(&buffer, &arena, arena.total, 64, 8, streams, ARRAY_COUNT(streams));
+    for (u32 frame = 0; frame < 5; frame++) {
+      FillFrame(frame);
+      RewindBufferCapture(&buffer, streams, ARRAY_COUNT(streams));
+    }
+
+    RewindBufferReset(&buffer);
+    if (buffer.frameCount != 0 || RewindBufferRestore(&buffer, streams, ARRAY_COUNT(streams), 0)) {
+      errorCode = REWIND_TEST_ERROR_RESET_EXPECTED_EMPTY;
+      goto end;
+    }
+
+    // first capture after reset is a keyframe, not a delta against old reference
+    FillFrame(900);
+    RewindBufferCapture(&buffer, streams, ARRAY_COUNT(streams));
+    FillFrame(901);
+    RewindBufferCapture(&buffer, streams, ARRAY_COUNT(streams));
+    if (buffer.frameCount != 2 || !RewindBufferGetFrame(&buffer, 0)->isKeyframe) {
+      errorCode = REWIND_TEST_ERROR_RESET_EXPECTED_EMPTY;
+      goto end;
+    }
+    RewindBufferRestore(&buffer, streams, ARRAY_COUNT(streams), 1);
+    if (!IsFrame(900)) {
+      errorCode = REWIND_TEST_ERROR_RESTORE_EXPECTED_STATE;
+      goto end;
+    }
+  }
+
+end:
+  return (int)errorCode;
+}
@@ -1,4 +1,5 @@
 #include "string_builder.h"
+#include <stdlib.h> // mkstemp()
 
 // TODO: Show error pretty error message when a test fails
 enum string_builder_test_error {
@@ -8,7 +9,12 @@ enum string_builder_test_error {
   STRING_BUILDER_TEST_ERROR_APPENDU64,
   STRING_BUILDER_TEST_ERROR_APPENDHEX,
   STRING_BUILDER_TEST_ERROR_APPENDF32,
+  STRING_BUILDER_TEST_ERROR_APPENDSHORTEST,
   STRING_BUILDER_TEST_ERROR_FLUSH,
+  STRING_BUILDER_TEST_ERROR_RESERVE,
+  STRING_BUILDER_TEST_ERROR_TRUNCATE,
+  STRING_BUILDER_TEST_ERROR_SINK_FD,
+  STRING_BUILDER_TEST_ERROR_SINK_ARENA,
 
   // src: https://mesonbuild.com/Unit-tests.html#skipped-tests-and-hard-errors
   // For the default exitcode testing protocol, the GNU standard approach in
@@ -35,14 +41,8 @@ main(void)
       .value = outBufferBytes,
       .length = sizeof(outBufferBytes),
   };
-  u8 stringBufferBytes[32];
-  string *stringBuffer = &(string){
-      .value = stringBufferBytes,
-      .length = sizeof(stringBufferBytes),
-  };
   string_builder *sb = &(string_builder){
       .outBuffer = outBuffer,
-      .stringBuffer = stringBuffer,
   };
 
   // StringBuilderAppendZeroTerminated(string_builder *stringBuilder, const char *src, u64 max)
@@ -105,6 +105,21 @@ main(void)
   }
   StringBuilderFlush(sb);
 
+  // StringBuilderAppendF32Shortest(string_builder *stringBuilder, f32 value)
+  // StringBuilderAppendF64Shortest(string_builder *stringBuilder, f64 value)
+  {
+    StringBuilderAppendF32Shortest(sb, 4.31f);
+    StringBuilderAppendString(sb, &STRING_FROM_ZERO_TERMINATED(" "));
+    StringBuilderAppendF64Shortest(sb, 0.1 + 0.2);
+
+    string value = StringBuilderFlush(sb);
+    string *expected = &STRING_FROM_ZERO_TERMINATED("4.31 0.30000000000000004");
+    if (!IsStringEqual(&value, expected)) {
+      errorCode = STRING_BUILDER_TEST_ERROR_APPENDSHORTEST;
+      goto end;
+    }
+  }
+
   // StringBuilderFlush(string_builder *stringBuilder)
   {
     StringBuilderAppendZeroTerminated(sb, "abc", 3);
@@ -126,6 +141,126 @@ main(void)
   }
   StringBuilderFlush(sb);
 
+  // StringBuilderReserve(string_builder *stringBuilder, u64 size)
+  {
+    u8 *dest = StringBuilderReserve(sb, 3);
+    if (!dest) {
+      errorCode = STRING_BUILDER_TEST_ERROR_RESERVE;
+      goto end;
+    }
+    dest[0] = 'x';
+    dest[1] = 'y';
+    StringBuilderCommit(sb, 2);
+    StringBuilderAppendU64(sb, 7);
+
+    string value = StringBuilderFlush(sb);
+    string *expected = &STRING_FROM_ZERO_TERMINATED("xy7");
+    if (!IsStringEqual(&value, expected) || StringBuilderReserve(sb, outBuffer->length + 1) != 0 ||
+        !sb->isTruncated) {
+      errorCode = STRING_BUILDER_TEST_ERROR_RESERVE;
+      goto end;
+    }
+    sb->isTruncated = 0;
+  }
+
+  // appends that do not fit are cut when there is no sink
+  {
+    u8 smallBytes[8];
+    string_builder *small = &(string_builder){
+        .outBuffer = &(string){.value = smallBytes, .length = sizeof(smallBytes)},
+    };
+    StringBuilderAppendString(small, &STRING_FROM_ZERO_TERMINATED("abcdef"));
+    StringBuilderAppendString(small, &STRING_FROM_ZERO_TERMINATED("ghijkl"));
+    StringBuilderAppendU64(small, 5439);
+
+    string value = StringBuilderFlushZeroTerminated(small);
+    string *expected = &STRING_FROM_ZERO_TERMINATED("abcdefg");
+    if (!IsStringEqual(&value, expected) || value.value[value.length] != 0 || !small->isTruncated) {
+      errorCode = STRING_BUILDER_TEST_ERROR_TRUNCATE;
+      goto end;
+    }
+  }
+
+  // StringBuilderAttachFd(string_builder *stringBuilder, s32 fd)
+  {
+    char path[] = "/tmp/string_builder_test_XXXXXX";
+    s32 fd = mkstemp(path);
+    if (fd < 0) {
+      errorCode = MESON_TEST_FAILED_TO_SET_UP;
+      goto end;
+    }
+    unlink(path);
+
+    u8 smallBytes[8];
+    string_builder *small = &(string_builder){
+        .outBuffer = &(string){.value = smallBytes, .length = sizeof(smallBytes)},
+    };
+    StringBuilderAttachFd(small, fd);
+    for (u64 value = 0; value < 100; value++) {
+      StringBuilderAppendU64(small, value);
+      StringBuilderAppendString(small, &STRING_FROM_ZERO_TERMINATED(","));
+    }
+    StringBuilderAppendString(small, &STRING_FROM_ZERO_TERMINATED("longer than out buffer\n"));
+    b8 isWritten = StringBuilderFlushToSink(small);
+
+    u8 fileBytes[512];
+    lseek(fd, 0, SEEK_SET);
+    ssize_t readSize = read(fd, fileBytes, sizeof(fileBytes));
+    close(fd);
+
+    u8 expectedBytes[512];
+    string_builder *expectedSb = &(string_builder){
+        .outBuffer = &(string){.value = expectedBytes, .length = sizeof(expectedBytes)},
+    };
+    for (u64 value = 0; value < 100; value++) {
+      StringBuilderAppendU64(expectedSb, value);
+      StringBuilderAppendString(expectedSb, &STRING_FROM_ZERO_TERMINATED(","));
+    }
+    StringBuilderAppendString(expectedSb, &STRING_FROM_ZERO_TERMINATED("longer than out buffer\n"));
+    string expected = StringBuilderFlush(expectedSb);
+    string value = {.value = fileBytes, .length = readSize > 0 ? (u64)readSize : 0};
+    if (!isWritten || !IsStringEqual(&value, &expected)) {
+      errorCode = STRING_BUILDER_TEST_ERROR_SINK_FD;
+      goto end;
+    }
+  }
+
+  // StringBuilderAttachArena(string_builder *stringBuilder, memory_arena *arena)
+  {
+    static u8 arenaBytes[3 * STRING_BUILDER_ARENA_BLOCK_SIZE];
+    memory_arena arena = {.block = arenaBytes, .total = sizeof(arenaBytes)};
+    u8 smallBytes[8];
+    string_builder *chained = &(string_builder){
+        .outBuffer = &(string){.value = smallBytes, .length = sizeof(smallBytes)},
+    };
+    StringBuilderAttachArena(chained, &arena);
+    for (u64 value = 0; value < 1000; value++)
+      StringBuilderAppendU64(chained, value % 10);
+    b8 isComplete = StringBuilderFlushToSink(chained);
+
+    u64 chunkCount = 0;
+    u64 digitIndex = 0;
+    for (string_builder_chunk *chunk = chained->firstChunk; chunk; chunk = chunk->next) {
+      chunkCount++;
+      for (u64 index = 0; index < chunk->string.length; index++, digitIndex++) {
+        if (chunk->string.value[index] != '0' + digitIndex % 10)
+          isComplete = 0;
+      }
+    }
+    if (!isComplete || digitIndex != 1000 || chunkCount != 2) {
+      errorCode = STRING_BUILDER_TEST_ERROR_SINK_ARENA;
+      goto end;
+    }
+
+    // builder stops when arena is full
+    for (u64 value = 0; value < 4 * STRING_BUILDER_ARENA_BLOCK_SIZE; value++)
+      StringBuilderAppendString(chained, &STRING_FROM_ZERO_TERMINATED("x"));
+    if (StringBuilderFlushToSink(chained) || arena.used > arena.total) {
+      errorCode = STRING_BUILDER_TEST_ERROR_SINK_ARENA;
+      goto end;
+    }
+  }
+
 end:
   return (int)errorCode;
 }
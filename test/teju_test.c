@@ -1,10 +1,16 @@
 #include "teju.h"
+#include <stdio.h>  // printf(), snprintf()
+#include <stdlib.h> // strtof(), strtod()
+#include <string.h> // memcpy()
+#include <time.h>   // clock_gettime()
 
 // TODO: Show error pretty error message when a test fails
 enum teju_test_error {
   TEJU_TEST_ERROR_NONE = 0,
   TEJU_TEST_ERROR_FORMATF32_EXPECTED_0_0,
   TEJU_TEST_ERROR_FORMATF32_EXPECTED_0_9,
+  TEJU_TEST_ERROR_FORMATF32_EXPECTED_0_500,
+  TEJU_TEST_ERROR_FORMATF32_EXPECTED_0_196,
   TEJU_TEST_ERROR_FORMATF32_EXPECTED_1_0,
   TEJU_TEST_ERROR_FORMATF32_EXPECTED_1_00,
   TEJU_TEST_ERROR_FORMATF32_EXPECTED_9_05,
@@ -21,6 +27,10 @@ enum teju_test_error {
   TEJU_TEST_ERROR_FORMATF32_EXPECTED_F32_MAX,
   TEJU_TEST_ERROR_FORMATF32_EXPECTED_F32_MIN,
   TEJU_TEST_ERROR_FORMATF32_EXPECTED_F32_LOWEST,
+  TEJU_TEST_ERROR_FORMATF32SHORTEST,
+  TEJU_TEST_ERROR_FORMATF64SHORTEST,
+  TEJU_TEST_ERROR_F32_ROUND_TRIP,
+  TEJU_TEST_ERROR_F64_ROUND_TRIP,
 
   // src: https://mesonbuild.com/Unit-tests.html#skipped-tests-and-hard-errors
   // For the default exitcode testing protocol, the GNU standard approach in
@@ -36,11 +46,156 @@ enum teju_test_error {
   MESON_TEST_FAILED_TO_SET_UP = 99,
 };
 
+static u64
+NowInNanoseconds(void)
+{
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (u64)now.tv_sec * 1000000000ull + (u64)now.tv_nsec;
+}
+
+/* @return count of significant digits in shortest output, e.g. 3 for -1.25e-7 */
+static u32
+SignificantDigitCount(struct string *string)
+{
+  u32 count = 0;
+  b8 isLeadingZero = 1;
+  for (u64 index = 0; index < string->length && string->value[index] != 'e'; index++) {
+    u8 c = string->value[index];
+    if (c < '0' || c > '9')
+      continue;
+    if (c != '0')
+      isLeadingZero = 0;
+    if (!isLeadingZero)
+      count++;
+  }
+  // trailing zeros of plain integers are not significant
+  for (u64 index = string->length; index > 0 && string->value[index - 1] == '0' && count > 1; index--)
+    count--;
+  return count;
+}
+
+/*
+ * Output must parse back to same bits, and with one digit less it must not,
+ * so it is shortest.
+ */
+static b8
+IsF32RoundTrip(u32 bits, b8 isShortestChecked)
+{
+  f32 value;
+  memcpy(&value, &bits, sizeof(value));
+  u8 buf[FORMAT_SHORTEST_LENGTH_MAX + 1];
+  struct string string = FormatF32Shortest(&(struct string){.value = buf, .length = FORMAT_SHORTEST_LENGTH_MAX}, value);
+  buf[string.length] = 0;
+
+  f32 parsed = strtof((char *)buf, 0);
+  if (value != value)
+    return parsed != parsed;
+  u32 parsedBits;
+  memcpy(&parsedBits, &parsed, sizeof(parsedBits));
+  if (parsedBits != bits)
+    return 0;
+
+  u32 digitCount = SignificantDigitCount(&string);
+  if (isShortestChecked && digitCount > 1 && value - value == 0) {
+    char shorter[32];
+    snprintf(shorter, sizeof(shorter), "%.*e", digitCount - 2, (f64)value);
+    if (strtof(shorter, 0) == value)
+      return 0;
+  }
+  return 1;
+}
+
+/* @see IsF32RoundTrip() */
+static b8
+IsF64RoundTrip(u64 bits)
+{
+  f64 value;
+  memcpy(&value, &bits, sizeof(value));
+  u8 buf[FORMAT_SHORTEST_LENGTH_MAX + 1];
+  struct string string = FormatF64Shortest(&(struct string){.value = buf, .length = FORMAT_SHORTEST_LENGTH_MAX}, value);
+  buf[string.length] = 0;
+
+  f64 parsed = strtod((char *)buf, 0);
+  if (value != value)
+    return parsed != parsed;
+  u64 parsedBits;
+  memcpy(&parsedBits, &parsed, sizeof(parsedBits));
+  if (parsedBits != bits)
+    return 0;
+
+  u32 digitCount = SignificantDigitCount(&string);
+  if (digitCount > 1 && value - value == 0) {
+    char shorter[40];
+    snprintf(shorter, sizeof(shorter), "%.*e", digitCount - 2, value);
+    if (strtod(shorter, 0) == value)
+      return 0;
+  }
+  return 1;
+}
+
+/*
+ * Prints time per value of fixed, shortest and libc formatting, over floats
+ * like ones in telemetry: every magnitude, random mantissa.
+ */
+static void
+Benchmark(void)
+{
+  const u64 VALUE_COUNT = 1 << 20;
+  f64 *values = malloc(VALUE_COUNT * sizeof(*values));
+  if (!values)
+    return;
+  u64 state = 1;
+  for (u64 index = 0; index < VALUE_COUNT; index++) {
+    state = state * 6364136223846793005ull + 1442695040888963407ull;
+    // exponent in [-30, 30] keeps fixed format short enough to compare
+    f64 mantissa = (f64)(state >> 11) / (f64)(1ull << 53);
+    values[index] = mantissa * (f64)POWERS_OF_10[(state >> 8) % 16] / 1e8;
+  }
+
+  u8 buf[64];
+  struct string stringBuffer = {.value = buf, .length = sizeof(buf)};
+#define BENCHMARK(name, expression)                                                                                    \
+  {                                                                                                                    \
+    u64 result = 0;                                                                                                    \
+    u64 startedAt = NowInNanoseconds();                                                                                \
+    for (u64 index = 0; index < VALUE_COUNT; index++) {                                                                \
+      f64 value = values[index];                                                                                       \
+      result += (u64)(expression);                                                                                     \
+    }                                                                                                                  \
+    f64 elapsed = (f64)(NowInNanoseconds() - startedAt);                                                               \
+    printf("%-32s %6.2f ns/value  result %lu\n", name, elapsed / (f64)VALUE_COUNT, result);                            \
+  }
+  BENCHMARK("FormatF32 6 fraction digits", FormatF32(&stringBuffer, (f32)value, 6).length);
+  BENCHMARK("FormatF32Shortest", FormatF32Shortest(&stringBuffer, (f32)value).length);
+  BENCHMARK("snprintf %.9g", snprintf((char *)buf, sizeof(buf), "%.9g", (f64)(f32)value));
+  BENCHMARK("FormatF64Shortest", FormatF64Shortest(&stringBuffer, value).length);
+  BENCHMARK("snprintf %.17g", snprintf((char *)buf, sizeof(buf), "%.17g", value));
+#undef BENCHMARK
+
+  free(values);
+}
+
+/*
+ * Runs tests.
+ *   --exhaustive  round trips every f32 instead of a sample, takes half an hour
+ *   --benchmark   prints time per value of formatting
+ */
 int
-main(void)
+main(int argc, char **argv)
 {
   enum teju_test_error errorCode = TEJU_TEST_ERROR_NONE;
 
+  b8 isExhaustive = 0;
+  b8 isBenchmark = 0;
+  for (s32 argIndex = 1; argIndex < argc; argIndex++) {
+    string arg = StringFromZeroTerminated((u8 *)argv[argIndex], 32);
+    if (IsStringEqual(&arg, &STRING_FROM_ZERO_TERMINATED("--exhaustive")))
+      isExhaustive = 1;
+    else if (IsStringEqual(&arg, &STRING_FROM_ZERO_TERMINATED("--benchmark")))
+      isBenchmark = 1;
+  }
+
   { // setup
     // if () {
     //   errorCode = MESON_TEST_FAILED_TO_SET_UP;
@@ -69,6 +224,20 @@ main(void)
       goto end;
     }
 
+    value = FormatF32(&stringBuffer, 0.5f, 3);
+    expected = STRING_FROM_ZERO_TERMINATED("0.500");
+    if (!IsStringEqual(&value, &expected)) {
+      errorCode = TEJU_TEST_ERROR_FORMATF32_EXPECTED_0_500;
+      goto end;
+    }
+
+    value = FormatF32(&stringBuffer, 0.196f, 3);
+    expected = STRING_FROM_ZERO_TERMINATED("0.196");
+    if (!IsStringEqual(&value, &expected)) {
+      errorCode = TEJU_TEST_ERROR_FORMATF32_EXPECTED_0_196;
+      goto end;
+    }
+
     value = FormatF32(&stringBuffer, 1.0f, 1);
     expected = STRING_FROM_ZERO_TERMINATED("1.0");
     if (!IsStringEqual(&value, &expected)) {
@@ -168,7 +337,7 @@ main(void)
     }
 
     value = FormatF32(&stringBuffer, F32_MIN, 51);
-    expected = STRING_FROM_ZERO_TERMINATED("0.000000000000000000000000000000000000000000011754944");
+    expected = STRING_FROM_ZERO_TERMINATED("0.000000000000000000000000000000000000011754944000000");
     if (!IsStringEqual(&value, &expected)) {
       errorCode = TEJU_TEST_ERROR_FORMATF32_EXPECTED_F32_MIN;
       goto end;
@@ -182,6 +351,135 @@ main(void)
     }
   }
 
+  // FormatF32Shortest(struct string *stringBuffer, f32 value)
+  {
+    struct {
+      f32 value;
+      struct string expected;
+    } cases[] = {
+        {0.0f, STRING_FROM_ZERO_TERMINATED("0")},
+        {-0.0f, STRING_FROM_ZERO_TERMINATED("-0")},
+        {0.1f, STRING_FROM_ZERO_TERMINATED("0.1")},
+        {1.0f, STRING_FROM_ZERO_TERMINATED("1")},
+        {-2.5f, STRING_FROM_ZERO_TERMINATED("-2.5")},
+        {1500.0f, STRING_FROM_ZERO_TERMINATED("1500")},
+        {10234.293f, STRING_FROM_ZERO_TERMINATED("10234.293")},
+        {0.001f, STRING_FROM_ZERO_TERMINATED("0.001")},
+        {0.000001f, STRING_FROM_ZERO_TERMINATED("0.000001")},
+        {1.5e-7f, STRING_FROM_ZERO_TERMINATED("1.5e-7")},
+        {1e21f, STRING_FROM_ZERO_TERMINATED("1e21")},
+        {16777216.0f, STRING_FROM_ZERO_TERMINATED("16777216")},
+        {F32_MAX, STRING_FROM_ZERO_TERMINATED("3.4028235e38")},
+        {F32_MIN, STRING_FROM_ZERO_TERMINATED("1.1754944e-38")},
+        {F32_LOWEST, STRING_FROM_ZERO_TERMINATED("-3.4028235e38")},
+        {1e-45f, STRING_FROM_ZERO_TERMINATED("1e-45")},
+        {1.0f / 0.0f, STRING_FROM_ZERO_TERMINATED("inf")},
+        {-1.0f / 0.0f, STRING_FROM_ZERO_TERMINATED("-inf")},
+        {0.0f / 0.0f, STRING_FROM_ZERO_TERMINATED("nan")},
+    };
+    u8 buf[FORMAT_SHORTEST_LENGTH_MAX];
+    struct string stringBuffer = {.value = buf, .length = sizeof(buf)};
+    for (u32 caseIndex = 0; caseIndex < ARRAY_COUNT(cases); caseIndex++) {
+      struct string value = FormatF32Shortest(&stringBuffer, cases[caseIndex].value);
+      if (!IsStringEqual(&value, &cases[caseIndex].expected)) {
+        errorCode = TEJU_TEST_ERROR_FORMATF32SHORTEST;
+        goto end;
+      }
+    }
+
+    // buffer that cannot hold longest output
+    struct string value = FormatF32Shortest(&(struct string){.value = buf, .length = sizeof(buf) - 1}, 1.0f);
+    if (value.length != 0) {
+      errorCode = TEJU_TEST_ERROR_FORMATF32SHORTEST;
+      goto end;
+    }
+  }
+
+  // FormatF64Shortest(struct string *stringBuffer, f64 value)
+  {
+    struct {
+      f64 value;
+      struct string expected;
+    } cases[] = {
+        {0.0, STRING_FROM_ZERO_TERMINATED("0")},
+        {-0.0, STRING_FROM_ZERO_TERMINATED("-0")},
+        {0.1, STRING_FROM_ZERO_TERMINATED("0.1")},
+        {0.3, STRING_FROM_ZERO_TERMINATED("0.3")},
+        {0.1 + 0.2, STRING_FROM_ZERO_TERMINATED("0.30000000000000004")},
+        {1.0 / 3.0, STRING_FROM_ZERO_TERMINATED("0.3333333333333333")},
+        {-123.456, STRING_FROM_ZERO_TERMINATED("-123.456")},
+        {1e20, STRING_FROM_ZERO_TERMINATED("100000000000000000000")},
+        {1e21, STRING_FROM_ZERO_TERMINATED("1e21")},
+        {1e-7, STRING_FROM_ZERO_TERMINATED("1e-7")},
+        {-1.2345678901234566e-7, STRING_FROM_ZERO_TERMINATED("-1.2345678901234566e-7")},
+        {9007199254740993.0, STRING_FROM_ZERO_TERMINATED("9007199254740992")},
+        {F64_MAX, STRING_FROM_ZERO_TERMINATED("1.7976931348623157e308")},
+        {F64_LOWEST, STRING_FROM_ZERO_TERMINATED("-1.7976931348623157e308")},
+        {2.2250738585072014e-308, STRING_FROM_ZERO_TERMINATED("2.2250738585072014e-308")},
+        {5e-324, STRING_FROM_ZERO_TERMINATED("5e-324")},
+        {1.0 / 0.0, STRING_FROM_ZERO_TERMINATED("inf")},
+        {0.0 / 0.0, STRING_FROM_ZERO_TERMINATED("nan")},
+    };
+    u8 buf[FORMAT_SHORTEST_LENGTH_MAX];
+    struct string stringBuffer = {.value = buf, .length = sizeof(buf)};
+    for (u32 caseIndex = 0; caseIndex < ARRAY_COUNT(cases); caseIndex++) {
+      struct string value = FormatF64Shortest(&stringBuffer, cases[caseIndex].value);
+      if (!IsStringEqual(&value, &cases[caseIndex].expected)) {
+        errorCode = TEJU_TEST_ERROR_FORMATF64SHORTEST;
+        goto end;
+      }
+    }
+  }
+
+  // every f32 round trips, by default about a million of them spread over
+  // every exponent and sign
+  {
+    u32 step = isExhaustive ? 1 : 4093; // prime, so mantissa bits vary
+    u32 bits = 0;
+    do {
+      // shortest check calls libc twice, do it only on a sample
+      if (!IsF32RoundTrip(bits, isExhaustive ? (bits & 0xfff) == 0 : 1)) {
+        errorCode = TEJU_TEST_ERROR_F32_ROUND_TRIP;
+        goto end;
+      }
+      bits += step;
+    } while (bits >= step);
+
+    // powers of two and their neighbours, every exponent
+    for (u32 exponent = 0; exponent < 0x100; exponent++) {
+      u32 power = exponent << 23;
+      if (!IsF32RoundTrip(power, 1) || !IsF32RoundTrip(power + 1, 1) || !IsF32RoundTrip(power - 1, 1)) {
+        errorCode = TEJU_TEST_ERROR_F32_ROUND_TRIP;
+        goto end;
+      }
+    }
+  }
+
+  // f64 round trips on random bits, and powers of two and their neighbours
+  {
+    u64 state = 88172645463325252ull;
+    for (u32 index = 0; index < 1 << 18; index++) {
+      state ^= state << 13;
+      state ^= state >> 7;
+      state ^= state << 17;
+      if (!IsF64RoundTrip(state)) {
+        errorCode = TEJU_TEST_ERROR_F64_ROUND_TRIP;
+        goto end;
+      }
+    }
+
+    for (u64 exponent = 0; exponent < 0x800; exponent++) {
+      u64 power = exponent << 52;
+      if (!IsF64RoundTrip(power) || !IsF64RoundTrip(power + 1) || !IsF64RoundTrip(power - 1)) {
+        errorCode = TEJU_TEST_ERROR_F64_ROUND_TRIP;
+        goto end;
+      }
+    }
+  }
+
+  if (isBenchmark)
+    Benchmark();
+
 end:
   return (int)errorCode;
 }
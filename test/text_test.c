@@ -1,4 +1,9 @@
+#include "teju.h" // FormatF64Shortest() to parse back
 #include "text.h"
+#include <stdio.h>  // printf()
+#include <stdlib.h> // malloc()
+#include <string.h> // memcpy()
+#include <time.h>   // clock_gettime()
 
 // TODO: Show error pretty error message when a test fails
 enum text_test_error {
@@ -55,6 +60,20 @@ enum text_test_error {
   TEXT_TEST_ERROR_FORMATHEX_EXPECTED_0x04,
   TEXT_TEST_ERROR_FORMATHEX_EXPECTED_0X00F2AA499B9028EA,
   TEXT_TEST_ERROR_PATHGETDIRECTORY_1,
+  TEXT_TEST_ERROR_STRING_SPLIT_DELIMITER,
+  TEXT_TEST_ERROR_STRING_LENGTH_ZERO_TERMINATED_DIFFERS_FROM_SCALAR,
+  TEXT_TEST_ERROR_STRING_FIND_BYTE_DIFFERS_FROM_SCALAR,
+  TEXT_TEST_ERROR_STRING_COUNT_BYTE_DIFFERS_FROM_SCALAR,
+  TEXT_TEST_ERROR_STRING_FIND_DIFFERS_FROM_SCALAR,
+  TEXT_TEST_ERROR_FORMATU64_DIFFERS_FROM_SLOW,
+  TEXT_TEST_ERROR_FORMATU64_EXPECTED_FAILURE_WHEN_BUFFER_IS_SMALL,
+  TEXT_TEST_ERROR_FORMATS64,
+  TEXT_TEST_ERROR_FORMATHEX_DIFFERS_FROM_SLOW,
+  TEXT_TEST_ERROR_PARSEF64,
+  TEXT_TEST_ERROR_PARSEF64_EXPECTED_FAILURE,
+  TEXT_TEST_ERROR_PARSEF64_HALFWAY,
+  TEXT_TEST_ERROR_PARSEF32,
+  TEXT_TEST_ERROR_PARSE_DIFFERS_FROM_FORMAT,
 
   // src: https://mesonbuild.com/Unit-tests.html#skipped-tests-and-hard-errors
   // For the default exitcode testing protocol, the GNU standard approach in
@@ -70,8 +89,145 @@ enum text_test_error {
   MESON_TEST_FAILED_TO_SET_UP = 99,
 };
 
+static u64
+NowInNanoseconds(void)
+{
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (u64)now.tv_sec * 1000000000ull + (u64)now.tv_nsec;
+}
+
+static void
+PrintThroughput(const char *name, u64 size, u64 repeatCount, u64 elapsedInNanoseconds, u64 result)
+{
+  f64 bytesPerNanosecond = (f64)(size * repeatCount) / (f64)elapsedInNanoseconds;
+  // result is printed so search is not optimized away
+  printf("%-32s %6.2f GB/s  result %lu\n", name, bytesPerNanosecond, result);
+}
+
+/*
+ * Compares scalar and vector versions over text like a log, a line every
+ * 64 bytes, search only matches at end. Then compares formatting with
+ * versions it replaced.
+ */
+static void
+Benchmark(void)
+{
+  const u64 SIZE = 16 * 1024 * 1024;
+  const u64 REPEAT_COUNT = 8;
+  u8 *bytes = malloc(SIZE + 1);
+  if (!bytes)
+    return;
+  u64 state = 1;
+  for (u64 index = 0; index < SIZE; index++) {
+    state = state * 6364136223846793005ull + 1442695040888963407ull;
+    bytes[index] = index % 64 == 63 ? '\n' : (u8)('a' + (state >> 59));
+  }
+  string search = STRING_FROM_ZERO_TERMINATED("physics step diverged");
+  memcpy(bytes + SIZE - search.length, search.value, search.length);
+  bytes[SIZE] = 0;
+  string text = {.value = bytes, .length = SIZE};
+
+#define BENCHMARK(name, expression)                                                                                    \
+  {                                                                                                                    \
+    u64 result = 0;                                                                                                    \
+    u64 startedAt = NowInNanoseconds();                                                                                \
+    for (u64 repeatIndex = 0; repeatIndex < REPEAT_COUNT; repeatIndex++)                                               \
+      result += (expression);                                                                                          \
+    PrintThroughput(name, SIZE, REPEAT_COUNT, NowInNanoseconds() - startedAt, result);                                 \
+  }
+  BENCHMARK("StringLengthZeroTerminatedScalar", StringLengthZeroTerminatedScalar(bytes, U64_MAX));
+  BENCHMARK("StringLengthZeroTerminated", StringLengthZeroTerminated(bytes, U64_MAX));
+  BENCHMARK("StringFindByteScalar", StringFindByteScalar(&text, '#', 0));
+  BENCHMARK("StringFindByte", StringFindByte(&text, '#', 0));
+  BENCHMARK("StringCountByteScalar", StringCountByteScalar(&text, '\n'));
+  BENCHMARK("StringCountByte", StringCountByte(&text, '\n'));
+  BENCHMARK("StringFindScalar", StringFindScalar(&text, &search));
+  BENCHMARK("StringFind", StringFind(&text, &search));
+#undef BENCHMARK
+
+  free(bytes);
+
+  // telemetry dump: counters of every magnitude
+  const u64 VALUE_COUNT = 1 << 20;
+  u64 *values = malloc(VALUE_COUNT * sizeof(*values));
+  if (!values)
+    return;
+  for (u64 index = 0; index < VALUE_COUNT; index++) {
+    state = state * 6364136223846793005ull + 1442695040888963407ull;
+    values[index] = state >> (state >> 58);
+  }
+
+  u8 digitBytes[32];
+  string digitBuffer = {.value = digitBytes, .length = sizeof(digitBytes)};
+#define BENCHMARK(name, function)                                                                                      \
+  {                                                                                                                    \
+    u64 result = 0;                                                                                                    \
+    u64 startedAt = NowInNanoseconds();                                                                                \
+    for (u64 index = 0; index < VALUE_COUNT; index++)                                                                  \
+      result += function(&digitBuffer, values[index]).length;                                                          \
+    f64 elapsed = (f64)(NowInNanoseconds() - startedAt);                                                               \
+    printf("%-32s %6.2f ns/value  result %lu\n", name, elapsed / (f64)VALUE_COUNT, result);                            \
+  }
+  BENCHMARK("FormatU64Slow", FormatU64Slow);
+  BENCHMARK("FormatU64", FormatU64);
+  BENCHMARK("FormatHexSlow", FormatHexSlow);
+  BENCHMARK("FormatHex", FormatHex);
+#undef BENCHMARK
+
+  // numeric trace: shortest f64 of every magnitude, one per line
+  u8 *trace = malloc(VALUE_COUNT * FORMAT_SHORTEST_LENGTH_MAX + 1);
+  if (!trace) {
+    free(values);
+    return;
+  }
+  u64 traceLength = 0;
+  for (u64 index = 0; index < VALUE_COUNT; index++) {
+    f64 value = (f64)(values[index] >> 11) / (f64)(1ull << 53) * (f64)POWERS_OF_10[index % 20] / 1e10;
+    traceLength +=
+        FormatF64Shortest(&(string){.value = trace + traceLength, .length = FORMAT_SHORTEST_LENGTH_MAX}, value).length;
+    trace[traceLength] = '\n';
+    traceLength++;
+  }
+  trace[traceLength] = 0;
+
+  {
+    f64 result = 0;
+    u64 startedAt = NowInNanoseconds();
+    string text = {.value = trace, .length = traceLength};
+    for (u64 index = 0; index < traceLength;) {
+      u64 lineEnd = StringFindByte(&text, '\n', index);
+      f64 value;
+      ParseF64(&(string){.value = trace + index, .length = lineEnd - index}, &value);
+      result += value;
+      index = lineEnd + 1;
+    }
+    f64 elapsed = (f64)(NowInNanoseconds() - startedAt);
+    printf("%-32s %6.0f MB/s  result %g\n", "ParseF64", (f64)traceLength / elapsed * 1e3, result);
+  }
+
+  {
+    f64 result = 0;
+    u64 startedAt = NowInNanoseconds();
+    for (char *line = (char *)trace; *line;) {
+      char *lineEnd;
+      result += strtod(line, &lineEnd);
+      line = lineEnd + 1;
+    }
+    f64 elapsed = (f64)(NowInNanoseconds() - startedAt);
+    printf("%-32s %6.0f MB/s  result %g\n", "strtod", (f64)traceLength / elapsed * 1e3, result);
+  }
+
+  free(trace);
+  free(values);
+}
+
+/*
+ * Runs tests, with --benchmark also prints throughput of searching and
+ * formatting against versions they replaced, and of parsing floats.
+ */
 int
-main(void)
+main(int argc, char **argv)
 {
   enum text_test_error errorCode = TEXT_TEST_ERROR_NONE;
 
@@ -544,7 +700,7 @@ main(void)
     {
       u64 expected = 3;
       u64 value = 1;
-      StringSplit(&numbers, &value, 0);
+      StringSplit(&numbers, ' ', &value, 0);
       if (value != expected) {
         errorCode = TEXT_TEST_ERROR_PATHGETDIRECTORY_1;
         goto end;
@@ -554,7 +710,7 @@ main(void)
     {
       u64 splitCount = 3;
       string splits[3];
-      StringSplit(&numbers, &splitCount, splits);
+      StringSplit(&numbers, ' ', &splitCount, splits);
 
       string *expected;
       string *value;
@@ -583,6 +739,318 @@ main(void)
     }
   }
 
+  // StringSplit(struct string *string, u8 delimiter, u64 *splitCount, struct string *splits)
+  {
+    struct string line = STRING_FROM_ZERO_TERMINATED("steps,hz,,particles");
+    u64 splitCount;
+    StringSplit(&line, ',', &splitCount, 0);
+    string splits[4];
+    if (splitCount != ARRAY_COUNT(splits)) {
+      errorCode = TEXT_TEST_ERROR_STRING_SPLIT_DELIMITER;
+      goto end;
+    }
+
+    StringSplit(&line, ',', &splitCount, splits);
+    if (!IsStringEqual(splits + 0, &STRING_FROM_ZERO_TERMINATED("steps")) ||
+        !IsStringEqual(splits + 1, &STRING_FROM_ZERO_TERMINATED("hz")) || splits[2].length != 0 ||
+        !IsStringEqual(splits + 3, &STRING_FROM_ZERO_TERMINATED("particles"))) {
+      errorCode = TEXT_TEST_ERROR_STRING_SPLIT_DELIMITER;
+      goto end;
+    }
+
+    // parts after last split are kept in it
+    splitCount = 2;
+    StringSplit(&line, ',', &splitCount, splits);
+    if (!IsStringEqual(splits + 1, &STRING_FROM_ZERO_TERMINATED("hz,,particles"))) {
+      errorCode = TEXT_TEST_ERROR_STRING_SPLIT_DELIMITER;
+      goto end;
+    }
+  }
+
+  // vector versions must agree with scalar ones at every length and alignment
+  {
+    u8 bytes[256 + 32];
+    u64 state = 7;
+    for (u64 index = 0; index < ARRAY_COUNT(bytes); index++) {
+      state = state * 6364136223846793005ull + 1442695040888963407ull;
+      // small alphabet, so there are many partial matches
+      bytes[index] = (u8)('a' + (state >> 62));
+    }
+
+    for (u64 offset = 0; offset < 32; offset++) {
+      for (u64 length = 0; length <= 256; length++) {
+        string text = {.value = bytes + offset, .length = length};
+
+        u8 saved = text.value[length];
+        text.value[length] = 0;
+        b8 isLengthSame =
+            StringLengthZeroTerminated(text.value, U64_MAX) == StringLengthZeroTerminatedScalar(text.value, U64_MAX) &&
+            StringLengthZeroTerminated(text.value, length / 2) ==
+                StringLengthZeroTerminatedScalar(text.value, length / 2);
+        text.value[length] = saved;
+        if (!isLengthSame) {
+          errorCode = TEXT_TEST_ERROR_STRING_LENGTH_ZERO_TERMINATED_DIFFERS_FROM_SCALAR;
+          goto end;
+        }
+
+        for (u8 value = 'a'; value <= 'e'; value++) {
+          for (u64 start = 0; start <= length; start += 7) {
+            if (StringFindByte(&text, value, start) != StringFindByteScalar(&text, value, start)) {
+              errorCode = TEXT_TEST_ERROR_STRING_FIND_BYTE_DIFFERS_FROM_SCALAR;
+              goto end;
+            }
+          }
+          if (StringCountByte(&text, value) != StringCountByteScalar(&text, value)) {
+            errorCode = TEXT_TEST_ERROR_STRING_COUNT_BYTE_DIFFERS_FROM_SCALAR;
+            goto end;
+          }
+        }
+
+        u64 searchLengths[] = {0, 1, 2, 3, 5, 8, 33};
+        for (u64 searchIndex = 0; searchIndex < ARRAY_COUNT(searchLengths); searchIndex++) {
+          // searches that are in text, and one that is likely not
+          u64 searchLength = searchLengths[searchIndex];
+          string inside = {.value = bytes + (length * 7) % 200, .length = searchLength};
+          string outside = {.value = bytes + 250 - searchLength / 4, .length = searchLength};
+          if (StringFind(&text, &inside) != StringFindScalar(&text, &inside) ||
+              StringFind(&text, &outside) != StringFindScalar(&text, &outside)) {
+            errorCode = TEXT_TEST_ERROR_STRING_FIND_DIFFERS_FROM_SCALAR;
+            goto end;
+          }
+        }
+      }
+    }
+  }
+
+  // FormatU64(struct string *stringBuffer, u64 value)
+  // FormatHex(struct string *stringBuffer, u64 value)
+  {
+    u8 buf[32];
+    u8 slowBuf[32];
+    struct string stringBuffer = {.value = buf, .length = sizeof(buf)};
+    struct string slowStringBuffer = {.value = slowBuf, .length = sizeof(slowBuf)};
+
+    // every digit count and bit count boundary
+    u64 values[2 * ARRAY_COUNT(POWERS_OF_10) + 3 * 64 + 1];
+    u64 valueCount = 0;
+    for (u32 power = 0; power < ARRAY_COUNT(POWERS_OF_10); power++) {
+      values[valueCount++] = POWERS_OF_10[power];
+      values[valueCount++] = POWERS_OF_10[power] - 1;
+    }
+    for (u32 bit = 0; bit < 64; bit++) {
+      values[valueCount++] = 1ull << bit;
+      values[valueCount++] = (1ull << bit) - 1;
+      values[valueCount++] = (1ull << bit) | 0x5555555555555555ull;
+    }
+    values[valueCount++] = U64_MAX;
+
+    for (u64 valueIndex = 0; valueIndex < valueCount; valueIndex++) {
+      u64 value = values[valueIndex];
+      string expected = FormatU64Slow(&slowStringBuffer, value);
+      string formatted = FormatU64(&stringBuffer, value);
+      if (formatted.length == 0 || !IsStringEqual(&formatted, &expected)) {
+        errorCode = TEXT_TEST_ERROR_FORMATU64_DIFFERS_FROM_SLOW;
+        goto end;
+      }
+
+      expected = FormatHexSlow(&slowStringBuffer, value);
+      formatted = FormatHex(&stringBuffer, value);
+      if (formatted.length == 0 || !IsStringEqual(&formatted, &expected)) {
+        errorCode = TEXT_TEST_ERROR_FORMATHEX_DIFFERS_FROM_SLOW;
+        goto end;
+      }
+    }
+
+    struct string smallBuffer = {.value = buf, .length = 3};
+    if (FormatU64(&smallBuffer, 1000).length != 0 || FormatU64(&smallBuffer, 999).length != 3) {
+      errorCode = TEXT_TEST_ERROR_FORMATU64_EXPECTED_FAILURE_WHEN_BUFFER_IS_SMALL;
+      goto end;
+    }
+  }
+
+  // FormatS64(struct string *stringBuffer, s64 value)
+  {
+    u8 buf[32];
+    struct string stringBuffer = {.value = buf, .length = sizeof(buf)};
+    struct string value;
+
+    value = FormatS64(&stringBuffer, -42);
+    if (!IsStringEqual(&value, &STRING_FROM_ZERO_TERMINATED("-42"))) {
+      errorCode = TEXT_TEST_ERROR_FORMATS64;
+      goto end;
+    }
+
+    value = FormatS64(&stringBuffer, S64_MIN);
+    if (!IsStringEqual(&value, &STRING_FROM_ZERO_TERMINATED("-9223372036854775808"))) {
+      errorCode = TEXT_TEST_ERROR_FORMATS64;
+      goto end;
+    }
+
+    value = FormatS64(&stringBuffer, 7);
+    if (!IsStringEqual(&value, &STRING_FROM_ZERO_TERMINATED("7")) || stringBuffer.value != buf) {
+      errorCode = TEXT_TEST_ERROR_FORMATS64;
+      goto end;
+    }
+  }
+
+  // ParseF64(struct string *string, f64 *value)
+  {
+    struct {
+      struct string string;
+      f64 expected;
+    } cases[] = {
+        {STRING_FROM_ZERO_TERMINATED("0"), 0.0},
+        {STRING_FROM_ZERO_TERMINATED("1"), 1.0},
+        {STRING_FROM_ZERO_TERMINATED("-2.5"), -2.5},
+        {STRING_FROM_ZERO_TERMINATED("+3"), 3.0},
+        {STRING_FROM_ZERO_TERMINATED("2."), 2.0},
+        {STRING_FROM_ZERO_TERMINATED(".5"), 0.5},
+        {STRING_FROM_ZERO_TERMINATED("0.1"), 0.1},
+        {STRING_FROM_ZERO_TERMINATED("0.30000000000000004"), 0.1 + 0.2},
+        {STRING_FROM_ZERO_TERMINATED("12345678.87654321"), 12345678.87654321},
+        {STRING_FROM_ZERO_TERMINATED("1.5e-7"), 1.5e-7},
+        {STRING_FROM_ZERO_TERMINATED("1E21"), 1e21},
+        {STRING_FROM_ZERO_TERMINATED("123456789012345678901234567890"), 123456789012345678901234567890.0},
+        {STRING_FROM_ZERO_TERMINATED("0.000000000000000000000000000001"), 1e-30},
+        {STRING_FROM_ZERO_TERMINATED("1.7976931348623157e308"), F64_MAX},
+        {STRING_FROM_ZERO_TERMINATED("1.7976931348623159e308"), 1.0 / 0.0},
+        {STRING_FROM_ZERO_TERMINATED("2.2250738585072014e-308"), 2.2250738585072014e-308},
+        {STRING_FROM_ZERO_TERMINATED("5e-324"), 5e-324},
+        {STRING_FROM_ZERO_TERMINATED("2.4703282292062327e-324"), 0.0},
+        {STRING_FROM_ZERO_TERMINATED("2.4703282292062328e-324"), 5e-324},
+        {STRING_FROM_ZERO_TERMINATED("1e-400"), 0.0},
+        {STRING_FROM_ZERO_TERMINATED("1e400"), 1.0 / 0.0},
+        {STRING_FROM_ZERO_TERMINATED("1e99999999999"), 1.0 / 0.0},
+        {STRING_FROM_ZERO_TERMINATED("inf"), 1.0 / 0.0},
+        {STRING_FROM_ZERO_TERMINATED("-infinity"), -1.0 / 0.0},
+        // 2^53 + 1 is halfway, ties to even
+        {STRING_FROM_ZERO_TERMINATED("9007199254740993"), 9007199254740992.0},
+        {STRING_FROM_ZERO_TERMINATED("9007199254740993.0000000000000000001"), 9007199254740994.0},
+    };
+    for (u32 caseIndex = 0; caseIndex < ARRAY_COUNT(cases); caseIndex++) {
+      f64 value;
+      if (!ParseF64(&cases[caseIndex].string, &value) || value != cases[caseIndex].expected) {
+        errorCode = TEXT_TEST_ERROR_PARSEF64;
+        goto end;
+      }
+    }
+
+    f64 value;
+    if (!ParseF64(&STRING_FROM_ZERO_TERMINATED("-0"), &value) || value != 0 || !__builtin_signbit(value) ||
+        !ParseF64(&STRING_FROM_ZERO_TERMINATED("nan"), &value) || value == value) {
+      errorCode = TEXT_TEST_ERROR_PARSEF64;
+      goto end;
+    }
+
+    struct string invalids[] = {
+        STRING_FROM_ZERO_TERMINATED(""),
+        STRING_FROM_ZERO_TERMINATED("-"),
+        STRING_FROM_ZERO_TERMINATED("."),
+        STRING_FROM_ZERO_TERMINATED("e5"),
+        STRING_FROM_ZERO_TERMINATED("1e"),
+        STRING_FROM_ZERO_TERMINATED("1e+"),
+        STRING_FROM_ZERO_TERMINATED("1.2.3"),
+        STRING_FROM_ZERO_TERMINATED("1x"),
+        STRING_FROM_ZERO_TERMINATED(" 1"),
+        STRING_FROM_ZERO_TERMINATED("infinit"),
+        STRING_FROM_ZERO_TERMINATED("--1"),
+    };
+    for (u32 invalidIndex = 0; invalidIndex < ARRAY_COUNT(invalids); invalidIndex++) {
+      if (ParseF64(&invalids[invalidIndex], &value)) {
+        errorCode = TEXT_TEST_ERROR_PARSEF64_EXPECTED_FAILURE;
+        goto end;
+      }
+    }
+  }
+
+  // digits past first 768 still decide halfway
+  {
+    static u8 bytes[1024];
+    string halfway = STRING_FROM_ZERO_TERMINATED("9007199254740993.");
+    memcpy(bytes, halfway.value, halfway.length);
+    memset(bytes + halfway.length, '0', 900);
+    string string = {.value = bytes, .length = halfway.length + 900};
+    f64 below;
+    ParseF64(&string, &below);
+    bytes[string.length] = '1';
+    string.length++;
+    f64 above;
+    ParseF64(&string, &above);
+    if (below != 9007199254740992.0 || above != 9007199254740994.0) {
+      errorCode = TEXT_TEST_ERROR_PARSEF64_HALFWAY;
+      goto end;
+    }
+  }
+
+  // ParseF32(struct string *string, f32 *value)
+  {
+    struct {
+      struct string string;
+      f32 expected;
+    } cases[] = {
+        {STRING_FROM_ZERO_TERMINATED("0.1"), 0.1f},
+        {STRING_FROM_ZERO_TERMINATED("-2.5"), -2.5f},
+        {STRING_FROM_ZERO_TERMINATED("7.038531e-26"), 7.038531e-26f},
+        {STRING_FROM_ZERO_TERMINATED("3.4028235e38"), F32_MAX},
+        {STRING_FROM_ZERO_TERMINATED("3.40282356e38"), F32_MAX},
+        {STRING_FROM_ZERO_TERMINATED("3.5e38"), 1.0f / 0.0f},
+        {STRING_FROM_ZERO_TERMINATED("1e-45"), 1e-45f},
+        {STRING_FROM_ZERO_TERMINATED("1e-46"), 0.0f},
+        // 1 + 2^-24 is halfway, ties to even
+        {STRING_FROM_ZERO_TERMINATED("1.000000059604644775390625"), 1.0f},
+        {STRING_FROM_ZERO_TERMINATED("1.000000059604644775390626"), 1.00000012f},
+    };
+    for (u32 caseIndex = 0; caseIndex < ARRAY_COUNT(cases); caseIndex++) {
+      f32 value;
+      if (!ParseF32(&cases[caseIndex].string, &value) || value != cases[caseIndex].expected) {
+        errorCode = TEXT_TEST_ERROR_PARSEF32;
+        goto end;
+      }
+    }
+  }
+
+  // shortest output of teju parses back to same bits
+  {
+    u8 buf[FORMAT_SHORTEST_LENGTH_MAX];
+    string stringBuffer = {.value = buf, .length = sizeof(buf)};
+    u64 state = 88172645463325252ull;
+    for (u32 index = 0; index < 1 << 18; index++) {
+      state ^= state << 13;
+      state ^= state >> 7;
+      state ^= state << 17;
+      f64 value;
+      memcpy(&value, &state, sizeof(value));
+      if (value != value)
+        continue;
+      string formatted = FormatF64Shortest(&stringBuffer, value);
+      f64 parsed;
+      if (!ParseF64(&formatted, &parsed) || memcmp(&parsed, &value, sizeof(value)) != 0) {
+        errorCode = TEXT_TEST_ERROR_PARSE_DIFFERS_FROM_FORMAT;
+        goto end;
+      }
+    }
+
+    // prime step covers every exponent and sign of f32
+    for (u32 bits = 0, lastBits = 0; bits >= lastBits; lastBits = bits, bits += 4093) {
+      f32 value;
+      memcpy(&value, &bits, sizeof(value));
+      if (value != value)
+        continue;
+      string formatted = FormatF32Shortest(&stringBuffer, value);
+      f32 parsed;
+      if (!ParseF32(&formatted, &parsed) || memcmp(&parsed, &value, sizeof(value)) != 0) {
+        errorCode = TEXT_TEST_ERROR_PARSE_DIFFERS_FROM_FORMAT;
+        goto end;
+      }
+    }
+  }
+
+  if (argc > 1) {
+    string arg = StringFromZeroTerminated((u8 *)argv[1], 32);
+    if (IsStringEqual(&arg, &STRING_FROM_ZERO_TERMINATED("--benchmark")))
+      Benchmark();
+  }
+
 end:
   return (int)errorCode;
 }